@@ -17,8 +17,31 @@
  * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
  */
 #pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
 
+/**
+ * The codec of compressed data. It is stored per node in the index, so the values must not change.
+ */
 enum class CompressionSetting
 {
-	lzma
+	lzma = 0,
+	/**
+	 * DEFLATE, much faster than lzma but with a lower compression ratio.
+	 */
+	zlib = 1,
+};
+
+/**
+ * How data is compressed. Only the setting is needed to decompress it again.
+ */
+struct CompressionMethod
+{
+	CompressionSetting setting;
+	uint8 level;
+	/**
+	 * Whether this is the configured codec at the level the statistics picked. Only then do the achieved compression
+	 * rates tell something about the rates that the statistics estimate.
+	 */
+	bool isConfiguredCodec = false;
 };
\ No newline at end of file
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+//Local
+#include "Util.hpp"
+
+/**
+ * A hash value in its raw binary form. Hex notation is only used where hash values are shown to the user or handed to
+ * Std++ interfaces that expect it.
+ */
+struct Digest
+{
+	//Constants
+	static constexpr uint8 c_maxSize = 64;
+
+	//Members
+	uint8 size = 0;
+	uint8 bytes[c_maxSize];
+
+	//Inline operators
+	inline bool operator==(const Digest& other) const
+	{
+		return (this->size == other.size) and (MemCmp(this->bytes, other.bytes, this->size) == 0);
+	}
+
+	inline bool operator!=(const Digest& other) const
+	{
+		return !(*this == other);
+	}
+
+	inline bool operator<(const Digest& other) const
+	{
+		if(this->size != other.size)
+			return this->size < other.size;
+		return MemCmp(this->bytes, other.bytes, this->size) < 0;
+	}
+
+	//Inline
+	inline String ToHexString() const
+	{
+		return DigestToHexString(this->bytes, this->size);
+	}
+
+	//Inline functions
+	static inline Digest FromHashFunction(Crypto::HashFunction& hasher)
+	{
+		ASSERT(hasher.GetDigestSize() <= c_maxSize, u8"Hash value is too long");
+
+		Digest digest;
+		digest.size = static_cast<uint8>(hasher.GetDigestSize());
+		hasher.StoreDigest(digest.bytes);
+		return digest;
+	}
+
+	static inline Digest FromHexString(const String& hexString)
+	{
+		Digest digest;
+		digest.size = HexStringToDigest(hexString, digest.bytes, c_maxSize);
+		return digest;
+	}
+};
+
+struct HashValue
+{
+	Crypto::HashAlgorithm algorithm;
+	Digest digest;
+};
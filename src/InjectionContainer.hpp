@@ -18,6 +18,7 @@
  */
 #include "config/ConfigManager.hpp"
 #include "config/CompressionStatistics.hpp"
+#include "TaskWindow.hpp"
 
 using namespace StdXX;
 
@@ -25,6 +26,16 @@ class InjectionContainer
 {
 public:
 	//Properties
+	inline class ChunkStore& ChunkStore()
+	{
+		return *this->chunkStore;
+	}
+
+	inline void ChunkStore(class ChunkStore* chunkStore)
+	{
+		this->chunkStore = chunkStore;
+	}
+
 	inline CompressionStatistics& CompressionStats()
 	{
 		return *this->compressionStatistics;
@@ -50,6 +61,11 @@ public:
 		return *this->configManager;
 	}
 
+	inline uint32 NumberOfWorkers() const
+	{
+		return this->nWorkers;
+	}
+
 	inline class StatusTracker& StatusTracker()
 	{
 		return *this->statusTracker;
@@ -67,15 +83,24 @@ public:
 
 	inline void TaskQueue(uint32 nWorkers)
 	{
+		this->nWorkers = nWorkers;
 		this->taskQueue = new StaticThreadPool(nWorkers);
+		this->taskWindowPool = new class TaskWindowPool(nWorkers);
+	}
+
+	inline class TaskWindowPool& TaskWindowPool()
+	{
+		return *this->taskWindowPool;
 	}
 
 	//Inline
 	inline void UnregisterAll()
 	{
+		this->chunkStore = nullptr;
 		this->compressionStatistics = nullptr;
 		this->configManager = nullptr;
 		this->statusTracker = nullptr;
+		this->taskWindowPool = nullptr;
 		this->taskQueue = nullptr;
 	}
 
@@ -88,10 +113,13 @@ public:
 
 private:
 	//Members
+	class ChunkStore* chunkStore;
 	CompressionStatistics* compressionStatistics;
 	class ConfigManager* configManager;
 	UniquePointer<class StatusTracker> statusTracker;
 	UniquePointer<StaticThreadPool> taskQueue;
+	UniquePointer<class TaskWindowPool> taskWindowPool;
+	uint32 nWorkers;
 
 	//Constructor
 	InjectionContainer() = default;
@@ -20,25 +20,34 @@
 #include "NodeIndexDifferenceResolver.hpp"
 //Local
 #include "InjectionContainer.hpp"
+#include "ParallelFor.hpp"
 #include "status/StatusTracker.hpp"
 #include "config/ConfigManager.hpp"
 
+//Local types
+enum class NewNodeClassification : uint8
+{
+	DifferentData,
+	DifferentMetadata,
+	Moved,
+	SpeculativeData,
+};
+
 //Public methods
-NodeIndexDifferences NodeIndexDifferenceResolver::ComputeDiff(const BackupNodeIndex &leftIndex, const FileSystemNodeIndex &rightIndex)
+NodeIndexDifferences NodeIndexDifferenceResolver::ComputeDiff(const BackupNodeIndex &leftIndex, const FileSystemNodeIndex &rightIndex, bool hashNewNodes)
 {
-	BinaryTreeSet<uint32> leftToRightDiffs = this->ComputeDifference(leftIndex, rightIndex);
-	BinaryTreeSet<uint32> rightToLeftDiffs = this->ComputeDifference(rightIndex, leftIndex);
-	return this->ResolveDifferences(leftIndex, rightIndex, leftToRightDiffs, rightToLeftDiffs);
+	DynamicArray<uint32> leftToRightDiffs = this->ComputeDifference(leftIndex, rightIndex);
+	DynamicArray<uint32> rightToLeftDiffs = this->ComputeDifference(rightIndex, leftIndex);
+	return this->ResolveDifferences(leftIndex, rightIndex, leftToRightDiffs, rightToLeftDiffs, hashNewNodes);
 }
 
 //Private methods
-BinaryTreeSet<uint32> NodeIndexDifferenceResolver::ComputeDeleted(const FileSystemNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex, const BinaryTreeSet<uint32>& indexes) const
+DynamicArray<uint32> NodeIndexDifferenceResolver::ComputeDeleted(const FileSystemNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex, const DynamicArray<uint32>& indexes) const
 {
 	InjectionContainer &injectionContainer = InjectionContainer::Instance();
-	StaticThreadPool& threadPool = injectionContainer.TaskQueue();
 	StatusTracker& statusTracker = injectionContainer.StatusTracker();
 
-	BinaryTreeSet<uint32> nodeDifferences;
+	DynamicArray<uint32> nodeDifferences;
 
 	ProcessStatus& process = statusTracker.AddProcessStatusTracker(u8"Resolving deleted nodes", indexes.GetNumberOfElements(), leftIndex.ComputeTotalSize(indexes));
 	for(uint32 index : indexes)
@@ -47,143 +56,242 @@ BinaryTreeSet<uint32> NodeIndexDifferenceResolver::ComputeDeleted(const FileSyst
 		if(rightIndex.HasNodeIndex(path))
 		{
 			process.IncFileCount();
-			process.ReduceTotalSize(rightIndex.GetNodeAttributes(index).Size());
+			//index refers to the left index, the total size was computed from it too
+			process.ReduceTotalSize(leftIndex.GetNodeAttributes(index).Size());
 			continue;
 		}
 
-		nodeDifferences.Insert(index);
+		nodeDifferences.Push(index);
 
 		process.IncFileCount();
 		process.AddFinishedSize(leftIndex.GetNodeAttributes(index).Size());
 	}
-	threadPool.WaitForAllTasksToComplete();
 	process.Finished();
 
 	return nodeDifferences;
 }
 
-BinaryTreeSet<uint32> NodeIndexDifferenceResolver::ComputeDifference(const FileSystemNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex) const
+DynamicArray<uint32> NodeIndexDifferenceResolver::ComputeDifference(const FileSystemNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex) const
 {
-	BinaryTreeSet<uint32> diff;
-	Mutex diffLock;
+	//every task writes only the flag of its own node, so no lock is needed. The flags are collected once all tasks are done
+	FixedArray<bool> isDifferent(leftIndex.GetNumberOfNodes());
 
 	InjectionContainer &injectionContainer = InjectionContainer::Instance();
 	StaticThreadPool& threadPool = injectionContainer.TaskQueue();
 	StatusTracker& statusTracker = injectionContainer.StatusTracker();
 
 	ProcessStatus& process = statusTracker.AddProcessStatusTracker(u8"Computing index differences", leftIndex.GetNumberOfNodes(), leftIndex.ComputeTotalSize());
-	for(uint32 i = 0; i < leftIndex.GetNumberOfNodes(); i++)
+	ParallelFor(threadPool, injectionContainer.NumberOfWorkers(), leftIndex.GetNumberOfNodes(), [&leftIndex, &rightIndex, &isDifferent, &process](uint32 i)
 	{
-		threadPool.EnqueueTask([&leftIndex, &rightIndex, &diff, &diffLock, &process, i]()
-		{
-			const Path& filePath = leftIndex.GetNodePath(i);
-			const FileSystemNodeAttributes& fileAttributes = leftIndex.GetNodeAttributes(i);
+		const Path& filePath = leftIndex.GetNodePath(i);
+		const FileSystemNodeAttributes& fileAttributes = leftIndex.GetNodeAttributes(i);
 
-			bool include = false;
-			if(rightIndex.HasNodeIndex(filePath))
-			{
-				//both indexes have this node
-				uint32 otherIndex = rightIndex.GetNodeIndex(filePath);
-				const FileSystemNodeAttributes& otherFileAttributes = rightIndex.GetNodeAttributes(otherIndex);
-				if(fileAttributes != otherFileAttributes)
-					include = true;
-			}
-			else
-			{
-				//only we have this node
+		bool include = false;
+		if(rightIndex.HasNodeIndex(filePath))
+		{
+			//both indexes have this node
+			uint32 otherIndex = rightIndex.GetNodeIndex(filePath);
+			const FileSystemNodeAttributes& otherFileAttributes = rightIndex.GetNodeAttributes(otherIndex);
+			if(fileAttributes != otherFileAttributes)
 				include = true;
-			}
+		}
+		else
+		{
+			//only we have this node
+			include = true;
+		}
 
-			if(include)
-			{
-				diffLock.Lock();
-				diff.Insert(i);
-				diffLock.Unlock();
-			}
+		isDifferent[i] = include;
 
-			process.AddFinishedSize(fileAttributes.Size());
-			process.IncFinishedCount();
-		});
-	}
-	threadPool.WaitForAllTasksToComplete();
+		process.AddFinishedSize(fileAttributes.Size());
+		process.IncFinishedCount();
+	});
 	process.Finished();
 
+	DynamicArray<uint32> diff;
+	for(uint32 i = 0; i < leftIndex.GetNumberOfNodes(); i++)
+	{
+		if(isDifferent[i])
+			diff.Push(i);
+	}
 	return diff;
 }
 
-void NodeIndexDifferenceResolver::ComputeNodeDifferences(NodeIndexDifferences& nodeIndexDifferences, const BackupNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex, const BinaryTreeSet<uint32>& rightToLeftDiffs) const
+void NodeIndexDifferenceResolver::ComputeNodeDifferences(NodeIndexDifferences& nodeIndexDifferences, const BackupNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex, const DynamicArray<uint32>& rightToLeftDiffs, bool hashNewNodes) const
 {
 	InjectionContainer &injectionContainer = InjectionContainer::Instance();
 	StatusTracker& statusTracker = injectionContainer.StatusTracker();
 	StaticThreadPool& threadPool = injectionContainer.TaskQueue();
 
-	Mutex nodeDifferencesLock;
+	//one slot per entry of rightToLeftDiffs that only its task writes to. They are merged in order once all tasks are done
+	const uint32 nNodes = rightToLeftDiffs.GetNumberOfElements();
+	FixedArray<NewNodeClassification> classifications(nNodes);
+	FixedArray<uint32> moveSources(nNodes);
+
+	Atomic<uint64> avoidedHashingSize(0);
+	const bool readsData = dynamic_cast<const OSFileSystemNodeIndex *>(&rightIndex) != nullptr;
 
 	//index new
-	ProcessStatus& process = statusTracker.AddProcessStatusTracker(u8"Indexing potentially new nodes", rightToLeftDiffs.GetNumberOfElements(), rightIndex.ComputeTotalSize(rightToLeftDiffs));
-	for(uint32 index : rightToLeftDiffs)
+	ProcessStatus& process = statusTracker.AddProcessStatusTracker(u8"Indexing potentially new nodes", nNodes, rightIndex.ComputeTotalSize(rightToLeftDiffs));
+	ParallelFor(threadPool, injectionContainer.NumberOfWorkers(), nNodes, [this, &rightToLeftDiffs, &leftIndex, &rightIndex, &classifications, &moveSources, &avoidedHashingSize, &process, hashNewNodes, readsData](uint32 i)
 	{
-		threadPool.EnqueueTask([this, index, &leftIndex, &rightIndex, &nodeIndexDifferences, &nodeDifferencesLock, &process]()
+		const uint32 index = rightToLeftDiffs[i];
+		NewNodeClassification& classification = classifications[i];
+		classification = NewNodeClassification::DifferentData; //new node
+
+		const FileSystemNodeAttributes &attributes = rightIndex.GetNodeAttributes(index);
+		switch(attributes.Type())
 		{
-			const FileSystemNodeAttributes &attributes = rightIndex.GetNodeAttributes(index);
-			switch(attributes.Type())
+			case FileType::Directory:
+				break;
+			case FileType::File:
+			case FileType::Link:
 			{
-				case FileType::Directory:
-					nodeDifferencesLock.Lock();
-					nodeIndexDifferences.differentData.Insert(index); //new node
-					nodeDifferencesLock.Unlock();
-					break;
-				case FileType::File:
-				case FileType::Link:
+				uint32 leftNodeIndexByIdentity = this->FindNodeByIdentity(leftIndex, attributes);
+				if(leftNodeIndexByIdentity != Unsigned<uint32>::Max())
 				{
-					String hash = this->RetrieveNodeHash(index, rightIndex);
-					uint32 leftNodeIndexByHash = leftIndex.FindNodeIndexByHash(hash);
+					//the same file system node, no need to read it
+					const Path &filePath = rightIndex.GetNodePath(index);
 
-					nodeDifferencesLock.Lock();
-					if(leftNodeIndexByHash == Unsigned<uint32>::Max()) //could not find hash value
-						nodeIndexDifferences.differentData.Insert(index); //new node
+					if(leftIndex.GetNodePath(leftNodeIndexByIdentity) == filePath)
+						classification = NewNodeClassification::DifferentMetadata;
 					else
 					{
-						const Path &filePath = rightIndex.GetNodePath(index);
-						if(leftIndex.GetNodePath(leftNodeIndexByHash) == filePath) //same node and same hash, only update metadata
-							nodeIndexDifferences.differentMetadata.Insert(index);
-						else //same hash but different node -> moved node
-							nodeIndexDifferences.moved.Insert(index, leftNodeIndexByHash);
+						classification = NewNodeClassification::Moved;
+						moveSources[i] = leftNodeIndexByIdentity;
 					}
-					nodeDifferencesLock.Unlock();
+					break;
 				}
+
+				if(leftIndex.NodesWithSize(attributes.Size()).IsEmpty())
+				{
+					//no node with the same data can exist
+					if(readsData)
+						avoidedHashingSize += attributes.Size();
 					break;
+				}
+
+				if(readsData and this->FingerprintRulesOutCandidates(leftIndex, index, rightIndex))
+				{
+					avoidedHashingSize += attributes.Size() - NodeFingerprinter::SampledSize(attributes.Size());
+					break;
+				}
+
+				if(!hashNewNodes)
+				{
+					classification = NewNodeClassification::SpeculativeData;
+					break;
+				}
+
+				Digest hash = this->RetrieveNodeHash(index, rightIndex);
+				uint32 leftNodeIndexByHash = leftIndex.FindNodeIndexByHash(hash);
+
+				if(leftNodeIndexByHash != Unsigned<uint32>::Max())
+				{
+					const Path &filePath = rightIndex.GetNodePath(index);
+					if(leftIndex.GetNodePath(leftNodeIndexByHash) == filePath) //same node and same hash, only update metadata
+						classification = NewNodeClassification::DifferentMetadata;
+					else //same hash but different node -> moved node
+					{
+						classification = NewNodeClassification::Moved;
+						moveSources[i] = leftNodeIndexByHash;
+					}
+				}
 			}
+				break;
+		}
 
-			process.IncFinishedCount();
-			process.AddFinishedSize(attributes.Size());
-		});
-	}
-	threadPool.WaitForAllTasksToComplete();
+		process.IncFinishedCount();
+		process.AddFinishedSize(attributes.Size());
+	});
 	process.Finished();
+
+	//rightToLeftDiffs is sorted, so are the results
+	for(uint32 i = 0; i < nNodes; i++)
+	{
+		const uint32 index = rightToLeftDiffs[i];
+		switch(classifications[i])
+		{
+			case NewNodeClassification::DifferentData:
+				nodeIndexDifferences.differentData.Push(index);
+				break;
+			case NewNodeClassification::DifferentMetadata:
+				nodeIndexDifferences.differentMetadata.Push(index);
+				break;
+			case NewNodeClassification::Moved:
+				nodeIndexDifferences.moved.Push({ .rightIndex = index, .leftIndex = moveSources[i] });
+				break;
+			case NewNodeClassification::SpeculativeData:
+				nodeIndexDifferences.speculativeData.Push(index);
+				break;
+		}
+	}
+
+	nodeIndexDifferences.avoidedHashingSize = avoidedHashingSize;
 }
 
-NodeIndexDifferences NodeIndexDifferenceResolver::ResolveDifferences(const BackupNodeIndex &leftIndex, const FileSystemNodeIndex &rightIndex, const BinaryTreeSet<uint32> &leftToRightDiffs, const BinaryTreeSet<uint32> &rightToLeftDiffs) const
+uint32 NodeIndexDifferenceResolver::FindNodeByIdentity(const BackupNodeIndex& leftIndex, const FileSystemNodeAttributes& attributes) const
 {
-	InjectionContainer &injectionContainer = InjectionContainer::Instance();
-	StatusTracker& statusTracker = injectionContainer.StatusTracker();
-	StaticThreadPool& threadPool = injectionContainer.TaskQueue();
+	if(!attributes.Identity().HasValue() or !attributes.LastModifiedTime().HasValue())
+		return Unsigned<uint32>::Max();
 
-	const Config &config = injectionContainer.Config();
+	uint32 leftNodeIndex = leftIndex.FindNodeIndexByIdentity(*attributes.Identity());
+	if(leftNodeIndex == Unsigned<uint32>::Max())
+		return Unsigned<uint32>::Max();
 
+	//inodes are reused after deletion, so the data is only assumed to be the same if the metadata matches as well
+	const BackupNodeAttributes& leftAttributes = leftIndex.GetNodeAttributes(leftNodeIndex);
+	if(leftAttributes != attributes)
+		return Unsigned<uint32>::Max();
+	return leftNodeIndex;
+}
+
+bool NodeIndexDifferenceResolver::FingerprintRulesOutCandidates(const BackupNodeIndex& leftIndex, uint32 rightNodeIndex, const FileSystemNodeIndex& rightIndex) const
+{
+	const OSFileSystemNodeIndex* osFileSystemNodeIndex = dynamic_cast<const OSFileSystemNodeIndex *>(&rightIndex);
+	if(!osFileSystemNodeIndex)
+		return false;
+
+	const DynamicArray<uint32>& candidates = leftIndex.NodesWithSize(rightIndex.GetNodeAttributes(rightNodeIndex).Size());
+	for(uint32 candidate : candidates)
+	{
+		if(!leftIndex.GetNodeAttributes(candidate).Fingerprint().HasValue())
+			return false; //only the hash value can tell
+	}
+
+	NodeFingerprint fingerprint = osFileSystemNodeIndex->ComputeNodeFingerprint(rightNodeIndex);
+	for(uint32 candidate : candidates)
+	{
+		if(*leftIndex.GetNodeAttributes(candidate).Fingerprint() == fingerprint)
+			return false;
+	}
+	return true;
+}
+
+NodeIndexDifferences NodeIndexDifferenceResolver::ResolveDifferences(const BackupNodeIndex &leftIndex, const FileSystemNodeIndex &rightIndex, const DynamicArray<uint32> &leftToRightDiffs, const DynamicArray<uint32> &rightToLeftDiffs, bool hashNewNodes) const
+{
 	NodeIndexDifferences nodeDifferences;
 
-	nodeDifferences.deleted = this->ComputeDeleted(leftIndex, rightIndex, leftToRightDiffs);
-	this->ComputeNodeDifferences(nodeDifferences, leftIndex, rightIndex, rightToLeftDiffs);
+	DynamicArray<uint32> deleted = this->ComputeDeleted(leftIndex, rightIndex, leftToRightDiffs);
+	this->ComputeNodeDifferences(nodeDifferences, leftIndex, rightIndex, rightToLeftDiffs, hashNewNodes);
 
 	//everything that was moved was not deleted
-	for(const auto& kv : nodeDifferences.moved)
-		nodeDifferences.deleted.Remove(kv.value);
+	FixedArray<bool> isMoveSource(leftIndex.GetNumberOfNodes());
+	for(uint32 i = 0; i < leftIndex.GetNumberOfNodes(); i++)
+		isMoveSource[i] = false;
+	for(const NodeMove& move : nodeDifferences.moved)
+		isMoveSource[move.leftIndex] = true;
+
+	for(uint32 index : deleted)
+	{
+		if(!isMoveSource[index])
+			nodeDifferences.deleted.Push(index);
+	}
 
 	return nodeDifferences;
 }
 
-String NodeIndexDifferenceResolver::RetrieveNodeHash(uint32 nodeIndex, const FileSystemNodeIndex& index) const
+Digest NodeIndexDifferenceResolver::RetrieveNodeHash(uint32 nodeIndex, const FileSystemNodeIndex& index) const
 {
 	const BackupNodeIndex* backupNodeIndex = dynamic_cast<const BackupNodeIndex *>(&index);
 	if(backupNodeIndex)
@@ -35,19 +35,32 @@ struct NodeDifference
 	uint32 moveIndex;
 };
 
+struct NodeMove
+{
+	uint32 rightIndex;
+	uint32 leftIndex;
+};
+
+/**
+ * All node indices are sorted ascending, moved is sorted by the right index.
+ */
 struct NodeIndexDifferences
 {
 	//referring to the left index
-	BinaryTreeSet<uint32> deleted;
+	DynamicArray<uint32> deleted;
 	//referring to the right index
-	BinaryTreeSet<uint32> differentData; //implies also that metadata is different
-	BinaryTreeSet<uint32> differentMetadata;
-	BinaryTreeMap<uint32, uint32> moved; //maps right index to left index
+	DynamicArray<uint32> differentData; //implies also that metadata is different
+	DynamicArray<uint32> differentMetadata;
+	DynamicArray<NodeMove> moved;
+	DynamicArray<uint32> speculativeData; //either different data or moved. Can only be decided once the hash value is known, i.e. when the data is backed up
+
+	uint64 avoidedHashingSize = 0; //size of new nodes that were ruled out as copies of nodes of the left index without hashing them, because no node of the left index can have the same data
+
 
 	//Inline
 	inline bool Exist() const
     {
-	    return !(deleted.IsEmpty() and differentData.IsEmpty() and differentMetadata.IsEmpty() and moved.IsEmpty());
+	    return !(deleted.IsEmpty() and differentData.IsEmpty() and differentMetadata.IsEmpty() and moved.IsEmpty() and speculativeData.IsEmpty());
     }
 };
 
@@ -55,17 +68,32 @@ class NodeIndexDifferenceResolver
 {
 public:
 	//Methods
-	NodeIndexDifferences ComputeDiff(const BackupNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex);
+	/**
+	 * @param hashNewNodes - if false, files and links that are new or changed are not read for finding moved nodes.
+	 * They end up in speculativeData and the caller is responsible for resolving them as soon as it knows their hash
+	 * values.
+	 */
+	NodeIndexDifferences ComputeDiff(const BackupNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex, bool hashNewNodes = true);
 
 private:
 	//Methods
-	BinaryTreeSet<uint32> ComputeDeleted(const FileSystemNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex, const BinaryTreeSet<uint32>& indexes) const;
+	DynamicArray<uint32> ComputeDeleted(const FileSystemNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex, const DynamicArray<uint32>& indexes) const;
 	/**
 	 * Returns the indices from this index that are different from other
-	 * @return
+	 * @return sorted ascending
+	 */
+	DynamicArray<uint32> ComputeDifference(const FileSystemNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex) const;
+	void ComputeNodeDifferences(NodeIndexDifferences& nodeIndexDifferences, const BackupNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex, const DynamicArray<uint32>& rightToLeftDiffs, bool hashNewNodes) const;
+	/**
+	 * Finds the node of the left index that is the same file system node, i.e. it was renamed or only its metadata changed.
+	 * @return Unsigned<uint32>::Max() if the node is unknown or can't be identified without reading its data
+	 */
+	uint32 FindNodeByIdentity(const BackupNodeIndex& leftIndex, const FileSystemNodeAttributes& attributes) const;
+	/**
+	 * Compares the fingerprint of a node with the ones of all nodes of the left index that have the same size.
+	 * @return true if the data of the node is different from all of them, i.e. it doesn't need to be hashed
 	 */
-	BinaryTreeSet<uint32> ComputeDifference(const FileSystemNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex) const;
-	void ComputeNodeDifferences(NodeIndexDifferences& nodeIndexDifferences, const BackupNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex, const BinaryTreeSet<uint32>& rightToLeftDiffs) const;
-	NodeIndexDifferences ResolveDifferences(const BackupNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex, const BinaryTreeSet<uint32>& leftToRightDiffs, const BinaryTreeSet<uint32>& rightToLeftDiffs) const;
-	String RetrieveNodeHash(uint32 nodeIndex, const FileSystemNodeIndex& index) const;
+	bool FingerprintRulesOutCandidates(const BackupNodeIndex& leftIndex, uint32 rightNodeIndex, const FileSystemNodeIndex& rightIndex) const;
+	NodeIndexDifferences ResolveDifferences(const BackupNodeIndex& leftIndex, const FileSystemNodeIndex& rightIndex, const DynamicArray<uint32>& leftToRightDiffs, const DynamicArray<uint32>& rightToLeftDiffs, bool hashNewNodes) const;
+	Digest RetrieveNodeHash(uint32 nodeIndex, const FileSystemNodeIndex& index) const;
 };
\ No newline at end of file
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+
+/**
+ * Hands out the indices [0, nIndices) in chunks. The chunk size adapts to the remaining work ("guided scheduling"):
+ * while much is left, workers grab large chunks and rarely touch the lock; towards the end the chunks shrink down to
+ * single indices so that all workers finish at about the same time, even if the work per index varies.
+ */
+class ChunkedRange
+{
+public:
+	//Constructor
+	inline ChunkedRange(uint32 nIndices, uint32 nWorkers) : next(0), end(nIndices), nWorkers(Math::Max(nWorkers, 1u))
+	{
+	}
+
+	//Methods
+	/**
+	 * @return false if all indices have been handed out
+	 */
+	inline bool NextChunk(uint32& chunkBegin, uint32& chunkEnd)
+	{
+		AutoLock lock(this->lock);
+
+		if(this->next == this->end)
+			return false;
+
+		uint32 chunkSize = Math::Max((this->end - this->next) / (c_chunksPerWorker * this->nWorkers), 1u);
+		chunkBegin = this->next;
+		chunkEnd = this->next + chunkSize;
+		this->next = chunkEnd;
+
+		return true;
+	}
+
+private:
+	//Constants
+	static constexpr uint32 c_chunksPerWorker = 4;
+
+	//Members
+	Mutex lock;
+	uint32 next;
+	uint32 end;
+	uint32 nWorkers;
+};
+
+/**
+ * Calls function(i) for all i in [0, nIndices) on the task queue and waits until all calls returned.
+ * Only one task per worker is enqueued, each of them processes chunks of the range until it is exhausted.
+ * Like any wait on the task queue, this must not be called from a task of the same queue.
+ */
+template<typename FunctionType>
+void ParallelFor(StaticThreadPool& threadPool, uint32 nWorkers, uint32 nIndices, const FunctionType& function)
+{
+	if(nIndices == 0)
+		return;
+
+	ChunkedRange range(nIndices, nWorkers);
+	const uint32 nTasks = Math::Min(Math::Max(nWorkers, 1u), nIndices);
+	for(uint32 i = 0; i < nTasks; i++)
+	{
+		threadPool.EnqueueTask([&range, &function]()
+		{
+			uint32 chunkBegin, chunkEnd;
+			while(range.NextChunk(chunkBegin, chunkEnd))
+			{
+				for(uint32 j = chunkBegin; j < chunkEnd; j++)
+					function(j);
+			}
+		});
+	}
+	threadPool.WaitForAllTasksToComplete();
+}
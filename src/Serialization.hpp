@@ -35,8 +35,9 @@ namespace StdXX::Serialization
 	template <typename ArchiveType>
 	void CustomArchive(ArchiveType& ar, const String& name, CompressionSetting& compressionSetting)
 	{
-		StaticArray<Tuple<CompressionSetting, String>, 1> settingMapping = { {
-			{ CompressionSetting::lzma, u8"lzma"}
+		StaticArray<Tuple<CompressionSetting, String>, 2> settingMapping = { {
+			{ CompressionSetting::lzma, u8"lzma"},
+			{ CompressionSetting::zlib, u8"zlib"},
 		} };
 		ar & Binding(name, StringMapping(compressionSetting, settingMapping));
 	}
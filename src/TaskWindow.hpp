@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+
+/**
+ * The threads that run the tasks of all TaskWindows of the process.
+ * At most one task per thread is handed to the pool at once. A window that finds all threads busy runs its task on the
+ * calling thread instead, so that neither the number of threads nor the number of buffers of running tasks grows with
+ * the number of nodes that are processed concurrently.
+ */
+class TaskWindowPool
+{
+public:
+	//Constructor
+	inline TaskWindowPool(uint32 nThreads) : threadPool(Math::Max(nThreads, 1u)), nFreeThreads(Math::Max(nThreads, 1u))
+	{
+	}
+
+	//Methods
+	/**
+	 * @return false if all threads are busy. The task was not enqueued then.
+	 */
+	template<typename FunctionType>
+	inline bool TryEnqueue(const FunctionType& task)
+	{
+		{
+			AutoLock lock(this->lock);
+			if(this->nFreeThreads == 0)
+				return false;
+			this->nFreeThreads--;
+		}
+
+		this->threadPool.EnqueueTask([this, task]()
+		{
+			task();
+
+			AutoLock lock(this->lock);
+			this->nFreeThreads++;
+		});
+		return true;
+	}
+
+private:
+	//Members
+	StaticThreadPool threadPool;
+	Mutex lock;
+	uint32 nFreeThreads;
+};
+
+/**
+ * Runs the tasks of a single node concurrently. These can't go to the task queue, because the node itself is
+ * processed by one of its workers and all of them might be waiting for such tasks. They go to a TaskWindowPool instead.
+ * At most nSlots tasks of the window are pending at once. Slots are used round-robin, so the results of the tasks can be
+ * consumed in the order in which the tasks were started.
+ */
+class TaskWindow
+{
+	struct Slot
+	{
+		bool isFinished = true;
+		Mutex lock;
+		ConditionVariable finished;
+	};
+public:
+	//Constructor
+	inline TaskWindow(TaskWindowPool& pool, uint32 nSlots) : pool(pool), slots(Math::Max(nSlots, 1u)), oldestSlot(0), nPendingSlots(0)
+	{
+	}
+
+	//Destructor
+	inline ~TaskWindow()
+	{
+		for(uint32 i = 0; i < this->slots.GetNumberOfElements(); i++)
+			this->Wait(i);
+	}
+
+	//Properties
+	inline uint32 NumberOfSlots() const
+	{
+		return this->slots.GetNumberOfElements();
+	}
+
+	//Methods
+	/**
+	 * Returns the slot for the next task. If all slots are pending, this waits for the oldest task.
+	 * The caller can consume the result of that task before it starts the next one with Start.
+	 * @param wasUsed is set to true if the slot held the result of a task that was not consumed yet
+	 */
+	inline uint32 AcquireSlot(bool& wasUsed)
+	{
+		wasUsed = this->nPendingSlots == this->slots.GetNumberOfElements();
+		if(wasUsed)
+		{
+			uint32 slot = this->oldestSlot;
+			this->PopOldest();
+			this->Wait(slot);
+			return slot;
+		}
+		return (this->oldestSlot + this->nPendingSlots) % this->slots.GetNumberOfElements();
+	}
+
+	template<typename FunctionType>
+	inline void Start(uint32 slot, const FunctionType& task)
+	{
+		ASSERT((this->oldestSlot + this->nPendingSlots) % this->slots.GetNumberOfElements() == slot, u8"Tasks have to be started in the slot returned by AcquireSlot");
+		this->nPendingSlots++;
+
+		Slot& s = this->slots[slot];
+		s.isFinished = false;
+
+		bool enqueued = this->pool.TryEnqueue([&s, task]()
+		{
+			task();
+
+			AutoLock lock(s.lock);
+			s.isFinished = true;
+			s.finished.Signal();
+		});
+
+		if(!enqueued)
+		{
+			task();
+			s.isFinished = true;
+		}
+	}
+
+	/**
+	 * Returns the slot of the oldest pending task without waiting, if that task has finished already.
+	 * Consuming results early keeps the memory of finished tasks from piling up while later tasks are still running.
+	 */
+	inline bool TryAcquireFinishedSlot(uint32& slot)
+	{
+		if(this->nPendingSlots == 0)
+			return false;
+
+		{
+			Slot& s = this->slots[this->oldestSlot];
+			AutoLock lock(s.lock);
+			if(!s.isFinished)
+				return false;
+		}
+
+		slot = this->oldestSlot;
+		this->PopOldest();
+		return true;
+	}
+
+	/**
+	 * Waits for all started tasks. The slots are returned in the order in which their tasks were started.
+	 */
+	template<typename FunctionType>
+	inline void WaitForAll(const FunctionType& consumeSlot)
+	{
+		while(this->nPendingSlots)
+		{
+			uint32 slot = this->oldestSlot;
+			this->PopOldest();
+			this->Wait(slot);
+			consumeSlot(slot);
+		}
+	}
+
+private:
+	//Members
+	TaskWindowPool& pool;
+	FixedArray<Slot> slots;
+	uint32 oldestSlot;
+	uint32 nPendingSlots;
+
+	//Methods
+	inline void PopOldest()
+	{
+		this->oldestSlot = (this->oldestSlot + 1) % this->slots.GetNumberOfElements();
+		this->nPendingSlots--;
+	}
+
+	inline void Wait(uint32 slot)
+	{
+		Slot& s = this->slots[slot];
+
+		AutoLock lock(s.lock);
+		while(!s.isFinished)
+			s.finished.Wait(s.lock);
+	}
+};
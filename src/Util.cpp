@@ -19,6 +19,62 @@
 //Corresponding header
 #include "Util.hpp"
 
+//Local functions
+static uint8 HexDigitToNibble(uint32 codePoint)
+{
+	if((codePoint >= u8'0') and (codePoint <= u8'9'))
+		return codePoint - u8'0';
+	if((codePoint >= u8'a') and (codePoint <= u8'f'))
+		return codePoint - u8'a' + 10;
+	if((codePoint >= u8'A') and (codePoint <= u8'F'))
+		return codePoint - u8'A' + 10;
+	throw ErrorHandling::VerificationFailedException();
+}
+
+//Global functions
+int64 DateTimeToMilliseconds(const DateTime& dateTime)
+{
+	return dateTime.ToUnixTimestamp() * 1000 + dateTime.GetTime().Milliseconds();
+}
+
+String DigestToHexString(const uint8* digest, uint8 digestSize)
+{
+	static const char8_t* const c_hexDigits = u8"0123456789abcdef";
+
+	String result;
+	for(uint8 i = 0; i < digestSize; i++)
+	{
+		result += c_hexDigits[digest[i] >> 4];
+		result += c_hexDigits[digest[i] & 0xF];
+	}
+	return result;
+}
+
+uint8 HexStringToDigest(const String& hexString, uint8* digest, uint8 capacity)
+{
+	uint8 digestSize = 0;
+	auto it = hexString.begin();
+	while(it != hexString.end())
+	{
+		uint8 high = HexDigitToNibble(*it);
+		++it;
+		if(it == hexString.end())
+			throw ErrorHandling::VerificationFailedException();
+		uint8 low = HexDigitToNibble(*it);
+		++it;
+
+		if(digestSize == capacity)
+			throw ErrorHandling::VerificationFailedException();
+		digest[digestSize++] = (high << 4) | low;
+	}
+	return digestSize;
+}
+
+DateTime MillisecondsToDateTime(int64 milliseconds)
+{
+	return DateTime::FromUnixTimeStampWithMilliSeconds(milliseconds);
+}
+
 void UnprotectFile(const Path& filePath)
 {
 	File file(filePath);
@@ -20,5 +20,17 @@
 using namespace StdXX;
 using namespace StdXX::FileSystem;
 
+/**
+ * Converts a hash value in hex notation into its raw bytes.
+ * Throws a VerificationFailedException if the hash value is malformed or doesn't fit into capacity bytes.
+ * @return the number of bytes of the digest
+ */
+uint8 HexStringToDigest(const String& hexString, uint8* digest, uint8 capacity);
+String DigestToHexString(const uint8* digest, uint8 digestSize);
+/**
+ * Milliseconds since the unix epoch. This is how points in time are stored in binary files.
+ */
+int64 DateTimeToMilliseconds(const DateTime& dateTime);
+DateTime MillisecondsToDateTime(int64 milliseconds);
 void UnprotectFile(const Path& filePath);
 void WriteProtectFile(const Path& filePath);
\ No newline at end of file
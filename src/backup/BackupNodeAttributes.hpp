@@ -19,7 +19,9 @@
 #pragma once
 //Local
 #include "../indexing/FileSystemNodeAttributes.hpp"
+#include "../indexing/NodeFingerprint.hpp"
 #include "../CompressionSetting.hpp"
+#include "../Digest.hpp"
 //Namespaces
 using namespace StdXX::FileSystem;
 
@@ -30,13 +32,46 @@ struct Block
 	uint64 size;
 };
 
+struct ChunkReference
+{
+	Digest hash;
+	uint64 size;
+};
+
+struct DataLocation
+{
+	String snapshotName;
+	uint32 nodeIndex;
+};
+
+/**
+ * Large files are compressed in frames, which are independent compressed streams, so that they can be compressed
+ * concurrently and read from any frame on. All frames have the same uncompressed size except for the last one.
+ * The compressed frames follow each other in the blocks of the node.
+ */
+struct FrameTable
+{
+	uint64 frameSize;
+	DynamicArray<uint64> compressedSizes;
+};
+
+/**
+ * Small files are compressed together as one stream, a solid group. The blocks and the compression setting of the
+ * group are stored on its first member, the leader.
+ */
+struct SolidGroupMembership
+{
+	uint32 leaderNodeIndex;
+	uint64 offset; //of the data of the node within the decompressed stream of the group
+};
+
 class BackupNodeAttributes : public FileSystemNodeAttributes
 {
 public:
 	//Constructors
-	inline BackupNodeAttributes(FileType type, uint64 size, const Optional<DateTime>& lastModifiedTime, UniquePointer<FileSystem::Permissions>&& permissions, DynamicArray<Block>&& blocks, BinaryTreeMap<Crypto::HashAlgorithm, String>&& hashes)
+	inline BackupNodeAttributes(FileType type, uint64 size, const Optional<DateTime>& lastModifiedTime, UniquePointer<FileSystem::Permissions>&& permissions, DynamicArray<Block>&& blocks, DynamicArray<HashValue>&& hashes)
 		: FileSystemNodeAttributes(type, size, lastModifiedTime, Move(permissions)),
-		blocks(Forward<DynamicArray<Block>>(blocks)), hashes(Forward<BinaryTreeMap<Crypto::HashAlgorithm, String>>(hashes))
+		blocks(Forward<DynamicArray<Block>>(blocks)), hashes(Forward<DynamicArray<HashValue>>(hashes))
 	{
 	}
 
@@ -57,11 +92,38 @@ public:
 		this->backReferenceTarget = backreferenceTarget;
 	}
 
+	/**
+	 * For nodes that don't own their data: the snapshot and node where the data is actually stored.
+	 * It is resolved when the snapshot is written, so that the data can be found without walking the snapshot chain.
+	 */
+	inline const Optional<struct DataLocation>& DataLocation() const
+	{
+		return this->dataLocation;
+	}
+
+	inline void DataLocation(const Optional<struct DataLocation>& dataLocation)
+	{
+		this->dataLocation = dataLocation;
+	}
+
 	inline const DynamicArray<Block>& Blocks() const
 	{
 		return this->blocks;
 	}
 
+	/**
+	 * If the node was backed up in chunking mode, its data is not stored in blocks of the snapshot but in the chunk store.
+	 */
+	inline const DynamicArray<ChunkReference>& Chunks() const
+	{
+		return this->chunks;
+	}
+
+	inline void Chunks(DynamicArray<ChunkReference>&& chunks)
+	{
+		this->chunks = Move(chunks);
+	}
+
 	inline const Optional<enum CompressionSetting>& CompressionSetting() const
 	{
 		return this->compressionSetting;
@@ -72,16 +134,54 @@ public:
 		this->compressionSetting = compressionSetting;
 	}
 
-	inline const String& Hash(Crypto::HashAlgorithm hashAlgorithm) const
+	/**
+	 * Not known for nodes that were backed up by older versions.
+	 */
+	inline const Optional<FrameTable>& Frames() const
+	{
+		return this->frames;
+	}
+
+	inline void Frames(FrameTable&& frames)
+	{
+		this->frames = Move(frames);
+	}
+
+	inline const Optional<NodeFingerprint>& Fingerprint() const
+	{
+		return this->fingerprint;
+	}
+
+	inline void Fingerprint(const NodeFingerprint& fingerprint)
+	{
+		this->fingerprint = fingerprint;
+	}
+
+	inline const Digest& Hash(Crypto::HashAlgorithm hashAlgorithm) const
 	{
-		return this->hashes[hashAlgorithm];
+		const Digest* digest = this->FindHash(hashAlgorithm);
+		ASSERT(digest, u8"Node has no hash value for this algorithm");
+		return *digest;
 	}
 
-	inline const BinaryTreeMap<Crypto::HashAlgorithm, String>& HashValues() const
+	inline const DynamicArray<HashValue>& HashValues() const
 	{
 		return this->hashes;
 	}
 
+	/**
+	 * Only meaningful for nodes that own their data.
+	 */
+	inline const Optional<SolidGroupMembership>& SolidGroup() const
+	{
+		return this->solidGroup;
+	}
+
+	inline void SolidGroup(const Optional<SolidGroupMembership>& solidGroup)
+	{
+		this->solidGroup = solidGroup;
+	}
+
 	inline bool OwnsBlocks() const
 	{
 		return this->ownsBlocks;
@@ -97,21 +197,54 @@ public:
 	uint64 ComputeSumOfBlockSizes() const;
 
 	//Inline
-	inline void AddHashValue(Crypto::HashAlgorithm hashAlgorithm, const String& hashValue)
+	inline void AddChunk(const ChunkReference& chunkReference)
 	{
-		if(this->hashes.Contains(hashAlgorithm))
+		this->ownsBlocks = true;
+		this->chunks.Push(chunkReference);
+	}
+
+	inline void AddHashValue(Crypto::HashAlgorithm hashAlgorithm, const Digest& digest)
+	{
+		const Digest* existing = this->FindHash(hashAlgorithm);
+		if(existing)
 		{
-			if(this->hashes[hashAlgorithm] != hashValue)
+			if(*existing != digest)
 				throw ErrorHandling::VerificationFailedException();
+			return;
+		}
+		this->hashes.Push({ .algorithm = hashAlgorithm, .digest = digest });
+	}
+
+	/**
+	 * @return nullptr if the node has no hash value for this algorithm
+	 */
+	inline const Digest* FindHash(Crypto::HashAlgorithm hashAlgorithm) const
+	{
+		for(const HashValue& hashValue : this->hashes)
+		{
+			if(hashValue.algorithm == hashAlgorithm)
+				return &hashValue.digest;
 		}
-		this->hashes[hashAlgorithm] = hashValue;
+		return nullptr;
+	}
+
+	inline DynamicArray<Block> RemoveBlocks()
+	{
+		DynamicArray<Block> removed = Move(this->blocks);
+		this->blocks.Release();
+		return removed;
 	}
 
 private:
 	//Members
-	bool ownsBlocks;
+	bool ownsBlocks = false;
 	Optional<enum CompressionSetting> compressionSetting;
 	Optional<Path> backReferenceTarget;
+	Optional<struct DataLocation> dataLocation;
+	Optional<NodeFingerprint> fingerprint;
+	Optional<FrameTable> frames;
+	Optional<SolidGroupMembership> solidGroup;
 	DynamicArray<Block> blocks;
-	BinaryTreeMap<Crypto::HashAlgorithm, String> hashes;
+	DynamicArray<ChunkReference> chunks;
+	DynamicArray<HashValue> hashes;
 };
\ No newline at end of file
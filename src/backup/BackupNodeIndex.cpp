@@ -19,6 +19,7 @@
 //Class header
 #include "BackupNodeIndex.hpp"
 //Local
+#include "MappedIndexFile.hpp"
 #include "../config/ConfigManager.hpp"
 #include "../InjectionContainer.hpp"
 #include "../Serialization.hpp"
@@ -37,6 +38,11 @@ static const char8_t *const c_tag_node_blocks_block_name = u8"Block";
 static const char8_t *const c_tag_node_blocks_block_attribute_offset = u8"offset";
 static const char8_t *const c_tag_node_blocks_block_attribute_size = u8"size";
 static const char8_t *const c_tag_node_blocks_block_attribute_volumeNumber = u8"volumeNumber";
+static const char8_t *const c_tag_node_chunks_name = u8"Chunks";
+static const char8_t *const c_tag_node_chunks_attribute_owned_name = u8"owned";
+static const char8_t *const c_tag_node_chunks_chunk_name = u8"Chunk";
+static const char8_t *const c_tag_node_chunks_chunk_attribute_hash = u8"hash";
+static const char8_t *const c_tag_node_chunks_chunk_attribute_size = u8"size";
 static const char8_t *const c_tag_node_lastModified_name = u8"LastModified";
 static const char8_t *const c_tag_node_permissions_name = u8"Permissions";
 static const char8_t* const c_tag_node_permissions_attribute_type_name = u8"type";
@@ -51,11 +57,6 @@ static const char8_t *const c_tag_node_hashValues_name = u8"HashValues";
 
 namespace StdXX::Serialization
 {
-	inline void operator<<(XmlSerializer& serializer, const DateTime& value)
-	{
-		serializer << value.ToISOString();
-	}
-
 	template <typename ArchiveType>
 	void CustomArchive(ArchiveType& ar, Block& block)
 	{
@@ -70,6 +71,21 @@ namespace StdXX::Serialization
 		ar.LeaveElement();
 	}
 
+	template <typename ArchiveType>
+	void CustomArchive(ArchiveType& ar, ChunkReference& chunkReference)
+	{
+		ar.EnterElement(c_tag_node_chunks_chunk_name);
+		ar.EnterAttributes();
+
+		String hashValue;
+		ar & Binding(c_tag_node_chunks_chunk_attribute_hash, hashValue);
+		chunkReference.hash = Digest::FromHexString(hashValue);
+		ar & Binding(c_tag_node_chunks_chunk_attribute_size, chunkReference.size);
+
+		ar.LeaveAttributes();
+		ar.LeaveElement();
+	}
+
 	template <typename ArchiveType>
 	void CustomArchive(ArchiveType& ar, Crypto::HashAlgorithm& hashAlgorithm, String& hashValue)
 	{
@@ -107,17 +123,57 @@ namespace StdXX::Serialization
 
         posixPermissions = POSIXPermissions(uid, gid, mode);
     }
+}
 
-	template <typename ArchiveType>
-	void CustomArchive(ArchiveType& ar, const POSIXPermissions& posixPermissions)
-    {
-	    ar & Binding(u8"owner", posixPermissions.userId);
-        ar & Binding(u8"group", posixPermissions.groupId);
-        ar & Binding(u8"mode", posixPermissions.EncodeMode());
-    }
+//Local functions
+static Path ReadNodePath(const MappedIndexFile& indexFile, uint32 nodeIndex)
+{
+	DynamicArray<String> namesFromLeaf;
+	for(uint32 current = nodeIndex; current != Unsigned<uint32>::Max(); current = indexFile.ReadParentIndex(current))
+	{
+		if( (current >= indexFile.NumberOfNodes()) or (namesFromLeaf.GetNumberOfElements() > indexFile.NumberOfNodes()) )
+			throw ErrorHandling::VerificationFailedException(); //invalid index or cycle
+		namesFromLeaf.Push(indexFile.ReadNodeName(current));
+	}
+
+	Path path = namesFromLeaf.Last();
+	for(uint32 i = namesFromLeaf.GetNumberOfElements() - 1; i--;)
+		path = path / namesFromLeaf[i];
+	return path;
+}
+
+//Constructors
+BackupNodeIndex::BackupNodeIndex(const MappedIndexFile& indexFile)
+{
+	uint32 nNodes = indexFile.NumberOfNodes();
+	for(uint32 i = 0; i < nNodes; i++)
+	{
+		uint32 parentIndex = indexFile.ReadParentIndex(i);
+		if(parentIndex == Unsigned<uint32>::Max())
+			this->AddNode(indexFile.ReadNodeName(i), indexFile.ReadNodeAttributes(i));
+		else if(parentIndex < i)
+		{
+			//nodes store only their names, so attach them directly to the entry of their parent
+			uint32 nameSize;
+			const uint8* name = indexFile.GetNodeNameBytes(i, nameSize);
+			this->AddChildNode(parentIndex, name, nameSize, indexFile.ReadNodeAttributes(i));
+		}
+		else
+		{
+			//the parent comes later in the file, build the path from the names of the ancestors
+			if(parentIndex >= nNodes)
+				throw ErrorHandling::VerificationFailedException();
+			this->AddNode(ReadNodePath(indexFile, i), indexFile.ReadNodeAttributes(i));
+		}
+
+		if(parentIndex != Unsigned<uint32>::Max())
+			this->nodeChildren[parentIndex].Push(i);
+	}
+
+	this->GenerateHashIndex();
+	this->GenerateIdentityIndex();
 }
 
-//Constructor
 BackupNodeIndex::BackupNodeIndex(XMLDeserializer &xmlDeserializer)
 {
 	xmlDeserializer.EnterElement(c_tag_snapshotIndex_name);
@@ -163,10 +219,15 @@ uint64 BackupNodeIndex::ComputeSumOfOwnedBlockSizes() const
 	return sum;
 }
 
-uint32 BackupNodeIndex::FindNodeIndexByHash(const String& hash) const
+uint32 BackupNodeIndex::FindNodeIndexByHash(const Digest& hash) const
+{
+	return this->hashIndex.Find(hash);
+}
+
+uint32 BackupNodeIndex::FindNodeIndexByIdentity(const NodeIdentity& identity) const
 {
-	if(this->hashIndex.Contains(hash))
-		return this->hashIndex[hash];
+	if(this->identityIndex.Contains(identity))
+		return this->identityIndex[identity];
 	return Unsigned<uint32>::Max();
 }
 
@@ -182,31 +243,14 @@ FileInfo BackupNodeIndex::GetFileSystemNodeInfo(uint32 nodeIndex) const
 	return fileSystemNodeInfo;
 }
 
-void BackupNodeIndex::Serialize(XmlSerializer& xmlSerializer) const
-{
-	xmlSerializer.EnterElement(c_tag_snapshotIndex_name);
-	xmlSerializer.EnterElement(c_tag_nodes_name);
-
-	for(uint32 i = 0; i < this->GetNumberOfNodes(); i++)
-	{
-		this->SerializeNode(xmlSerializer, this->GetNodePath(i), this->GetNodeAttributes(i));
-	}
-
-	xmlSerializer.LeaveElement();
-	xmlSerializer.LeaveElement();
-}
-
 //Private methods
 void BackupNodeIndex::ComputeNodeChildren()
 {
 	for(uint32 i = 0; i < this->GetNumberOfNodes(); i++)
 	{
-		const Path& path = this->GetNodePath(i);
-		if(path.IsRoot())
-			continue;
-		Path parentPath = path.GetParent();
-		if(this->HasNodeIndex(parentPath))
-			this->nodeChildren[this->GetNodeIndex(parentPath)].Push(i);
+		uint32 parentIndex = this->GetParentNodeIndex(i);
+		if(parentIndex != Unsigned<uint32>::Max())
+			this->nodeChildren[parentIndex].Push(i);
 	}
 }
 
@@ -238,12 +282,38 @@ DynamicArray<Block> BackupNodeIndex::DeserializeBlocks(XMLDeserializer &xmlDeser
 	return blocks;
 }
 
-BinaryTreeMap<Crypto::HashAlgorithm, String> BackupNodeIndex::DeserializeHashes(Serialization::XMLDeserializer &xmlDeserializer)
+DynamicArray<ChunkReference> BackupNodeIndex::DeserializeChunks(XMLDeserializer &xmlDeserializer, bool& ownsBlocks)
+{
+	if(!xmlDeserializer.HasChildElement(c_tag_node_chunks_name))
+		return {};
+
+	xmlDeserializer.EnterElement(c_tag_node_chunks_name);
+
+	xmlDeserializer.EnterAttributes();
+	xmlDeserializer & Binding(c_tag_node_chunks_attribute_owned_name, ownsBlocks);
+	xmlDeserializer.LeaveAttributes();
+
+	DynamicArray<ChunkReference> chunks;
+	while(xmlDeserializer.MoreChildrenExistsAtCurrentLevel())
+	{
+		ChunkReference chunkReference;
+
+		CustomArchive(xmlDeserializer, chunkReference);
+
+		chunks.Push(chunkReference);
+	}
+
+	xmlDeserializer.LeaveElement();
+
+	return chunks;
+}
+
+DynamicArray<HashValue> BackupNodeIndex::DeserializeHashes(Serialization::XMLDeserializer &xmlDeserializer)
 {
 	if(!xmlDeserializer.HasChildElement(c_tag_node_hashValues_name))
 		return {};
 
-	BinaryTreeMap<Crypto::HashAlgorithm, String> result;
+	DynamicArray<HashValue> result;
 
 	xmlDeserializer.EnterElement(c_tag_node_hashValues_name);
 	while(xmlDeserializer.MoreChildrenExistsAtCurrentLevel())
@@ -253,7 +323,7 @@ BinaryTreeMap<Crypto::HashAlgorithm, String> BackupNodeIndex::DeserializeHashes(
 
 		CustomArchive(xmlDeserializer, hashAlgorithm, hashValue);
 
-		result[hashAlgorithm] = hashValue;
+		result.Push({ .algorithm = hashAlgorithm, .digest = Digest::FromHexString(hashValue) });
 	}
 	xmlDeserializer.LeaveElement();
 
@@ -290,9 +360,11 @@ void BackupNodeIndex::DeserializeNode(XMLDeserializer& xmlDeserializer)
 	Optional<CompressionSetting> compressionSetting;
 	Optional<Path> owner;
 	DynamicArray<Block> blocks = this->DeserializeBlocks(xmlDeserializer, ownsBlocks, compressionSetting, owner);
-	BinaryTreeMap<Crypto::HashAlgorithm, String> hashes = this->DeserializeHashes(xmlDeserializer);
+	DynamicArray<ChunkReference> chunks = this->DeserializeChunks(xmlDeserializer, ownsBlocks);
+	DynamicArray<HashValue> hashes = this->DeserializeHashes(xmlDeserializer);
 
 	UniquePointer<BackupNodeAttributes> attributes = new BackupNodeAttributes(type, size, lastModifiedTime, Move(permissions), Move(blocks), Move(hashes));
+	attributes->Chunks(Move(chunks));
 	attributes->OwnsBlocks(ownsBlocks);
 	attributes->CompressionSetting(compressionSetting);
 	attributes->BackReferenceTarget(owner);
@@ -329,96 +401,30 @@ void BackupNodeIndex::GenerateHashIndex()
 {
     Crypto::HashAlgorithm hashAlgorithm = InjectionContainer::Instance().Config().hashAlgorithm;
 
+    this->hashIndex.Reserve(this->GetNumberOfNodes());
     for(uint32 i = 0; i < this->GetNumberOfNodes(); i++)
     {
         const BackupNodeAttributes& attributes = this->GetNodeAttributes(i);
-        if(attributes.HashValues().Contains(hashAlgorithm))
-            this->hashIndex[attributes.Hash(hashAlgorithm)] = i;
+        const Digest* digest = attributes.FindHash(hashAlgorithm);
+        if(digest)
+        {
+            this->hashIndex.Insert(*digest, i);
+            this->sizeIndex[attributes.Size()].Push(i);
+        }
     }
 }
 
-void BackupNodeIndex::SerializeBlocks(Serialization::XmlSerializer& xmlSerializer, const DynamicArray<Block> &blocks, bool ownsBlocks, Optional<CompressionSetting>& compressionSetting, Optional<Path>& owner) const
-{
-	if(blocks.IsEmpty())
-		return;
-
-	xmlSerializer.EnterElement(c_tag_node_blocks_name);
-	xmlSerializer.EnterAttributes();
-	xmlSerializer & Binding(c_tag_node_blocks_attribute_owned_name, ownsBlocks);
-	xmlSerializer & Binding(c_tag_node_blocks_attribute_owner_name, owner);
-	xmlSerializer & Binding(c_tag_node_blocks_attribute_compression_name, compressionSetting);
-	xmlSerializer.LeaveAttributes();
-
-	for(Block block : blocks)
-	{
-		CustomArchive(xmlSerializer, block);
-	}
-
-	xmlSerializer.LeaveElement();
-}
-
-void BackupNodeIndex::SerializeHashes(Serialization::XmlSerializer &xmlSerializer, const BinaryTreeMap<Crypto::HashAlgorithm, String> &hashes) const
+void BackupNodeIndex::GenerateIdentityIndex()
 {
-	if(hashes.IsEmpty())
-		return;
-
-	xmlSerializer.EnterElement(c_tag_node_hashValues_name);
-	for(KeyValuePair<Crypto::HashAlgorithm, String> kv : hashes)
+	for(uint32 i = 0; i < this->GetNumberOfNodes(); i++)
 	{
-		CustomArchive(xmlSerializer, kv.key, kv.value);
-	}
-	xmlSerializer.LeaveElement();
-}
-
-void BackupNodeIndex::SerializeNode(XmlSerializer& xmlSerializer, const Path &path, const BackupNodeAttributes& attributes) const
-{
-	xmlSerializer.EnterElement(c_tag_node_name);
-
-	xmlSerializer.EnterAttributes();
-	FileType type = attributes.Type();
-	CustomArchive(xmlSerializer, c_tag_node_attribute_type_name, type);
-	xmlSerializer.LeaveAttributes();
-
-	xmlSerializer & Binding(c_tag_path_name, path);
+		const Optional<NodeIdentity>& identity = this->GetNodeAttributes(i).Identity();
+		if(!identity.HasValue())
+			continue;
 
-	if(attributes.LastModifiedTime().HasValue())
-	{
-		xmlSerializer & Binding(c_tag_node_lastModified_name, *attributes.LastModifiedTime());
+		if(this->identityIndex.Contains(*identity))
+			this->identityIndex[*identity] = Unsigned<uint32>::Max(); //ambiguous
+		else
+			this->identityIndex.Insert(*identity, i);
 	}
-
-	this->SerializePermissions(xmlSerializer, attributes.Permissions());
-
-	uint64 size = attributes.Size();
-	if(attributes.Type() != FileType::Directory)
-		xmlSerializer & Binding(c_tag_node_size_name, size);
-
-	Optional<CompressionSetting> compressionSetting = attributes.CompressionSetting();
-	Optional<Path> backreferenceTarget = attributes.BackReferenceTarget();
-	this->SerializeBlocks(xmlSerializer, attributes.Blocks(), attributes.OwnsBlocks(), compressionSetting, backreferenceTarget);
-	this->SerializeHashes(xmlSerializer, attributes.HashValues());
-
-	xmlSerializer.LeaveElement();
 }
-
-void BackupNodeIndex::SerializePermissions(Serialization::XmlSerializer& xmlSerializer, const Permissions &nodePermissions) const
-{
-    xmlSerializer.EnterElement(c_tag_node_permissions_name);
-
-    const POSIXPermissions* posixPermissions = dynamic_cast<const POSIXPermissions *>(&nodePermissions);
-
-    xmlSerializer.EnterAttributes();
-    if(posixPermissions)
-    {
-        xmlSerializer & Binding(c_tag_node_permissions_attribute_type_name, c_tag_node_permissions_attribute_type_POSIX);
-    }
-    else
-    {
-        NOT_IMPLEMENTED_ERROR; //implement me
-    }
-    xmlSerializer.LeaveAttributes();
-
-    if(posixPermissions)
-        CustomArchive(xmlSerializer, *posixPermissions);
-
-    xmlSerializer.LeaveElement();
-}
\ No newline at end of file
@@ -20,33 +20,72 @@
 //Local
 #include "../indexing/FileSystemNodeIndex.hpp"
 #include "BackupNodeAttributes.hpp"
+#include "DigestIndex.hpp"
 
 class BackupNodeIndex : public FileSystemNodeIndex
 {
 public:
 	//Constructors
 	BackupNodeIndex() = default;
+	BackupNodeIndex(const class MappedIndexFile& indexFile);
+	/**
+	 * Reads an index in the legacy XML format.
+	 */
 	BackupNodeIndex(StdXX::Serialization::XMLDeserializer& xmlDeserializer);
 
 	//Methods
 	uint64 ComputeSumOfBlockSizes() const;
 	uint64 ComputeSumOfOwnedBlockSizes() const;
-	uint32 FindNodeIndexByHash(const String& hash) const;
+	uint32 FindNodeIndexByHash(const Digest& hash) const;
+	/**
+	 * @return the index of the only node with the given identity or Unsigned<uint32>::Max() if there is none or several
+	 * nodes share it (i.e. hard links)
+	 */
+	uint32 FindNodeIndexByIdentity(const NodeIdentity& identity) const;
 	FileInfo GetFileSystemNodeInfo(uint32 nodeIndex) const;
-	void Serialize(Serialization::XmlSerializer& xmlSerializer) const;
 
 	//Properties
-	inline const DynamicArray<uint32> ChildrenOf(uint32 directoryIndex) const
+	inline const DynamicArray<uint32>& ChildrenOf(uint32 directoryIndex) const
 	{
-		return this->nodeChildren[directoryIndex];
+		static const DynamicArray<uint32> noChildren;
+
+		if(this->nodeChildren.Contains(directoryIndex))
+			return this->nodeChildren[directoryIndex];
+		return noChildren;
+	}
+
+	/**
+	 * The nodes that have a hash value and the given size, i.e. the only ones FindNodeIndexByHash could find for data of
+	 * that size.
+	 */
+	inline const DynamicArray<uint32>& NodesWithSize(uint64 size) const
+	{
+		static const DynamicArray<uint32> noNodes;
+
+		if(this->sizeIndex.Contains(size))
+			return this->sizeIndex[size];
+		return noNodes;
 	}
 
 	//Inline
-	inline void AddBlock(const Path& path, uint64 volumeNumber, uint64 offset, uint64 size)
+	inline void AddBlocks(const Path& path, const DynamicArray<Block>& blocks)
+	{
+		uint32 nodeIndex = this->GetNodeIndex(path);
+		BackupNodeAttributes& attributes = this->GetChangeableNodeAttributes(nodeIndex);
+		for(const Block& block : blocks)
+			attributes.AddBlock(block);
+	}
+
+	inline DynamicArray<Block> RemoveBlocks(const Path& path)
 	{
 		uint32 nodeIndex = this->GetNodeIndex(path);
 		BackupNodeAttributes& attributes = this->GetChangeableNodeAttributes(nodeIndex);
-		attributes.AddBlock({ .volumeNumber =  volumeNumber, .offset = offset, .size = size });
+		return attributes.RemoveBlocks();
+	}
+
+	inline BackupNodeAttributes& GetChangeableNodeAttributes(uint32 index)
+	{
+		return (BackupNodeAttributes&)FileSystemNodeIndex::GetNodeAttributes(index);
 	}
 
 	inline const BackupNodeAttributes& GetNodeAttributes(uint32 index) const
@@ -63,23 +102,17 @@ public:
 private:
 	//Members
 	BinaryTreeMap<uint32, DynamicArray<uint32>> nodeChildren;
-	BinaryTreeMap<String, uint32> hashIndex;
+	DigestIndex hashIndex;
+	BinaryTreeMap<NodeIdentity, uint32> identityIndex;
+	BinaryTreeMap<uint64, DynamicArray<uint32>> sizeIndex;
 
 	//Methods
 	void ComputeNodeChildren();
 	DynamicArray<Block> DeserializeBlocks(StdXX::Serialization::XMLDeserializer& xmlDeserializer, bool& ownsBlocks, Optional<enum CompressionSetting>& compressionSetting, Optional<Path>& owner);
-	BinaryTreeMap<Crypto::HashAlgorithm, String> DeserializeHashes(StdXX::Serialization::XMLDeserializer& xmlDeserializer);
+	DynamicArray<ChunkReference> DeserializeChunks(StdXX::Serialization::XMLDeserializer& xmlDeserializer, bool& ownsBlocks);
+	DynamicArray<HashValue> DeserializeHashes(StdXX::Serialization::XMLDeserializer& xmlDeserializer);
 	void DeserializeNode(StdXX::Serialization::XMLDeserializer& xmlDeserializer);
 	UniquePointer<Permissions> DeserializePermissions(StdXX::Serialization::XMLDeserializer& xmlDeserializer);
     void GenerateHashIndex();
-	void SerializeBlocks(Serialization::XmlSerializer& xmlSerializer, const DynamicArray<Block>& blocks, bool ownsBlocks, Optional<CompressionSetting>& compressionSetting, Optional<Path>& owner) const;
-	void SerializeHashes(Serialization::XmlSerializer& xmlSerializer, const BinaryTreeMap<Crypto::HashAlgorithm, String>& hashes) const;
-	void SerializeNode(Serialization::XmlSerializer& xmlSerializer, const Path &path, const BackupNodeAttributes& attributes) const;
-	void SerializePermissions(Serialization::XmlSerializer& xmlSerializer, const Permissions& nodePermissions) const;
-
-	//Inline
-    inline BackupNodeAttributes& GetChangeableNodeAttributes(uint32 index)
-    {
-        return (BackupNodeAttributes&)FileSystemNodeIndex::GetNodeAttributes(index);
-    }
+	void GenerateIdentityIndex();
 };
\ No newline at end of file
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "ChunkStore.hpp"
+//Local
+#include "../InjectionContainer.hpp"
+#include "../config/ConfigManager.hpp"
+#include "../Util.hpp"
+#include "DynamicArrayOutputStream.hpp"
+
+//Constructor
+ChunkStore::ChunkStore(const Path& dirPath) : dirPath(dirPath)
+{
+	this->ReadIndex();
+}
+
+//Public methods
+uint64 ChunkStore::AddChunk(const Digest& hash, const void* data, uint32 size, const Optional<CompressionMethod>& compressionMethod)
+{
+	InjectionContainer &injectionContainer = InjectionContainer::Instance();
+	const ConfigManager &configManager = injectionContainer.ConfigManager();
+	const Config &config = configManager.Config();
+
+	{
+		AutoLock lock(this->chunksLock);
+		//another file may be writing the same chunk right now, it can only be referenced once it is committed
+		while(this->pendingChunks.Contains(hash))
+			this->chunkCommitted.Wait(this->chunksLock);
+		if(this->chunkNodeIndices->Find(hash) != Unsigned<uint32>::Max())
+			return 0;
+		this->pendingChunks.Insert(hash);
+	}
+	PendingChunkMark pendingChunkMark(*this, hash);
+
+	//compressed in memory, so that nothing is written for a chunk that fails to compress
+	DynamicArray<uint8> compressed;
+	if(compressionMethod.HasValue())
+	{
+		DynamicArrayOutputStream compressedBuffer(compressed);
+		UniquePointer<Compressor> compressor = ConfigManager::CreateCompressor(*compressionMethod, compressedBuffer);
+		compressor->WriteBytes(data, size);
+		compressor->Finalize();
+	}
+
+	//the data is written through to the volumes, the blocks are committed when the chunk is published
+	Path chunkPath = this->ChunkPath(hash);
+	UniquePointer<OutputStream> chunkOutputStream = this->fileSystem->CreateFile(chunkPath);
+	try
+	{
+		if(compressionMethod.HasValue())
+			chunkOutputStream->WriteBytes(compressed.Data(), compressed.GetNumberOfElements());
+		else
+			chunkOutputStream->WriteBytes(data, size);
+	}
+	catch(...)
+	{
+		this->fileSystem->DiscardFile(*chunkOutputStream, chunkPath);
+		throw;
+	}
+
+	AutoLock lock(this->chunksLock);
+
+	BackupNodeAttributes* attributes = new BackupNodeAttributes(FileType::File, size, {}, new POSIXPermissions(0, 0, 0), {}, {});
+	attributes->AddHashValue(config.hashAlgorithm, hash);
+	if(compressionMethod.HasValue())
+		attributes->CompressionSetting(compressionMethod->setting);
+	uint32 nodeIndex = this->index->AddNode(chunkPath, attributes);
+	chunkOutputStream->Flush(); //commits the written blocks to the index
+	this->chunkNodeIndices->Insert(hash, nodeIndex);
+
+	return attributes->ComputeSumOfBlockSizes();
+}
+
+UniquePointer<InputStream> ChunkStore::OpenChunk(const Digest& hash, bool verify) const
+{
+	//chunks are only read after the store was reloaded, i.e. no chunks are added concurrently
+	uint32 nodeIndex = this->chunkNodeIndices->Find(hash);
+	if(nodeIndex == Unsigned<uint32>::Max())
+		throw ErrorHandling::VerificationFailedException(); //chunk is referenced but missing in the store
+	return this->fileSystem->OpenFileForReading(nodeIndex, verify);
+}
+
+void ChunkStore::Reload()
+{
+	this->fileSystem = nullptr;
+	this->chunkNodeIndices = nullptr;
+	this->index = nullptr;
+
+	this->ReadIndex();
+}
+
+void ChunkStore::Serialize() const
+{
+	if(this->index->GetNumberOfNodes() == 0)
+		return; //chunking was never used, don't clutter the backup directory
+
+	WriteIndexFile(*this->index, this->IndexFilePath(), this->IndexHashFilePath());
+}
+
+void ChunkStore::Unprotect()
+{
+	File dir(this->dirPath);
+	if(!dir.Exists())
+	{
+		dir.CreateDirectory();
+		return;
+	}
+
+	UnprotectFile(this->dirPath);
+	for(const Path& path : { this->IndexFilePath(), this->IndexHashFilePath(), this->VolumesPath() })
+	{
+		File file(path);
+		if(file.Exists())
+			UnprotectFile(path);
+	}
+}
+
+void ChunkStore::WriteProtect()
+{
+	this->fileSystem->WriteProtect();
+
+	for(const Path& path : { this->IndexFilePath(), this->IndexHashFilePath(), this->dirPath })
+	{
+		File file(path);
+		if(file.Exists())
+			WriteProtectFile(path);
+	}
+}
+
+//Private methods
+void ChunkStore::ReadIndex()
+{
+	File indexFile(this->IndexFilePath());
+	if(indexFile.Exists())
+		this->index = ReadIndexFile(this->IndexFilePath(), this->IndexHashFilePath());
+	else
+		this->index = new BackupNodeIndex();
+
+	const Crypto::HashAlgorithm hashAlgorithm = InjectionContainer::Instance().Config().hashAlgorithm;
+	this->chunkNodeIndices = new DigestIndex();
+	this->chunkNodeIndices->Reserve(this->index->GetNumberOfNodes());
+	for(uint32 i = 0; i < this->index->GetNumberOfNodes(); i++)
+	{
+		const Digest* digest = this->index->GetNodeAttributes(i).FindHash(hashAlgorithm);
+		if(digest)
+			this->chunkNodeIndices->Insert(*digest, i);
+	}
+
+	this->fileSystem = new FlatVolumesFileSystem(this->VolumesPath(), *this->index);
+}
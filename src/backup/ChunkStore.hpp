@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+using namespace StdXX::FileSystem;
+//Local
+#include "BackupNodeIndex.hpp"
+#include "IndexFile.hpp"
+#include "../backupfilesystem/FlatVolumesFileSystem.hpp"
+
+/**
+ * Repository-wide store for the chunks of files that were backed up in chunking mode.
+ * Every chunk is stored exactly once and is identified by its hash value, i.e. chunks are shared across files and
+ * snapshots.
+ * Internally the chunks are nodes of a backup index, whose path is the hash value of the chunk in hex notation.
+ * Chunks are looked up by their raw hash value though.
+ */
+class ChunkStore
+{
+public:
+	//Constructor
+	ChunkStore(const Path& dirPath);
+
+	//Properties
+	inline uint32 NumberOfChunks() const
+	{
+		return this->index->GetNumberOfNodes();
+	}
+
+	//Methods
+	/**
+	 * Stores the chunk if no chunk with the same hash value exists yet.
+	 * @param compressionMethod - no compression if not set
+	 * @return the number of bytes that were written to the store, 0 if the chunk already existed
+	 */
+	uint64 AddChunk(const Digest& hash, const void* data, uint32 size, const Optional<CompressionMethod>& compressionMethod);
+	UniquePointer<InputStream> OpenChunk(const Digest& hash, bool verify) const;
+	/**
+	 * Closes the store for writing and reads it in again, so that chunks that were added become readable.
+	 */
+	void Reload();
+	void Serialize() const;
+	void Unprotect();
+	void WriteProtect();
+
+	//Inline
+	inline uint64 ComputeStoredSize() const
+	{
+		return this->index->ComputeSumOfBlockSizes();
+	}
+
+private:
+	/**
+	 * Removes the pending mark of a chunk when it goes out of scope, so that no writer of the same chunk waits forever
+	 * if storing the chunk fails.
+	 */
+	class PendingChunkMark
+	{
+	public:
+		//Constructor
+		inline PendingChunkMark(ChunkStore& chunkStore, const Digest& hash) : chunkStore(chunkStore), hash(hash)
+		{
+		}
+
+		//Destructor
+		inline ~PendingChunkMark()
+		{
+			AutoLock lock(this->chunkStore.chunksLock);
+			this->chunkStore.pendingChunks.Remove(this->hash);
+			this->chunkStore.chunkCommitted.Broadcast();
+		}
+
+	private:
+		//Members
+		ChunkStore& chunkStore;
+		Digest hash;
+	};
+
+	//Members
+	Path dirPath;
+	UniquePointer<BackupNodeIndex> index;
+	UniquePointer<DigestIndex> chunkNodeIndices;
+	UniquePointer<FlatVolumesFileSystem> fileSystem;
+	Mutex chunksLock;
+	/**
+	 * Chunks whose data is being written. They are added to the index only after their blocks are committed.
+	 */
+	BinaryTreeSet<Digest> pendingChunks;
+	ConditionVariable chunkCommitted;
+
+	//Properties
+	inline Path IndexFilePath() const
+	{
+		return this->dirPath / (String(u8"chunks.") + c_indexFileExtension);
+	}
+
+	inline Path IndexHashFilePath() const
+	{
+		return this->IndexFilePath().String() + String(c_hashFileSuffix);
+	}
+
+	inline Path VolumesPath() const
+	{
+		return this->dirPath / String(u8"volumes");
+	}
+
+	//Methods
+	void ReadIndex();
+
+	//Inline
+	inline Path ChunkPath(const Digest& hash) const
+	{
+		return u8"/" + hash.ToHexString();
+	}
+};
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "ContentDefinedChunker.hpp"
+
+//Constants
+/*
+ * The masks select the high bits of the gear hash, because these depend on the largest window of input bytes.
+ * Before the average chunk size is reached a stricter mask (more bits) is used and after it a more lenient one.
+ * This normalizes the chunk size distribution around the average size.
+ */
+static const uint64 c_maskStrict = 0xFFFFFC0000000000_u64; //22 bits
+static const uint64 c_maskLenient = 0xFFFFC00000000000_u64; //18 bits
+
+static const struct GearTable
+{
+	uint64 entries[256];
+
+	GearTable()
+	{
+		//the table must be the same for all runs, else chunk boundaries would not be stable (splitmix64)
+		uint64 state = 0x41434261636B7570_u64;
+		for(uint64& entry : this->entries)
+		{
+			state += 0x9E3779B97F4A7C15_u64;
+			uint64 z = state;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9_u64;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EB_u64;
+			entry = z ^ (z >> 31);
+		}
+	}
+} c_gearTable;
+
+//Constructor
+ContentDefinedChunker::ContentDefinedChunker(InputStream& inputStream) : inputStream(inputStream), buffer(c_maxChunkSize)
+{
+	this->bufferFill = 0;
+	this->lastChunkSize = 0;
+}
+
+//Public methods
+uint32 ContentDefinedChunker::ReadNextChunk(const uint8*& chunkData)
+{
+	//drop the chunk that was returned last time
+	if(this->lastChunkSize)
+	{
+		this->bufferFill -= this->lastChunkSize;
+		MemMove(&this->buffer[0], &this->buffer[this->lastChunkSize], this->bufferFill);
+		this->lastChunkSize = 0;
+	}
+
+	this->RefillBuffer();
+	if(this->bufferFill == 0)
+		return 0;
+
+	this->lastChunkSize = this->FindCutPoint(&this->buffer[0], this->bufferFill);
+	chunkData = &this->buffer[0];
+	return this->lastChunkSize;
+}
+
+//Private methods
+uint32 ContentDefinedChunker::FindCutPoint(const uint8* data, uint32 size) const
+{
+	if(size <= c_minChunkSize)
+		return size;
+
+	const uint64* gearTable = c_gearTable.entries;
+	const uint32 normalSize = Math::Min(size, c_averageChunkSize);
+
+	uint64 fingerprint = 0;
+	uint32 i = c_minChunkSize;
+	for(; i < normalSize; i++)
+	{
+		fingerprint = (fingerprint << 1) + gearTable[data[i]];
+		if(!(fingerprint & c_maskStrict))
+			return i + 1;
+	}
+	for(; i < size; i++)
+	{
+		fingerprint = (fingerprint << 1) + gearTable[data[i]];
+		if(!(fingerprint & c_maskLenient))
+			return i + 1;
+	}
+
+	return size;
+}
+
+void ContentDefinedChunker::RefillBuffer()
+{
+	while( (this->bufferFill < this->buffer.GetNumberOfElements()) and !this->inputStream.IsAtEnd() )
+	{
+		uint32 nBytesRead = this->inputStream.ReadBytes(&this->buffer[this->bufferFill], this->buffer.GetNumberOfElements() - this->bufferFill);
+		if(nBytesRead == 0)
+			break;
+		this->bufferFill += nBytesRead;
+	}
+}
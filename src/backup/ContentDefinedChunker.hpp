@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+
+/**
+ * Splits a stream into chunks whose boundaries are defined by the content (FastCDC with a gear rolling hash).
+ * Inserting or removing bytes therefore only changes the chunks around the modification, while all other chunks keep
+ * their boundaries and thus their hash values.
+ */
+class ContentDefinedChunker
+{
+public:
+	//Constants
+	static const uint32 c_minChunkSize = 256 * KiB;
+	static const uint32 c_averageChunkSize = 1 * MiB;
+	static const uint32 c_maxChunkSize = 4 * MiB;
+
+	//Constructor
+	ContentDefinedChunker(InputStream& inputStream);
+
+	//Methods
+	/**
+	 * Reads the next chunk from the input stream.
+	 * The chunk data stays valid until this method is called again.
+	 * @return the size of the chunk or 0 if the end of the input stream was reached
+	 */
+	uint32 ReadNextChunk(const uint8*& chunkData);
+
+private:
+	//Members
+	InputStream& inputStream;
+	FixedArray<uint8> buffer;
+	uint32 bufferFill;
+	uint32 lastChunkSize;
+
+	//Methods
+	uint32 FindCutPoint(const uint8* data, uint32 size) const;
+	void RefillBuffer();
+};
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "DigestIndex.hpp"
+
+//Constants
+static const uint32 c_minNumberOfSlots = 16;
+
+//Constructor
+DigestIndex::DigestIndex() : digestSize(0), nEntries(0), nSlots(0)
+{
+}
+
+//Public methods
+uint32 DigestIndex::Find(const Digest& digest) const
+{
+	if( (this->nEntries == 0) or (digest.size != this->digestSize) )
+		return Unsigned<uint32>::Max();
+	return (*this->nodeIndices)[this->FindSlot(digest.bytes)];
+}
+
+void DigestIndex::Insert(const Digest& digest, uint32 nodeIndex)
+{
+	if(this->digestSize == 0)
+	{
+		//the size is known only now, allocate the digests of reserved slots
+		this->digestSize = digest.size;
+		this->Rehash(Math::Max(this->nSlots, c_minNumberOfSlots));
+	}
+	ASSERT(digest.size == this->digestSize, u8"All digests of the index need to have the same size");
+
+	//keep the load factor at most 1/2 so that probe sequences stay short
+	if(2 * (this->nEntries + 1) > this->nSlots)
+		this->Rehash(Math::Max(2 * this->nSlots, c_minNumberOfSlots));
+
+	uint32 slot = this->FindSlot(digest.bytes);
+	if((*this->nodeIndices)[slot] == Unsigned<uint32>::Max())
+	{
+		MemCopy(this->digests->Data() + slot * this->digestSize, digest.bytes, this->digestSize);
+		this->nEntries++;
+	}
+	(*this->nodeIndices)[slot] = nodeIndex;
+}
+
+void DigestIndex::Reserve(uint32 nEntries)
+{
+	uint32 requiredSlots = c_minNumberOfSlots;
+	while(requiredSlots < 2 * nEntries)
+		requiredSlots *= 2;
+
+	if(requiredSlots > this->nSlots)
+		this->Rehash(requiredSlots);
+}
+
+//Private methods
+uint32 DigestIndex::FindSlot(const uint8* digest) const
+{
+	//digests are uniformly distributed, so their first bytes serve as hash
+	uint32 hash = 0;
+	for(uint8 i = 0; i < Math::Min(this->digestSize, (uint8)4); i++)
+		hash |= uint32(digest[i]) << (8 * i);
+
+	uint32 mask = this->nSlots - 1;
+	uint32 slot = hash & mask;
+	while( ((*this->nodeIndices)[slot] != Unsigned<uint32>::Max()) and (MemCmp(this->digests->Data() + slot * this->digestSize, digest, this->digestSize) != 0) )
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+void DigestIndex::Rehash(uint32 nSlots)
+{
+	UniquePointer<FixedArray<uint8>> oldDigests = Move(this->digests);
+	UniquePointer<FixedArray<uint32>> oldNodeIndices = Move(this->nodeIndices);
+	uint32 nOldSlots = this->nSlots;
+
+	this->nSlots = nSlots;
+	this->digests = new FixedArray<uint8>(uint64(nSlots) * this->digestSize);
+	this->nodeIndices = new FixedArray<uint32>(nSlots);
+	for(uint32 i = 0; i < nSlots; i++)
+		(*this->nodeIndices)[i] = Unsigned<uint32>::Max();
+
+	for(uint32 i = 0; i < nOldSlots; i++)
+	{
+		if((*oldNodeIndices)[i] == Unsigned<uint32>::Max())
+			continue;
+
+		const uint8* digest = oldDigests->Data() + i * this->digestSize;
+		uint32 slot = this->FindSlot(digest);
+		MemCopy(this->digests->Data() + slot * this->digestSize, digest, this->digestSize);
+		(*this->nodeIndices)[slot] = (*oldNodeIndices)[i];
+	}
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+//Local
+#include "../Digest.hpp"
+
+/**
+ * Maps digests of one hash algorithm to node indices.
+ * The table uses open addressing with linear probing and keeps the digests in one contiguous array, so lookups neither
+ * allocate nor walk a tree.
+ */
+class DigestIndex
+{
+public:
+	//Constructor
+	DigestIndex();
+
+	//Methods
+	/**
+	 * @return the node index or Unsigned<uint32>::Max() if the digest is unknown
+	 */
+	uint32 Find(const Digest& digest) const;
+	/**
+	 * Maps the digest to the node index, replacing the node that was mapped to it before.
+	 */
+	void Insert(const Digest& digest, uint32 nodeIndex);
+	void Reserve(uint32 nEntries);
+
+private:
+	//Members
+	uint8 digestSize;
+	uint32 nEntries;
+	uint32 nSlots;
+	UniquePointer<FixedArray<uint8>> digests; //digestSize bytes per slot
+	UniquePointer<FixedArray<uint32>> nodeIndices; //Unsigned<uint32>::Max() for empty slots
+
+	//Methods
+	uint32 FindSlot(const uint8* digest) const;
+	void Rehash(uint32 nSlots);
+};
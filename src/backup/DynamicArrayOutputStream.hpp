@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+
+/**
+ * Collects written data in memory, e.g. compressed data that must not reach its destination yet.
+ */
+class DynamicArrayOutputStream : public OutputStream
+{
+public:
+	//Constructor
+	inline DynamicArrayOutputStream(DynamicArray<uint8>& buffer) : buffer(buffer)
+	{
+	}
+
+	//Methods
+	void Flush() override
+	{
+	}
+
+	uint32 WriteBytes(const void *source, uint32 size) override
+	{
+		uint32 offset = this->buffer.GetNumberOfElements();
+		this->buffer.Resize(offset + size);
+		MemCopy(this->buffer.Data() + offset, source, size);
+		return size;
+	}
+
+private:
+	//Members
+	DynamicArray<uint8>& buffer;
+};
\ No newline at end of file
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "FrameCompressor.hpp"
+//Local
+#include "../config/ConfigManager.hpp"
+#include "DynamicArrayOutputStream.hpp"
+
+//Constructor
+FrameCompressor::FrameCompressor(OutputStream &outputStream, uint32 frameSize, const CompressionMethod& compressionMethod, TaskWindowPool& pool, uint32 nWorkers)
+	: outputStream(outputStream), frameSize(frameSize), compressionMethod(compressionMethod), frames(Math::Max(nWorkers, 1u)), taskWindow(pool, nWorkers)
+{
+}
+
+//Public methods
+void FrameCompressor::Finalize()
+{
+	if(!this->currentFrame.IsNull() and this->currentFrame->size)
+		this->StartCurrentFrame();
+
+	this->taskWindow.WaitForAll([this](uint32 slot)
+	{
+		this->WriteFrame(*this->frames[slot]);
+	});
+}
+
+void FrameCompressor::Flush()
+{
+	this->outputStream.Flush();
+}
+
+uint32 FrameCompressor::WriteBytes(const void *source, uint32 size)
+{
+	const uint8* src = static_cast<const uint8 *>(source);
+	uint32 leftBytes = size;
+	while(leftBytes)
+	{
+		if(this->currentFrame.IsNull())
+			this->currentFrame = new Frame(this->frameSize);
+
+		uint32 nBytesToCopy = Math::Min(leftBytes, this->frameSize - this->currentFrame->size);
+		MemCopy(this->currentFrame->data.Data() + this->currentFrame->size, src, nBytesToCopy);
+		this->currentFrame->size += nBytesToCopy;
+		src += nBytesToCopy;
+		leftBytes -= nBytesToCopy;
+
+		if(this->currentFrame->size == this->frameSize)
+			this->StartCurrentFrame();
+	}
+	return size;
+}
+
+//Private methods
+void FrameCompressor::RecycleFrame(uint32 slot)
+{
+	this->WriteFrame(*this->frames[slot]);
+
+	//keep one buffer for the next frame, free the others
+	if(this->spareFrame.IsNull())
+	{
+		this->spareFrame = Move(this->frames[slot]);
+		this->spareFrame->size = 0;
+		this->spareFrame->compressed.Release();
+	}
+	else
+		this->frames[slot] = nullptr;
+}
+
+void FrameCompressor::StartCurrentFrame()
+{
+	//write the frames that are done already, so that their buffers don't pile up behind a slow frame
+	uint32 slot;
+	while(this->taskWindow.TryAcquireFinishedSlot(slot))
+		this->RecycleFrame(slot);
+
+	bool wasUsed;
+	slot = this->taskWindow.AcquireSlot(wasUsed);
+	if(wasUsed)
+		this->RecycleFrame(slot);
+
+	this->frames[slot] = Move(this->currentFrame);
+	Frame& frame = *this->frames[slot];
+	this->taskWindow.Start(slot, [&frame, this]()
+	{
+		DynamicArrayOutputStream frameBuffer(frame.compressed);
+		UniquePointer<Compressor> compressor = ConfigManager::CreateCompressor(this->compressionMethod, frameBuffer);
+		compressor->WriteBytes(frame.data.Data(), frame.size);
+		compressor->Finalize();
+	});
+
+	this->currentFrame = Move(this->spareFrame);
+}
+
+void FrameCompressor::WriteFrame(Frame& frame)
+{
+	this->outputStream.WriteBytes(frame.compressed.Data(), frame.compressed.GetNumberOfElements());
+	this->compressedFrameSizes.Push(frame.compressed.GetNumberOfElements());
+}
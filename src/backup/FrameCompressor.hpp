@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+//Local
+#include "../TaskWindow.hpp"
+#include "../CompressionSetting.hpp"
+
+/**
+ * Compresses the data in frames of frameSize bytes, each of them as a compressed stream on its own.
+ * Up to nWorkers frames are compressed concurrently on the threads of the TaskWindowPool. The compressed frames are
+ * written to the output stream in order, so that the blocks of the node stay one ordered run.
+ */
+class FrameCompressor : public OutputStream
+{
+	struct Frame
+	{
+		FixedArray<uint8> data;
+		uint32 size;
+		DynamicArray<uint8> compressed;
+
+		inline Frame(uint32 frameSize) : data(frameSize), size(0)
+		{
+		}
+	};
+public:
+	//Constructor
+	FrameCompressor(OutputStream& outputStream, uint32 frameSize, const CompressionMethod& compressionMethod, TaskWindowPool& pool, uint32 nWorkers);
+
+	//Properties
+	inline const DynamicArray<uint64>& CompressedFrameSizes() const
+	{
+		return this->compressedFrameSizes;
+	}
+
+	//Methods
+	void Finalize();
+	void Flush() override;
+	uint32 WriteBytes(const void *source, uint32 size) override;
+
+private:
+	//Members
+	OutputStream& outputStream;
+	uint32 frameSize;
+	CompressionMethod compressionMethod;
+	FixedArray<UniquePointer<Frame>> frames;
+	TaskWindow taskWindow; //after frames, so that the running tasks are joined before their frames are destroyed
+	UniquePointer<Frame> currentFrame;
+	UniquePointer<Frame> spareFrame;
+	DynamicArray<uint64> compressedFrameSizes;
+
+	//Methods
+	void RecycleFrame(uint32 slot);
+	void StartCurrentFrame();
+	void WriteFrame(Frame& frame);
+};
@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Corresponding header
+#include "IndexFile.hpp"
+//Local
+#include "MappedIndexFile.hpp"
+#include "../config/ConfigManager.hpp"
+#include "../InjectionContainer.hpp"
+#include "../Serialization.hpp"
+#include "../StreamPipingFailedException.hpp"
+#include "../Util.hpp"
+
+struct StringReference
+{
+	uint32 offset;
+	uint32 length;
+};
+
+struct NodeStrings
+{
+	uint32 parentIndex;
+	uint32 nameOffset;
+	uint32 nameLength;
+	uint32 backReferenceTargetOffset = 0;
+	uint32 backReferenceTargetLength = 0;
+	uint32 dataSnapshotNameOffset = 0;
+	uint32 dataSnapshotNameLength = 0;
+};
+
+struct HashAlgorithmAndValue
+{
+	Crypto::HashAlgorithm hashAlgorithm;
+	String hashValue;
+};
+
+namespace StdXX::Serialization
+{
+	template <typename ArchiveType>
+	void Archive(ArchiveType& ar, HashAlgorithmAndValue& hashAlgorithmAndValue)
+	{
+		CustomArchive(ar, u8"algorithm", hashAlgorithmAndValue.hashAlgorithm);
+		ar & Binding(u8"hash", hashAlgorithmAndValue.hashValue);
+	}
+}
+
+//Local functions
+static uint8 EncodeHashAlgorithm(Crypto::HashAlgorithm hashAlgorithm)
+{
+	auto hashMapping = Serialization::HashMapping();
+	for(uint8 i = 0; i < hashMapping.GetNumberOfElements(); i++)
+	{
+		if(hashMapping[i].Get<0>() == hashAlgorithm)
+			return i;
+	}
+	NOT_IMPLEMENTED_ERROR; //implement me
+	return 0;
+}
+
+static HashAlgorithmAndValue ReadHashFile(const Path& indexHashFilePath)
+{
+	FileInputStream hashInputStream(indexHashFilePath);
+	BufferedInputStream hashBufferedInputStream(hashInputStream);
+	Serialization::JSONDeserializer jsonDeserializer(hashBufferedInputStream);
+	HashAlgorithmAndValue protection;
+	jsonDeserializer >> protection;
+
+	return protection;
+}
+
+static void WriteDigest(DataWriter& dataWriter, const Digest& digest)
+{
+	uint8 padded[c_indexMaxDigestSize];
+	static_assert(Digest::c_maxSize == c_indexMaxDigestSize);
+	MemCopy(padded, digest.bytes, digest.size);
+	MemZero(padded + digest.size, c_indexMaxDigestSize - digest.size);
+
+	dataWriter.WriteByte(digest.size);
+	dataWriter.WriteBytes(padded, c_indexMaxDigestSize);
+}
+
+static void WritePadding(DataWriter& dataWriter, uint64 size)
+{
+	for(uint64 i = size; i % 8; i++)
+		dataWriter.WriteByte(0);
+}
+
+static uint64 AlignSectionSize(uint64 size)
+{
+	return (size + 7) & ~7_u64;
+}
+
+//Global functions
+UniquePointer<BackupNodeIndex> ReadIndexFile(const Path& indexFilePath, const Path& indexHashFilePath, bool verifyHash)
+{
+	MappedIndexFile indexFile(indexFilePath);
+	if(verifyHash)
+	{
+		HashAlgorithmAndValue protection = ReadHashFile(indexHashFilePath);
+		if(protection.hashValue != indexFile.ComputeHash(protection.hashAlgorithm))
+			throw StreamPipingFailedException(indexFilePath);
+	}
+
+	return new BackupNodeIndex(indexFile);
+}
+
+UniquePointer<BackupNodeIndex> ReadLegacyIndexFile(const Path& indexFilePath, const Path& indexHashFilePath)
+{
+	HashAlgorithmAndValue protection = ReadHashFile(indexHashFilePath);
+
+	FileInputStream fileInputStream(indexFilePath);
+	BufferedInputStream bufferedInputStream(fileInputStream);
+	UniquePointer<Decompressor> decompressor = Decompressor::Create(CompressionStreamFormatType::lzma, bufferedInputStream, false);
+	UniquePointer<Crypto::HashFunction> hashFunction = Crypto::HashFunction::CreateInstance(protection.hashAlgorithm);
+	Crypto::HashingInputStream hashingInputStream(*decompressor, hashFunction.operator->());
+
+	Serialization::XMLDeserializer deserializer(hashingInputStream);
+	UniquePointer<BackupNodeIndex> index = new BackupNodeIndex(deserializer);
+
+	hashFunction->Finish();
+	String got = hashFunction->GetDigestString().ToLowercase();
+
+	if(protection.hashValue != got)
+		throw StreamPipingFailedException(indexFilePath);
+
+	return index;
+}
+
+void WriteIndexFile(const BackupNodeIndex& index, const Path& indexFilePath, const Path& indexHashFilePath)
+{
+	const Config &config = InjectionContainer::Instance().Config();
+	Crypto::HashAlgorithm hashAlgorithm = config.hashAlgorithm;
+
+	//collect strings and compute section sizes
+	const uint32 nNodes = index.GetNumberOfNodes();
+	DynamicArray<String> strings;
+	DynamicArray<NodeStrings> nodeStrings;
+	nodeStrings.EnsureCapacity(nNodes);
+	uint64 stringsSize = 0, nBlocks = 0, nHashes = 0, nChunks = 0, nFrames = 0;
+	bool hasDataLocations = false, hasIdentities = false, hasFingerprints = false, hasSolidGroups = false, hasFrameTables = false;
+	BinaryTreeMap<String, StringReference> dataSnapshotNames; //the same few snapshot names are referenced by many nodes
+
+	auto addString = [&strings, &stringsSize](const String& string, uint32& offset, uint32& length)
+	{
+		String utf8 = string.ToUTF8();
+		offset = stringsSize;
+		length = utf8.GetSize();
+		stringsSize += length;
+		strings.Push(Move(utf8));
+	};
+
+	for(uint32 i = 0; i < nNodes; i++)
+	{
+		const BackupNodeAttributes& attributes = index.GetNodeAttributes(i);
+
+		NodeStrings node;
+		node.parentIndex = index.GetParentNodeIndex(i);
+		if(node.parentIndex != Unsigned<uint32>::Max())
+			addString(index.GetNodeName(i), node.nameOffset, node.nameLength);
+		else
+			addString(index.GetNodePath(i).String(), node.nameOffset, node.nameLength); //no parent in index, store the whole path
+
+		if(attributes.BackReferenceTarget().HasValue())
+			addString(attributes.BackReferenceTarget()->String(), node.backReferenceTargetOffset, node.backReferenceTargetLength);
+		if(attributes.DataLocation().HasValue())
+		{
+			const String& snapshotName = attributes.DataLocation()->snapshotName;
+			if(!dataSnapshotNames.Contains(snapshotName))
+			{
+				StringReference reference;
+				addString(snapshotName, reference.offset, reference.length);
+				dataSnapshotNames.Insert(snapshotName, reference);
+			}
+			node.dataSnapshotNameOffset = dataSnapshotNames[snapshotName].offset;
+			node.dataSnapshotNameLength = dataSnapshotNames[snapshotName].length;
+			hasDataLocations = true;
+		}
+
+		if(attributes.Identity().HasValue())
+			hasIdentities = true;
+		if(attributes.Fingerprint().HasValue())
+			hasFingerprints = true;
+		if(attributes.SolidGroup().HasValue())
+			hasSolidGroups = true;
+		if(attributes.Frames().HasValue())
+		{
+			hasFrameTables = true;
+			nFrames += attributes.Frames()->compressedSizes.GetNumberOfElements();
+		}
+
+		nodeStrings.Push(node);
+
+		nBlocks += attributes.Blocks().GetNumberOfElements();
+		nHashes += attributes.HashValues().GetNumberOfElements();
+		nChunks += attributes.Chunks().GetNumberOfElements();
+	}
+
+	const uint32 nSections = 11;
+	const uint32 sectionIds[nSections] = { c_indexSectionId_strings, c_indexSectionId_nodes, c_indexSectionId_blocks, c_indexSectionId_hashes, c_indexSectionId_chunks, c_indexSectionId_dataLocations, c_indexSectionId_identities, c_indexSectionId_fingerprints, c_indexSectionId_solidGroups, c_indexSectionId_frameTables, c_indexSectionId_frames };
+	const uint64 sectionSizes[nSections] = { stringsSize, uint64(nNodes) * c_indexNodeRecordSize, nBlocks * c_indexBlockRecordSize, nHashes * c_indexHashRecordSize, nChunks * c_indexChunkRecordSize, hasDataLocations ? (uint64(nNodes) * c_indexDataLocationRecordSize) : 0, hasIdentities ? (uint64(nNodes) * c_indexIdentityRecordSize) : 0, hasFingerprints ? (uint64(nNodes) * c_indexFingerprintRecordSize) : 0, hasSolidGroups ? (uint64(nNodes) * c_indexSolidGroupRecordSize) : 0, hasFrameTables ? (uint64(nNodes) * c_indexFrameTableRecordSize) : 0, nFrames * c_indexFrameRecordSize };
+	//readers that don't know solid groups or frames would read the compressed streams of these nodes the wrong way
+	const uint32 sectionFlags[nSections] = { 0, 0, 0, 0, 0, 0, 0, 0, hasSolidGroups ? c_indexSectionFlag_required : 0, hasFrameTables ? c_indexSectionFlag_required : 0, nFrames ? c_indexSectionFlag_required : 0 };
+
+	//write
+	FileOutputStream indexFile(indexFilePath, true);
+	BufferedOutputStream bufferedOutputStream(indexFile);
+	Crypto::HashingOutputStream hashingOutputStream(bufferedOutputStream, hashAlgorithm);
+	DataWriter dataWriter(false, hashingOutputStream);
+
+	dataWriter.WriteBytes(c_indexMagic, sizeof(c_indexMagic));
+	dataWriter.WriteUInt16(c_indexVersion);
+	dataWriter.WriteUInt16(nSections);
+
+	uint64 sectionOffset = c_indexHeaderSize + nSections * c_indexSectionTableEntrySize;
+	for(uint32 i = 0; i < nSections; i++)
+	{
+		dataWriter.WriteUInt32(sectionIds[i]);
+		dataWriter.WriteUInt32(sectionFlags[i]);
+		dataWriter.WriteUInt64(sectionOffset);
+		dataWriter.WriteUInt64(sectionSizes[i]);
+
+		sectionOffset += AlignSectionSize(sectionSizes[i]);
+	}
+
+	//strings
+	for(const String& string : strings)
+		dataWriter.WriteBytes(string.GetRawData(), string.GetSize());
+	WritePadding(dataWriter, stringsSize);
+
+	//nodes
+	uint32 blockIndex = 0, hashIndex = 0, chunkIndex = 0;
+	for(uint32 i = 0; i < nNodes; i++)
+	{
+		const BackupNodeAttributes& attributes = index.GetNodeAttributes(i);
+		const NodeStrings& node = nodeStrings[i];
+
+		uint8 flags = 0;
+		if(attributes.OwnsBlocks())
+			flags |= c_indexNodeFlag_ownsBlocks;
+		if(attributes.LastModifiedTime().HasValue())
+			flags |= c_indexNodeFlag_lastModified;
+		if(attributes.CompressionSetting().HasValue())
+			flags |= c_indexNodeFlag_compressionSetting;
+		if(attributes.BackReferenceTarget().HasValue())
+			flags |= c_indexNodeFlag_backReferenceTarget;
+		if(attributes.Fingerprint().HasValue())
+			flags |= c_indexNodeFlag_fingerprint;
+
+		const POSIXPermissions* posixPermissions = dynamic_cast<const POSIXPermissions *>(&attributes.Permissions());
+		if(!posixPermissions)
+			NOT_IMPLEMENTED_ERROR; //implement me
+
+		dataWriter.WriteUInt32(node.parentIndex);
+		dataWriter.WriteUInt32(node.nameOffset);
+		dataWriter.WriteUInt32(node.nameLength);
+		dataWriter.WriteByte(static_cast<uint8>(attributes.Type()));
+		dataWriter.WriteByte(flags);
+		dataWriter.WriteByte(attributes.CompressionSetting().HasValue() ? static_cast<uint8>(*attributes.CompressionSetting()) : 0);
+		dataWriter.WriteByte(0);
+		dataWriter.WriteUInt32(posixPermissions->userId);
+		dataWriter.WriteUInt32(posixPermissions->groupId);
+		dataWriter.WriteUInt32(posixPermissions->EncodeMode());
+		dataWriter.WriteUInt64(attributes.LastModifiedTime().HasValue() ? (uint64)DateTimeToMilliseconds(*attributes.LastModifiedTime()) : 0);
+		dataWriter.WriteUInt32(node.backReferenceTargetOffset);
+		dataWriter.WriteUInt32(node.backReferenceTargetLength);
+		dataWriter.WriteUInt32(blockIndex);
+		dataWriter.WriteUInt32(attributes.Blocks().GetNumberOfElements());
+		dataWriter.WriteUInt32(hashIndex);
+		dataWriter.WriteUInt32(attributes.HashValues().GetNumberOfElements());
+		dataWriter.WriteUInt32(chunkIndex);
+		dataWriter.WriteUInt32(attributes.Chunks().GetNumberOfElements());
+		dataWriter.WriteUInt32(0);
+		dataWriter.WriteUInt64(attributes.Size());
+
+		blockIndex += attributes.Blocks().GetNumberOfElements();
+		hashIndex += attributes.HashValues().GetNumberOfElements();
+		chunkIndex += attributes.Chunks().GetNumberOfElements();
+	}
+
+	//blocks
+	for(uint32 i = 0; i < nNodes; i++)
+	{
+		for(const Block& block : index.GetNodeAttributes(i).Blocks())
+		{
+			dataWriter.WriteUInt64(block.volumeNumber);
+			dataWriter.WriteUInt64(block.offset);
+			dataWriter.WriteUInt64(block.size);
+		}
+	}
+
+	//hashes
+	for(uint32 i = 0; i < nNodes; i++)
+	{
+		for(const HashValue& hashValue : index.GetNodeAttributes(i).HashValues())
+		{
+			dataWriter.WriteByte(EncodeHashAlgorithm(hashValue.algorithm));
+			WriteDigest(dataWriter, hashValue.digest);
+		}
+	}
+	WritePadding(dataWriter, sectionSizes[3]);
+
+	//chunks
+	for(uint32 i = 0; i < nNodes; i++)
+	{
+		for(const ChunkReference& chunkReference : index.GetNodeAttributes(i).Chunks())
+		{
+			WriteDigest(dataWriter, chunkReference.hash);
+			dataWriter.WriteUInt64(chunkReference.size);
+		}
+	}
+	WritePadding(dataWriter, sectionSizes[4]);
+
+	//data locations
+	if(hasDataLocations)
+	{
+		for(uint32 i = 0; i < nNodes; i++)
+		{
+			const Optional<DataLocation>& dataLocation = index.GetNodeAttributes(i).DataLocation();
+			dataWriter.WriteUInt32(nodeStrings[i].dataSnapshotNameOffset);
+			dataWriter.WriteUInt32(nodeStrings[i].dataSnapshotNameLength);
+			dataWriter.WriteUInt32(dataLocation.HasValue() ? dataLocation->nodeIndex : Unsigned<uint32>::Max());
+		}
+		WritePadding(dataWriter, sectionSizes[5]);
+	}
+
+	//identities
+	if(hasIdentities)
+	{
+		for(uint32 i = 0; i < nNodes; i++)
+		{
+			const Optional<NodeIdentity>& identity = index.GetNodeAttributes(i).Identity();
+			dataWriter.WriteUInt64(identity.HasValue() ? identity->deviceId : 0);
+			dataWriter.WriteUInt64(identity.HasValue() ? identity->inode : 0);
+		}
+	}
+
+	//fingerprints
+	if(hasFingerprints)
+	{
+		static const uint8 noFingerprint[c_indexFingerprintRecordSize] = {};
+		for(uint32 i = 0; i < nNodes; i++)
+		{
+			const Optional<NodeFingerprint>& fingerprint = index.GetNodeAttributes(i).Fingerprint();
+			dataWriter.WriteBytes(fingerprint.HasValue() ? fingerprint->digest : noFingerprint, c_indexFingerprintRecordSize);
+		}
+	}
+
+	//solid groups
+	if(hasSolidGroups)
+	{
+		for(uint32 i = 0; i < nNodes; i++)
+		{
+			const Optional<SolidGroupMembership>& solidGroup = index.GetNodeAttributes(i).SolidGroup();
+			dataWriter.WriteUInt32(solidGroup.HasValue() ? solidGroup->leaderNodeIndex : Unsigned<uint32>::Max());
+			dataWriter.WriteUInt64(solidGroup.HasValue() ? solidGroup->offset : 0);
+		}
+		WritePadding(dataWriter, sectionSizes[8]);
+	}
+
+	//frame tables
+	if(hasFrameTables)
+	{
+		uint32 frameIndex = 0;
+		for(uint32 i = 0; i < nNodes; i++)
+		{
+			const Optional<FrameTable>& frames = index.GetNodeAttributes(i).Frames();
+			uint32 nNodeFrames = frames.HasValue() ? frames->compressedSizes.GetNumberOfElements() : 0;
+			dataWriter.WriteUInt64(frames.HasValue() ? frames->frameSize : 0);
+			dataWriter.WriteUInt32(frameIndex);
+			dataWriter.WriteUInt32(nNodeFrames);
+			frameIndex += nNodeFrames;
+		}
+	}
+
+	//frames
+	for(uint32 i = 0; i < nNodes; i++)
+	{
+		const Optional<FrameTable>& frames = index.GetNodeAttributes(i).Frames();
+		if(frames.HasValue())
+		{
+			for(uint64 compressedSize : frames->compressedSizes)
+				dataWriter.WriteUInt64(compressedSize);
+		}
+	}
+
+	hashingOutputStream.Flush();
+
+	UniquePointer<Crypto::HashFunction> hasher = hashingOutputStream.Reset();
+	hasher->Finish();
+
+	HashAlgorithmAndValue protection;
+	protection.hashAlgorithm = hashAlgorithm;
+	protection.hashValue = hasher->GetDigestString().ToLowercase();
+
+	FileOutputStream indexHashFile(indexHashFilePath, true);
+	BufferedOutputStream bufferedOutputStream2(indexHashFile);
+	Serialization::JSONSerializer protectionSerializer(bufferedOutputStream2);
+	protectionSerializer << protection;
+	bufferedOutputStream2.Flush();
+}
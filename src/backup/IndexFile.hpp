@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+using namespace StdXX::FileSystem;
+//Local
+#include "BackupNodeIndex.hpp"
+
+//Constants
+static const char8_t *const c_hashFileSuffix = u8"_hash.json";
+static const char8_t *const c_indexFileExtension = u8"acbi";
+static const char8_t *const c_legacyIndexFileExtension = u8"lzma"; //.xml.lzma
+
+//Prototypes
+/**
+ * Reads a binary index file and checks it against the hash value that was stored in the hash file when the index was
+ * written.
+ * @param verifyHash if false, the file is not hashed. For files that were checked before and are write-protected.
+ */
+UniquePointer<BackupNodeIndex> ReadIndexFile(const Path& indexFilePath, const Path& indexHashFilePath, bool verifyHash = true);
+/**
+ * Reads an LZMA-compressed XML index file, as written by older versions.
+ * The hash value in the hash file refers to the uncompressed XML.
+ */
+UniquePointer<BackupNodeIndex> ReadLegacyIndexFile(const Path& indexFilePath, const Path& indexHashFilePath);
+void WriteIndexFile(const BackupNodeIndex& index, const Path& indexFilePath, const Path& indexHashFilePath);
@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "MappedIndexFile.hpp"
+//Global
+#ifdef XPC_OS_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+//Local
+#include "../Serialization.hpp"
+#include "../Util.hpp"
+
+//Local functions
+static bool IsValidCompressionSetting(uint8 compressionSetting)
+{
+	switch(static_cast<CompressionSetting>(compressionSetting))
+	{
+		case CompressionSetting::lzma:
+		case CompressionSetting::zlib:
+			return true;
+	}
+	return false;
+}
+
+static bool IsValidFileType(uint8 type)
+{
+	switch(static_cast<FileType>(type))
+	{
+		case FileType::Directory:
+		case FileType::File:
+		case FileType::Link:
+			return true;
+	}
+	return false;
+}
+
+//Constructor
+MappedIndexFile::MappedIndexFile(const Path& path) : path(path)
+{
+	File file(path);
+	this->size = file.Info().size;
+
+#ifdef XPC_OS_LINUX
+	int fd = open(reinterpret_cast<const char*>(path.String().ToUTF8().GetRawZeroTerminatedData()), O_RDONLY);
+	if(fd != -1)
+	{
+		void* mapped = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+
+		if(mapped != MAP_FAILED)
+		{
+			madvise(mapped, this->size, MADV_WILLNEED);
+			this->data = static_cast<const uint8 *>(mapped);
+			this->ReadHeader();
+			return;
+		}
+	}
+#endif
+
+	//no memory mapping available, read the file into memory instead
+	this->buffer = new FixedArray<uint8>(this->size);
+	FileInputStream fileInputStream(path);
+	uint64 nBytesRead = 0;
+	while(nBytesRead < this->size)
+		nBytesRead += fileInputStream.ReadBytes(this->buffer->Data() + nBytesRead, Math::Min(this->size - nBytesRead, (uint64)Unsigned<uint32>::Max()));
+	this->data = this->buffer->Data();
+
+	this->ReadHeader();
+}
+
+//Destructor
+MappedIndexFile::~MappedIndexFile()
+{
+#ifdef XPC_OS_LINUX
+	if(this->buffer.IsNull())
+		munmap(const_cast<uint8 *>(this->data), this->size);
+#endif
+}
+
+//Public methods
+String MappedIndexFile::ComputeHash(Crypto::HashAlgorithm hashAlgorithm) const
+{
+	UniquePointer<Crypto::HashFunction> hasher = Crypto::HashFunction::CreateInstance(hashAlgorithm);
+
+	uint64 offset = 0;
+	while(offset < this->size)
+	{
+		uint32 nBytes = Math::Min(this->size - offset, (uint64)(16 * MiB));
+		hasher->Update(this->data + offset, nBytes);
+		offset += nBytes;
+	}
+	hasher->Finish();
+
+	return hasher->GetDigestString().ToLowercase();
+}
+
+const uint8* MappedIndexFile::GetNodeNameBytes(uint32 nodeIndex, uint32& nameSize) const
+{
+	const uint8* record = this->GetRecord(this->nodes, c_indexNodeRecordSize, nodeIndex);
+	nameSize = ReadUInt32LE(record + 8);
+	return this->GetString(ReadUInt32LE(record + 4), nameSize);
+}
+
+UniquePointer<BackupNodeAttributes> MappedIndexFile::ReadNodeAttributes(uint32 nodeIndex) const
+{
+	/*
+	 * Node record layout:
+	 *  0: uint32 parent index (Unsigned<uint32>::Max() if the parent is not part of the index)
+	 *  4: uint32 name offset
+	 *  8: uint32 name length
+	 *  12: uint8 type
+	 *  13: uint8 flags
+	 *  14: uint8 compression setting
+	 *  15: uint8 reserved
+	 *  16: int32 user id
+	 *  20: int32 group id
+	 *  24: uint32 mode
+	 *  28: int64 last modified time, milliseconds since the epoch
+	 *  36: uint32 back reference target offset
+	 *  40: uint32 back reference target length
+	 *  44: uint32 first block
+	 *  48: uint32 number of blocks
+	 *  52: uint32 first hash value
+	 *  56: uint32 number of hash values
+	 *  60: uint32 first chunk
+	 *  64: uint32 number of chunks
+	 *  68: uint32 reserved
+	 *  72: uint64 size
+	 */
+	const uint8* record = this->GetRecord(this->nodes, c_indexNodeRecordSize, nodeIndex);
+
+	//reloaded indexes are not hashed again, so nothing of the record can be trusted
+	uint8 flags = record[13];
+	if(!IsValidFileType(record[12]) or ((flags & c_indexNodeFlag_compressionSetting) and !IsValidCompressionSetting(record[14])))
+		throw ErrorHandling::VerificationFailedException();
+	FileType type = static_cast<FileType>(record[12]);
+
+	Optional<DateTime> lastModifiedTime;
+	if(flags & c_indexNodeFlag_lastModified)
+		lastModifiedTime = MillisecondsToDateTime((int64)ReadUInt64LE(record + 28));
+
+	UniquePointer<Permissions> permissions = new POSIXPermissions((int32)ReadUInt32LE(record + 16), (int32)ReadUInt32LE(record + 20), ReadUInt32LE(record + 24));
+
+	DynamicArray<Block> blocks;
+	uint32 firstBlock = ReadUInt32LE(record + 44);
+	uint32 nBlocks = ReadUInt32LE(record + 48);
+	blocks.EnsureCapacity(nBlocks);
+	for(uint32 i = 0; i < nBlocks; i++)
+	{
+		const uint8* blockRecord = this->GetRecord(this->blocks, c_indexBlockRecordSize, firstBlock + i);
+		blocks.Push({ .volumeNumber = ReadUInt64LE(blockRecord), .offset = ReadUInt64LE(blockRecord + 8), .size = ReadUInt64LE(blockRecord + 16) });
+	}
+
+	auto hashMapping = Serialization::HashMapping();
+	DynamicArray<HashValue> hashValues;
+	uint32 firstHash = ReadUInt32LE(record + 52);
+	uint32 nHashes = ReadUInt32LE(record + 56);
+	hashValues.EnsureCapacity(nHashes);
+	for(uint32 i = 0; i < nHashes; i++)
+	{
+		const uint8* hashRecord = this->GetRecord(this->hashes, c_indexHashRecordSize, firstHash + i);
+		if( (hashRecord[0] >= hashMapping.GetNumberOfElements()) or (hashRecord[1] > Digest::c_maxSize) )
+			throw ErrorHandling::VerificationFailedException();
+
+		HashValue hashValue;
+		hashValue.algorithm = hashMapping[hashRecord[0]].Get<0>();
+		hashValue.digest.size = hashRecord[1];
+		MemCopy(hashValue.digest.bytes, hashRecord + 2, hashValue.digest.size);
+		hashValues.Push(hashValue);
+	}
+
+	UniquePointer<BackupNodeAttributes> attributes = new BackupNodeAttributes(type, ReadUInt64LE(record + 72), lastModifiedTime, Move(permissions), Move(blocks), Move(hashValues));
+
+	uint32 firstChunk = ReadUInt32LE(record + 60);
+	uint32 nChunks = ReadUInt32LE(record + 64);
+	if(nChunks)
+	{
+		DynamicArray<ChunkReference> chunkReferences;
+		chunkReferences.EnsureCapacity(nChunks);
+		for(uint32 i = 0; i < nChunks; i++)
+		{
+			const uint8* chunkRecord = this->GetRecord(this->chunks, c_indexChunkRecordSize, firstChunk + i);
+			if(chunkRecord[0] > c_indexMaxDigestSize)
+				throw ErrorHandling::VerificationFailedException();
+
+			ChunkReference chunkReference;
+			chunkReference.hash.size = chunkRecord[0];
+			MemCopy(chunkReference.hash.bytes, chunkRecord + 1, chunkReference.hash.size);
+			chunkReference.size = ReadUInt64LE(chunkRecord + 1 + c_indexMaxDigestSize);
+			chunkReferences.Push(chunkReference);
+		}
+		attributes->Chunks(Move(chunkReferences));
+	}
+
+	attributes->OwnsBlocks((flags & c_indexNodeFlag_ownsBlocks) != 0);
+	if(flags & c_indexNodeFlag_compressionSetting)
+		attributes->CompressionSetting(static_cast<CompressionSetting>(record[14]));
+	if(flags & c_indexNodeFlag_backReferenceTarget)
+		attributes->BackReferenceTarget(Path(this->ReadString(ReadUInt32LE(record + 36), ReadUInt32LE(record + 40))));
+
+	if(this->dataLocations.size)
+	{
+		const uint8* dataLocationRecord = this->GetRecord(this->dataLocations, c_indexDataLocationRecordSize, nodeIndex);
+		uint32 dataNodeIndex = ReadUInt32LE(dataLocationRecord + 8);
+		if(dataNodeIndex != Unsigned<uint32>::Max())
+			attributes->DataLocation(DataLocation{ .snapshotName = this->ReadString(ReadUInt32LE(dataLocationRecord), ReadUInt32LE(dataLocationRecord + 4)), .nodeIndex = dataNodeIndex });
+	}
+
+	if(flags & c_indexNodeFlag_fingerprint)
+	{
+		NodeFingerprint fingerprint;
+		MemCopy(fingerprint.digest, this->GetRecord(this->fingerprints, c_indexFingerprintRecordSize, nodeIndex), sizeof(fingerprint.digest));
+		attributes->Fingerprint(fingerprint);
+	}
+
+	if(this->identities.size)
+	{
+		const uint8* identityRecord = this->GetRecord(this->identities, c_indexIdentityRecordSize, nodeIndex);
+		NodeIdentity identity{ .deviceId = ReadUInt64LE(identityRecord), .inode = ReadUInt64LE(identityRecord + 8) };
+		if( (identity.deviceId != 0) or (identity.inode != 0) )
+			attributes->Identity(identity);
+	}
+
+	if(this->solidGroups.size)
+	{
+		const uint8* solidGroupRecord = this->GetRecord(this->solidGroups, c_indexSolidGroupRecordSize, nodeIndex);
+		uint32 leaderNodeIndex = ReadUInt32LE(solidGroupRecord);
+		if(leaderNodeIndex != Unsigned<uint32>::Max())
+			attributes->SolidGroup(SolidGroupMembership{ .leaderNodeIndex = leaderNodeIndex, .offset = ReadUInt64LE(solidGroupRecord + 4) });
+	}
+
+	if(this->frameTables.size)
+	{
+		const uint8* frameTableRecord = this->GetRecord(this->frameTables, c_indexFrameTableRecordSize, nodeIndex);
+		uint32 firstFrame = ReadUInt32LE(frameTableRecord + 8);
+		uint32 nFrames = ReadUInt32LE(frameTableRecord + 12);
+		if(nFrames)
+		{
+			FrameTable frameTable;
+			frameTable.frameSize = ReadUInt64LE(frameTableRecord);
+			frameTable.compressedSizes.EnsureCapacity(nFrames);
+			for(uint32 i = 0; i < nFrames; i++)
+				frameTable.compressedSizes.Push(ReadUInt64LE(this->GetRecord(this->frames, c_indexFrameRecordSize, firstFrame + i)));
+			attributes->Frames(Move(frameTable));
+		}
+	}
+
+	return attributes;
+}
+
+String MappedIndexFile::ReadNodeName(uint32 nodeIndex) const
+{
+	uint32 nameSize;
+	const uint8* name = this->GetNodeNameBytes(nodeIndex, nameSize);
+	return String::CopyUtf8Bytes(name, nameSize);
+}
+
+uint32 MappedIndexFile::ReadParentIndex(uint32 nodeIndex) const
+{
+	const uint8* record = this->GetRecord(this->nodes, c_indexNodeRecordSize, nodeIndex);
+	return ReadUInt32LE(record);
+}
+
+//Class functions
+bool MappedIndexFile::IsIndexFile(const Path& path)
+{
+	FileInputStream fileInputStream(path);
+
+	uint8 magic[sizeof(c_indexMagic)];
+	if(fileInputStream.ReadBytes(magic, sizeof(magic)) != sizeof(magic))
+		return false;
+	return MemCmp(magic, c_indexMagic, sizeof(magic)) == 0;
+}
+
+//Private methods
+const uint8* MappedIndexFile::GetRecord(const Section& section, uint32 recordSize, uint32 index) const
+{
+	uint64 offset = uint64(index) * recordSize;
+	if(offset + recordSize > section.size)
+		throw ErrorHandling::VerificationFailedException();
+	return this->data + section.offset + offset;
+}
+
+const uint8* MappedIndexFile::GetString(uint32 offset, uint32 length) const
+{
+	if(uint64(offset) + length > this->strings.size)
+		throw ErrorHandling::VerificationFailedException();
+	return this->data + this->strings.offset + offset;
+}
+
+void MappedIndexFile::ReadHeader()
+{
+	if( (this->size < c_indexHeaderSize) or (MemCmp(this->data, c_indexMagic, sizeof(c_indexMagic)) != 0) )
+		throw ErrorHandling::VerificationFailedException();
+
+	if(ReadUInt16LE(this->data + 4) != c_indexVersion)
+		throw ErrorHandling::VerificationFailedException();
+
+	uint16 nSections = ReadUInt16LE(this->data + 6);
+	if(c_indexHeaderSize + uint64(nSections) * c_indexSectionTableEntrySize > this->size)
+		throw ErrorHandling::VerificationFailedException();
+
+	for(uint16 i = 0; i < nSections; i++)
+	{
+		const uint8* entry = this->data + c_indexHeaderSize + i * c_indexSectionTableEntrySize;
+
+		Section section;
+		section.offset = ReadUInt64LE(entry + 8);
+		section.size = ReadUInt64LE(entry + 16);
+		if(section.offset + section.size > this->size)
+			throw ErrorHandling::VerificationFailedException();
+
+		switch(ReadUInt32LE(entry))
+		{
+			case c_indexSectionId_strings:
+				this->strings = section;
+				break;
+			case c_indexSectionId_nodes:
+				this->nodes = section;
+				break;
+			case c_indexSectionId_blocks:
+				this->blocks = section;
+				break;
+			case c_indexSectionId_hashes:
+				this->hashes = section;
+				break;
+			case c_indexSectionId_chunks:
+				this->chunks = section;
+				break;
+			case c_indexSectionId_dataLocations:
+				this->dataLocations = section;
+				break;
+			case c_indexSectionId_identities:
+				this->identities = section;
+				break;
+			case c_indexSectionId_fingerprints:
+				this->fingerprints = section;
+				break;
+			case c_indexSectionId_solidGroups:
+				this->solidGroups = section;
+				break;
+			case c_indexSectionId_frameTables:
+				this->frameTables = section;
+				break;
+			case c_indexSectionId_frames:
+				this->frames = section;
+				break;
+			default:
+				if(ReadUInt32LE(entry + 4) & c_indexSectionFlag_required)
+					throw ErrorHandling::VerificationFailedException();
+		}
+	}
+}
+
+String MappedIndexFile::ReadString(uint32 offset, uint32 length) const
+{
+	return String::CopyUtf8Bytes(this->GetString(offset, length), length);
+}
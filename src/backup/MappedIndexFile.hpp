@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+using namespace StdXX::FileSystem;
+//Local
+#include "BackupNodeAttributes.hpp"
+
+/*
+ * Binary index format. All integers are little endian.
+ *
+ * Header:
+ *  char[4] magic: "ACBI"
+ *  uint16 version
+ *  uint16 number of sections
+ *  section table: per section { uint32 id, uint32 flags, uint64 offset, uint64 size }
+ *
+ * Sections start at 8-byte aligned offsets. Readers ignore sections that they do not know and treat missing sections
+ * as empty, so that later versions can add sections without breaking older files.
+ * Sections that change how the data of nodes has to be read are flagged with c_indexSectionFlag_required. Readers reject
+ * files with required sections that they do not know, instead of restoring wrong data.
+ *  strings: UTF-8 bytes without terminators, referenced by offset and length
+ *  nodes: c_indexNodeRecordSize bytes per node, see MappedIndexFile::ReadNodeAttributes for the layout
+ *  blocks: per block { uint64 volume number, uint64 offset, uint64 size }
+ *  hashes: per hash value { uint8 algorithm, uint8 digest size, uint8[64] digest }
+ *  chunks: per chunk reference { uint8 digest size, uint8[64] digest, uint64 size }
+ *  data locations: optional, per node { uint32 snapshot name offset, uint32 snapshot name length, uint32 node index }
+ *   node index is Unsigned<uint32>::Max() if the node has no data location
+ *  identities: optional, per node { uint64 device id, uint64 inode }
+ *   both are 0 if the identity of the node is unknown
+ *  fingerprints: optional, per node { uint8[16] fingerprint }, only valid if the node has c_indexNodeFlag_fingerprint set
+ *  solid groups: optional, per node { uint32 leader node index, uint64 offset in the decompressed group stream }
+ *   leader node index is Unsigned<uint32>::Max() if the node is not part of a solid group
+ *  frame tables: optional, per node { uint64 frame size, uint32 first frame, uint32 number of frames }
+ *   number of frames is 0 if the node was not compressed in frames
+ *  frames: per frame { uint64 compressed size }
+ */
+static const uint8 c_indexMagic[4] = { 'A', 'C', 'B', 'I' };
+static const uint16 c_indexVersion = 1;
+
+static const uint32 c_indexSectionId_strings = 0x53525453; //STRS
+static const uint32 c_indexSectionId_nodes = 0x45444F4E; //NODE
+static const uint32 c_indexSectionId_blocks = 0x534B4C42; //BLKS
+static const uint32 c_indexSectionId_hashes = 0x48534148; //HASH
+static const uint32 c_indexSectionId_chunks = 0x4B4E4843; //CHNK
+static const uint32 c_indexSectionId_dataLocations = 0x434F4C44; //DLOC
+static const uint32 c_indexSectionId_identities = 0x5444494E; //NIDT
+static const uint32 c_indexSectionId_fingerprints = 0x54525046; //FPRT
+static const uint32 c_indexSectionId_solidGroups = 0x50524753; //SGRP
+static const uint32 c_indexSectionId_frameTables = 0x4C425446; //FTBL
+static const uint32 c_indexSectionId_frames = 0x534D5246; //FRMS
+
+static const uint32 c_indexSectionFlag_required = 1;
+
+static const uint32 c_indexHeaderSize = 8;
+static const uint32 c_indexSectionTableEntrySize = 24;
+static const uint32 c_indexNodeRecordSize = 80;
+static const uint32 c_indexBlockRecordSize = 24;
+static const uint32 c_indexMaxDigestSize = 64;
+static const uint32 c_indexHashRecordSize = 2 + c_indexMaxDigestSize;
+static const uint32 c_indexChunkRecordSize = 1 + c_indexMaxDigestSize + 8;
+static const uint32 c_indexDataLocationRecordSize = 12;
+static const uint32 c_indexIdentityRecordSize = 16;
+static const uint32 c_indexFingerprintRecordSize = sizeof(NodeFingerprint::digest);
+static const uint32 c_indexSolidGroupRecordSize = 12;
+static const uint32 c_indexFrameTableRecordSize = 16;
+static const uint32 c_indexFrameRecordSize = 8;
+
+static const uint8 c_indexNodeFlag_ownsBlocks = 1;
+static const uint8 c_indexNodeFlag_lastModified = 2;
+static const uint8 c_indexNodeFlag_compressionSetting = 4;
+static const uint8 c_indexNodeFlag_backReferenceTarget = 8;
+static const uint8 c_indexNodeFlag_fingerprint = 16;
+
+/**
+ * Read-only view of an index file in the binary format.
+ * The file is memory-mapped where the platform supports it. Nodes are decoded on request, so single nodes can be
+ * queried without parsing the whole index.
+ */
+class MappedIndexFile
+{
+	struct Section
+	{
+		uint64 offset = 0;
+		uint64 size = 0;
+	};
+public:
+	//Constructor
+	explicit MappedIndexFile(const Path& path);
+
+	//Destructor
+	~MappedIndexFile();
+
+	//Properties
+	inline uint32 NumberOfNodes() const
+	{
+		return this->nodes.size / c_indexNodeRecordSize;
+	}
+
+	//Methods
+	String ComputeHash(Crypto::HashAlgorithm hashAlgorithm) const;
+	/**
+	 * The UTF-8 encoded name of the node if it has a parent, or else its absolute path.
+	 * The bytes point into the mapped file and are not terminated.
+	 */
+	const uint8* GetNodeNameBytes(uint32 nodeIndex, uint32& nameSize) const;
+	UniquePointer<BackupNodeAttributes> ReadNodeAttributes(uint32 nodeIndex) const;
+	String ReadNodeName(uint32 nodeIndex) const;
+	uint32 ReadParentIndex(uint32 nodeIndex) const;
+
+	//Functions
+	static bool IsIndexFile(const Path& path);
+
+private:
+	//Members
+	Path path;
+	const uint8* data;
+	uint64 size;
+	UniquePointer<FixedArray<uint8>> buffer;
+	Section strings;
+	Section nodes;
+	Section blocks;
+	Section hashes;
+	Section chunks;
+	Section dataLocations;
+	Section identities;
+	Section fingerprints;
+	Section solidGroups;
+	Section frameTables;
+	Section frames;
+
+	//Methods
+	const uint8* GetRecord(const Section& section, uint32 recordSize, uint32 index) const;
+	const uint8* GetString(uint32 offset, uint32 length) const;
+	void ReadHeader();
+	String ReadString(uint32 offset, uint32 length) const;
+};
+
+//Inline functions
+inline uint16 ReadUInt16LE(const uint8* data)
+{
+	return uint16(data[0]) | (uint16(data[1]) << 8);
+}
+
+inline uint32 ReadUInt32LE(const uint8* data)
+{
+	return uint32(data[0]) | (uint32(data[1]) << 8) | (uint32(data[2]) << 16) | (uint32(data[3]) << 24);
+}
+
+inline uint64 ReadUInt64LE(const uint8* data)
+{
+	return uint64(ReadUInt32LE(data)) | (uint64(ReadUInt32LE(data + 4)) << 32);
+}
\ No newline at end of file
@@ -20,26 +20,38 @@
 #include "Snapshot.hpp"
 //Local
 #include "BackupNodeAttributes.hpp"
+#include "../ParallelFor.hpp"
 #include "../Serialization.hpp"
 #include "VirtualSnapshotFilesystem.hpp"
 #include "../config/CompressionStatistics.hpp"
 #include "../StreamPipingFailedException.hpp"
 #include "../status/StatusTrackingOutputStream.hpp"
-
-struct HashAlgorithmAndValue
-{
-	Crypto::HashAlgorithm hashAlgorithm;
-	String hashValue;
-};
-
-namespace StdXX::Serialization
+#include "ChunkStore.hpp"
+#include "ContentDefinedChunker.hpp"
+#include "FrameCompressor.hpp"
+#include "../TaskWindow.hpp"
+#include "../indexing/CompressibilityProbe.hpp"
+
+//Global variables
+static Atomic<uint64> g_useTicks(1);
+
+//Local functions
+/**
+ * @return false if the stream does not have exactly size bytes
+ */
+static bool ReadExactly(InputStream& inputStream, uint8* destination, uint32 size)
 {
-	template <typename ArchiveType>
-	void Archive(ArchiveType& ar, HashAlgorithmAndValue& hashAlgorithmAndValue)
+	while(size)
 	{
-		CustomArchive(ar, u8"algorithm", hashAlgorithmAndValue.hashAlgorithm);
-		ar & Binding(u8"hash", hashAlgorithmAndValue.hashValue);
+		uint32 nBytesRead = inputStream.ReadBytes(destination, size);
+		if(nBytesRead == 0)
+			return false;
+		destination += nBytesRead;
+		size -= nBytesRead;
 	}
+
+	uint8 byte;
+	return inputStream.ReadBytes(&byte, 1) == 0;
 }
 
 //Constructors
@@ -49,23 +61,34 @@ Snapshot::Snapshot()
 	String snapshotName = u8"snapshot_" + dateTime.Date().ToISOString() + u8"_";
 	snapshotName += String::Number(dateTime.GetTime().Hours(), 10, 2) + u8"_" + String::Number(dateTime.GetTime().Minutes(), 10, 2) + u8"_" + String::Number(dateTime.GetTime().Seconds(), 10, 2);
 
+	const Config& config = InjectionContainer::Instance().Config();
+
 	this->name = snapshotName;
+	this->indexFilePath = config.indexPath / this->name + (u8"." + String(c_indexFileExtension));
 	this->prev = nullptr;
+	this->snapshotsByName = nullptr;
 	this->index = new BackupNodeIndex();
-
-	const Path& dataPath = InjectionContainer::Instance().Config().dataPath;
-
-	this->fileSystem = new FlatVolumesFileSystem(dataPath / this->name, *this->index);
+	this->fileSystem = new FlatVolumesFileSystem(config.dataPath / this->name, *this->index);
+	this->isIndexLoaded = true;
+	this->isIndexReferenced = true;
+	this->nIndexWalkers = 0;
+	this->isIndexFileVerified = true;
+	this->lastUseTick = g_useTicks++;
+	this->indexLoadDuration = 0;
 }
 
-Snapshot::Snapshot(const String& name, Serialization::XMLDeserializer& xmlDeserializer)
+Snapshot::Snapshot(const String& name, const Path& indexFilePath)
 {
 	this->name = name;
+	this->indexFilePath = indexFilePath;
 	this->prev = nullptr;
-	this->index = new BackupNodeIndex(xmlDeserializer);
-
-	const Path& dataPath = InjectionContainer::Instance().Config().dataPath;
-	this->fileSystem = new FlatVolumesFileSystem(dataPath / this->name, *this->index);
+	this->snapshotsByName = nullptr;
+	this->isIndexLoaded = false;
+	this->isIndexReferenced = false;
+	this->nIndexWalkers = 0;
+	this->isIndexFileVerified = false;
+	this->lastUseTick = 0;
+	this->indexLoadDuration = 0;
 }
 
 //Public methods
@@ -77,17 +100,17 @@ void Snapshot::BackupMove(uint32 nodeIndex, const OSFileSystemNodeIndex &sourceI
 	BackupNodeAttributes* attributes = new BackupNodeAttributes(oldAttributes);
 	attributes->CopyFrom(newAttributes);
 	attributes->OwnsBlocks(false);
+	attributes->SolidGroup({});
 	attributes->BackReferenceTarget(oldPath);
 	this->index->AddNode(filePath, attributes);
 }
 
-void Snapshot::BackupNode(uint32 index, const OSFileSystemNodeIndex &sourceIndex, ProcessStatus& processStatus)
+void Snapshot::BackupNode(uint32 index, const OSFileSystemNodeIndex &sourceIndex, ProcessStatus& processStatus, const BackupNodeIndex* lastIndex)
 {
 	const Path& filePath = sourceIndex.GetNodePath(index);
 	const FileSystemNodeAttributes& fileAttributes = sourceIndex.GetNodeAttributes(index);
 
-	BackupNodeAttributes *attributes = new BackupNodeAttributes(fileAttributes);
-	this->index->AddNode(filePath, attributes);
+	BackupNodeAttributes *attributes = &this->index->GetChangeableNodeAttributes(this->index->GetNodeIndex(filePath));
 
 	InjectionContainer &injectionContainer = InjectionContainer::Instance();
 	const ConfigManager &configManager = injectionContainer.ConfigManager();
@@ -96,18 +119,41 @@ void Snapshot::BackupNode(uint32 index, const OSFileSystemNodeIndex &sourceIndex
 
 	String ext = filePath.GetFileExtension();
 
-	UniquePointer<InputStream> nodeInputStream;
+	//the fingerprint is computed while the data is read anyway
+	NodeFingerprinter fingerprinter(fileAttributes.Size());
+
+	UniquePointer<SeekableInputStream> fileInputStream;
+	UniquePointer<InputStream> linkInputStream;
+	InputStream* nodeInputStream;
 	float32 compressionRate;
 	if(fileAttributes.Type() == FileType::File)
 	{
-		nodeInputStream = sourceIndex.OpenFile(filePath);
+		fileInputStream = sourceIndex.OpenFile(filePath);
+		nodeInputStream = fileInputStream.operator->();
 		compressionRate = compressionStatistics.GetCompressionRate(ext);
 		if(fileAttributes.Size() == 0)
 		    compressionRate = 1; //don't compress empty files
+		else if(!lastIndex)
+		{
+			//the extension tells nothing about extensionless, encrypted or renamed files.
+			//Speculatively backed up nodes are not probed, most of them turn out to be moves whose data is discarded
+			Optional<float32> probedCompressionRate = CompressibilityProbe::EstimateCompressionRate(*fileInputStream, fileAttributes.Size());
+			if(probedCompressionRate.HasValue())
+				compressionRate = compressionStatistics.CombineWithProbe(compressionRate, *probedCompressionRate);
+		}
+
+		if(config.chunkingThreshold and (fileAttributes.Size() >= config.chunkingThreshold))
+		{
+			FingerprintingInputStream fingerprintingInputStream(*nodeInputStream, fingerprinter);
+			this->BackupChunkedFile(*attributes, filePath, fingerprintingInputStream, compressionRate, processStatus, lastIndex);
+			attributes->Fingerprint(fingerprinter.Finish());
+			return;
+		}
 	}
 	else if(fileAttributes.Type() == FileType::Link)
 	{
-		nodeInputStream = sourceIndex.OpenLinkTargetAsStream(filePath);
+		linkInputStream = sourceIndex.OpenLinkTargetAsStream(filePath);
+		nodeInputStream = linkInputStream.operator->();
 		if(fileAttributes.Size() > 100)
 			compressionRate = 0; //text usually compresses well
 		else
@@ -118,7 +164,8 @@ void Snapshot::BackupNode(uint32 index, const OSFileSystemNodeIndex &sourceIndex
 		return;
 	}
 	UniquePointer<Crypto::HashFunction> hasher = Crypto::HashFunction::CreateInstance(config.hashAlgorithm);
-	Crypto::HashingInputStream hashingInputStream(*nodeInputStream, hasher.operator->());
+	FingerprintingInputStream fingerprintingInputStream(*nodeInputStream, fingerprinter);
+	Crypto::HashingInputStream hashingInputStream(fingerprintingInputStream, hasher.operator->());
 
 	UniquePointer<OutputStream> fileOutputStream = this->fileSystem->CreateFile(filePath);
 	BufferedOutputStream blockBuffer(*fileOutputStream, config.blockSize);
@@ -126,12 +173,23 @@ void Snapshot::BackupNode(uint32 index, const OSFileSystemNodeIndex &sourceIndex
 	OutputStream* outputStream = &blockBuffer;
 
 	UniquePointer<Compressor> compressor;
-	if(compressionRate <= 0.9f)
+	UniquePointer<FrameCompressor> frameCompressor;
+	Optional<CompressionMethod> compressionMethod;
+	if(compressionRate <= c_maxCompressibleRate)
 	{
-		uint8 compressionLevel = compressionStatistics.GetCompressionLevel(compressionRate);
-		compressor = Compressor::Create(config.compressionStreamFormatType, config.compressionAlgorithm, blockBuffer, compressionLevel);
-		outputStream = compressor.operator->();
-		attributes->CompressionSetting(configManager.CompressionSetting());
+		compressionMethod = compressionStatistics.ChooseCompressionMethod(compressionRate, fileAttributes.Size());
+		if( (fileAttributes.Type() == FileType::File) and config.compressionFrameSize and (fileAttributes.Size() >= 2 * config.compressionFrameSize) )
+		{
+			//a single compression stream would keep one worker busy long after all others ran out of work
+			frameCompressor = new FrameCompressor(blockBuffer, (uint32)config.compressionFrameSize, *compressionMethod, injectionContainer.TaskWindowPool(), injectionContainer.NumberOfWorkers());
+			outputStream = frameCompressor.operator->();
+		}
+		else
+		{
+			compressor = ConfigManager::CreateCompressor(*compressionMethod, blockBuffer);
+			outputStream = compressor.operator->();
+		}
+		attributes->CompressionSetting(compressionMethod->setting);
 	}
 
 	StatusTrackingOutputStream statusTrackingOutputStream(*outputStream, processStatus);
@@ -141,16 +199,36 @@ void Snapshot::BackupNode(uint32 index, const OSFileSystemNodeIndex &sourceIndex
 		throw StreamPipingFailedException(filePath);
 	if(!compressor.IsNull())
 		compressor->Finalize();
+	if(!frameCompressor.IsNull())
+	{
+		frameCompressor->Finalize();
+		attributes->Frames(FrameTable{ .frameSize = config.compressionFrameSize, .compressedSizes = frameCompressor->CompressedFrameSizes() });
+	}
 	outputStream->Flush();
+	fileOutputStream->Flush(); //commits the written blocks to the index
+
+	hasher->Finish();
+	Digest hash = Digest::FromHashFunction(*hasher);
+	attributes->Fingerprint(fingerprinter.Finish());
 
-	if(!compressor.IsNull() && (fileAttributes.Type() == FileType::File))
+	if(lastIndex)
+	{
+		uint32 lastNodeIndex = lastIndex->FindNodeIndexByHash(hash);
+		if(lastNodeIndex != Unsigned<uint32>::Max())
+		{
+			this->fileSystem->DiscardFile(*fileOutputStream, filePath);
+			this->ReferenceData(*attributes, filePath, *lastIndex, lastNodeIndex);
+			return;
+		}
+	}
+
+	if(compressionMethod.HasValue() && (fileAttributes.Type() == FileType::File))
 	{
 		compressionRate = attributes->ComputeSumOfBlockSizes() / (float32)attributes->Size();
-		compressionStatistics.AddCompressionRateSample(ext, compressionRate);
+		compressionStatistics.AddCompressionRateSample(ext, compressionRate, *compressionMethod);
 	}
 
-	hasher->Finish();
-	attributes->AddHashValue(config.hashAlgorithm, hasher->GetDigestString().ToLowercase());
+	attributes->AddHashValue(config.hashAlgorithm, hash);
 }
 
 void Snapshot::BackupNodeMetadata(uint32 index, const BackupNodeAttributes& oldAttributes, const OSFileSystemNodeIndex &sourceIndex)
@@ -161,24 +239,118 @@ void Snapshot::BackupNodeMetadata(uint32 index, const BackupNodeAttributes& oldA
 	BackupNodeAttributes* attributes = new BackupNodeAttributes(oldAttributes);
 	attributes->CopyFrom(newAttributes);
 	attributes->OwnsBlocks(false);
+	attributes->SolidGroup({});
 	this->index->AddNode(filePath, attributes);
 }
 
-const Snapshot *Snapshot::FindDataSnapshot(uint32 nodeIndex, Path& nodePathInSnapshot) const
+void Snapshot::BackupSolidGroup(const DynamicArray<uint32>& nodeIndices, const OSFileSystemNodeIndex &sourceIndex, ProcessStatus& processStatus, const BackupNodeIndex* lastIndex)
 {
-	if(!this->index->HasNodeData(nodeIndex))
+	InjectionContainer &injectionContainer = InjectionContainer::Instance();
+	const ConfigManager &configManager = injectionContainer.ConfigManager();
+	const Config &config = configManager.Config();
+	CompressionStatistics& compressionStatistics = injectionContainer.CompressionStats();
+
+	//the group is created with its first member that has new data, which becomes the leader
+	uint32 leaderNodeIndex = Unsigned<uint32>::Max();
+	BackupNodeAttributes* leaderAttributes = nullptr;
+	String leaderExtension;
+	CompressionMethod compressionMethod;
+	bool hasMixedExtensions = false;
+	UniquePointer<OutputStream> groupOutputStream;
+	UniquePointer<BufferedOutputStream> blockBuffer;
+	UniquePointer<Compressor> compressor;
+	uint64 groupSize = 0;
+
+	for(uint32 index : nodeIndices)
 	{
-        const BackupNodeAttributes& attributes = this->index->GetNodeAttributes(nodeIndex);
-		Path parentPath;
-		if(attributes.BackReferenceTarget().HasValue())
-			parentPath = *attributes.BackReferenceTarget();
-		else
-			parentPath = this->index->GetNodePath(nodeIndex);
-		return this->prev->FindDataSnapshot(this->prev->index->GetNodeIndex(parentPath), nodePathInSnapshot);
+		const Path filePath = sourceIndex.GetNodePath(index);
+		const uint32 size = (uint32)sourceIndex.GetNodeAttributes(index).Size(); //at most solidGroupThreshold
+		const uint32 nodeIndex = this->index->GetNodeIndex(filePath);
+		BackupNodeAttributes& attributes = this->index->GetChangeableNodeAttributes(nodeIndex);
+
+		//the files are small, so they are read completely before anything is written. Files whose data exists already never end up in the group
+		FixedArray<uint8> data(size);
+		{
+			UniquePointer<SeekableInputStream> nodeInputStream = sourceIndex.OpenFile(filePath);
+			if(!ReadExactly(*nodeInputStream, data.Data(), size))
+				throw StreamPipingFailedException(filePath);
+		}
+
+		NodeFingerprinter fingerprinter(size);
+		fingerprinter.Update(data.Data(), size);
+		attributes.Fingerprint(fingerprinter.Finish());
+
+		UniquePointer<Crypto::HashFunction> hasher = Crypto::HashFunction::CreateInstance(config.hashAlgorithm);
+		hasher->Update(data.Data(), size);
+		hasher->Finish();
+		Digest hash = Digest::FromHashFunction(*hasher);
+
+		processStatus.AddFinishedSize(size);
+
+		if(lastIndex)
+		{
+			uint32 lastNodeIndex = lastIndex->FindNodeIndexByHash(hash);
+			if(lastNodeIndex != Unsigned<uint32>::Max())
+			{
+				this->ReferenceData(attributes, filePath, *lastIndex, lastNodeIndex);
+				continue;
+			}
+		}
+
+		if(compressor.IsNull())
+		{
+			leaderNodeIndex = nodeIndex;
+			leaderAttributes = &attributes;
+			leaderExtension = filePath.GetFileExtension();
+
+			float32 compressionRate = compressionStatistics.GetCompressionRate(leaderExtension);
+			compressionMethod = compressionStatistics.ChooseCompressionMethod(compressionRate, config.solidGroupSize);
+
+			groupOutputStream = this->fileSystem->CreateFile(filePath);
+			blockBuffer = new BufferedOutputStream(*groupOutputStream, config.blockSize);
+			compressor = ConfigManager::CreateCompressor(compressionMethod, *blockBuffer);
+			attributes.CompressionSetting(compressionMethod.setting);
+		}
+
+		else if(filePath.GetFileExtension().ToLowercase() != leaderExtension.ToLowercase())
+			hasMixedExtensions = true;
+
+		compressor->WriteBytes(data.Data(), size);
+
+		attributes.OwnsBlocks(true);
+		attributes.SolidGroup(SolidGroupMembership{ .leaderNodeIndex = leaderNodeIndex, .offset = groupSize });
+		attributes.AddHashValue(config.hashAlgorithm, hash);
+		groupSize += size;
+	}
+
+	if(compressor.IsNull())
+		return;
+
+	compressor->Finalize();
+	blockBuffer->Flush();
+	groupOutputStream->Flush(); //commits the written blocks to the index
+
+	//the rate of a group of different file types is not the rate of any of them
+	if(!hasMixedExtensions)
+		compressionStatistics.AddCompressionRateSample(leaderExtension, leaderAttributes->ComputeSumOfBlockSizes() / (float32)groupSize, compressionMethod);
+}
+
+const Snapshot *Snapshot::FindDataSnapshot(uint32 nodeIndex, uint32& dataNodeIndex) const
+{
+	const Snapshot* dataSnapshot = this;
+	dataNodeIndex = nodeIndex;
+	while(true)
+	{
+		IndexWalk walk(*dataSnapshot);
+		if(dataSnapshot->index->HasNodeData(dataNodeIndex))
+			break;
+		dataSnapshot->ResolveDataLocation(dataNodeIndex, dataSnapshot, dataNodeIndex);
 	}
 
-	nodePathInSnapshot = this->index->GetNodePath(nodeIndex);
-	return this;
+	//the caller reads the data through the returned snapshot. Snapshots in between may be released again
+	dataSnapshot->AcquireIndex(false);
+	dataSnapshot->lastUseTick = g_useTicks++;
+	return dataSnapshot;
 }
 
 void Snapshot::Mount(const Path& mountPoint) const
@@ -187,6 +359,26 @@ void Snapshot::Mount(const Path& mountPoint) const
 	FileSystemsManager::Instance().OSFileSystem().MountReadOnly(mountPoint, vsf);
 }
 
+void Snapshot::RecordDataLocations()
+{
+	for(uint32 i = 0; i < this->index->GetNumberOfNodes(); i++)
+	{
+		if(this->index->HasNodeData(i))
+			continue;
+
+		const Snapshot* dataSnapshot;
+		uint32 dataNodeIndex;
+		this->ResolveDataLocation(i, dataSnapshot, dataNodeIndex);
+		this->index->GetChangeableNodeAttributes(i).DataLocation(DataLocation{ .snapshotName = dataSnapshot->Name(), .nodeIndex = dataNodeIndex });
+	}
+}
+
+void Snapshot::ReleaseIndex() const
+{
+	AutoLock lock(this->loadLock);
+	this->FreeIndex();
+}
+
 void Snapshot::Restore(const Path &restorePoint) const
 {
 	InjectionContainer& ic = InjectionContainer::Instance();
@@ -197,12 +389,11 @@ void Snapshot::Restore(const Path &restorePoint) const
 			this->Index().GetNumberOfNodes(), this->Index().ComputeTotalSize());
 
 	//all dirs in order first
-	for(const auto& kv : this->index->PathMap())
+	for(uint32 i : this->Index().ListNodesTopDown())
     {
-	    uint32 i = this->index->GetNodeIndex(kv.key);
-        const BackupNodeAttributes& attributes = this->index->GetNodeAttributes(i);
+        const BackupNodeAttributes& attributes = this->Index().GetNodeAttributes(i);
 
-        Path nodeRestorePath = restorePoint.String() + kv.key.String();
+        Path nodeRestorePath = restorePoint.String() + this->Index().GetNodePath(i).String();
         if(nodeRestorePath.GetName().IsEmpty())
             nodeRestorePath = nodeRestorePath.GetParent();
 
@@ -213,104 +404,80 @@ void Snapshot::Restore(const Path &restorePoint) const
         }
     }
 
-	for(uint32 i = 0; i < this->Index().GetNumberOfNodes(); i++)
+	ParallelFor(threadPool, ic.NumberOfWorkers(), this->Index().GetNumberOfNodes(), [this, &restorePoint, &process](uint32 i)
 	{
-		threadPool.EnqueueTask([this, i, &restorePoint, &process]()
-		{
-			const BackupNodeAttributes& attributes = this->index->GetNodeAttributes(i);
-			if(attributes.Type() == FileType::Directory)
+		const BackupNodeAttributes& attributes = this->Index().GetNodeAttributes(i);
+		if(attributes.Type() == FileType::Directory)
                 return; //skip
 
-			const Path& filePath = this->Index().GetNodePath(i);
-			Path nodeRestorePath = restorePoint.String() + filePath.String();
-			if(nodeRestorePath.GetName().IsEmpty())
-				nodeRestorePath = nodeRestorePath.GetParent();
+		const Path& filePath = this->Index().GetNodePath(i);
+		Path nodeRestorePath = restorePoint.String() + filePath.String();
+		if(nodeRestorePath.GetName().IsEmpty())
+			nodeRestorePath = nodeRestorePath.GetParent();
 
-			switch(attributes.Type())
+		switch(attributes.Type())
+		{
+			case FileType::File:
 			{
-				case FileType::File:
-				{
-					Path realNodePath;
-					const Snapshot* snapshot = this->FindDataSnapshot(i, realNodePath);
-					UniquePointer<InputStream> input = snapshot->fileSystem->OpenFileForReading(snapshot->Index().GetNodeIndex(realNodePath), true);
-					FileOutputStream output(nodeRestorePath, false, &attributes.Permissions());
-
-					//write
-					uint64 flushedSize = input->FlushTo(output);
-					if(flushedSize != attributes.Size())
-						throw StreamPipingFailedException(filePath);
-
-					process.AddFinishedSize(flushedSize);
-				}
-				break;
-				case FileType::Link:
-				{
-					Path realNodePath;
-					const Snapshot* snapshot = this->FindDataSnapshot(i, realNodePath);
-					Optional<Path> target = snapshot->fileSystem->ReadLinkTarget(realNodePath);
-
-					File link(nodeRestorePath);
-					link.CreateLink(target.Value());
-
-					process.AddFinishedSize(attributes.Size());
-				}
-				break;
+				uint32 dataNodeIndex;
+				const Snapshot* snapshot = this->FindDataSnapshot(i, dataNodeIndex);
+				UniquePointer<InputStream> input = snapshot->Filesystem().OpenFileForReading(dataNodeIndex, true);
+				FileOutputStream output(nodeRestorePath, false, &attributes.Permissions());
+
+				//write
+				uint64 flushedSize = input->FlushTo(output);
+				if(flushedSize != attributes.Size())
+					throw StreamPipingFailedException(filePath);
+
+				process.AddFinishedSize(flushedSize);
 			}
+			break;
+			case FileType::Link:
+			{
+				uint32 dataNodeIndex;
+				const Snapshot* snapshot = this->FindDataSnapshot(i, dataNodeIndex);
+				Optional<Path> target = snapshot->Filesystem().ReadLinkTarget(snapshot->Index().GetNodePath(dataNodeIndex));
 
-			//open files
-			process.IncFinishedCount();
-		});
-	}
-	threadPool.WaitForAllTasksToComplete();
+				File link(nodeRestorePath);
+				link.CreateLink(target.Value());
+
+				process.AddFinishedSize(attributes.Size());
+			}
+			break;
+		}
+
+		//open files
+		process.IncFinishedCount();
+	});
 	process.Finished();
 }
 
 void Snapshot::Serialize() const
 {
-	const Config &config = InjectionContainer::Instance().Config();
-	Crypto::HashAlgorithm hashAlgorithm = config.hashAlgorithm;
-
-	FileOutputStream indexFile(this->IndexFilePath());
-	UniquePointer<Compressor> compressor = Compressor::Create(config.compressionStreamFormatType, config.compressionAlgorithm, indexFile, config.maxCompressionLevel);
-	BufferedOutputStream bufferedOutputStream(*compressor);
-	Crypto::HashingOutputStream hashingOutputStream(bufferedOutputStream, hashAlgorithm);
-	Serialization::XmlSerializer xmlSerializer(hashingOutputStream);
-	this->index->Serialize(xmlSerializer);
-	hashingOutputStream.Flush();
-	compressor->Finalize();
-
-	UniquePointer<Crypto::HashFunction> hasher = hashingOutputStream.Reset();
-	hasher->Finish();
-
-	HashAlgorithmAndValue protection;
-	protection.hashAlgorithm = hashAlgorithm;
-	protection.hashValue = hasher->GetDigestString().ToLowercase();
+	WriteIndexFile(*this->index, this->IndexFilePath(), this->IndexHashFilePath());
+}
 
-	FileOutputStream indexHashFile(this->IndexHashFilePath());
-	BufferedOutputStream bufferedOutputStream2(indexHashFile);
-	Serialization::JSONSerializer protectionSerializer(bufferedOutputStream2);
-	protectionSerializer << protection;
-	bufferedOutputStream2.Flush();
+void Snapshot::StageNode(uint32 index, const OSFileSystemNodeIndex& sourceIndex)
+{
+	this->index->AddNode(sourceIndex.GetNodePath(index), new BackupNodeAttributes(sourceIndex.GetNodeAttributes(index)));
 }
 
-bool Snapshot::VerifyNode(const Path& path) const
+bool Snapshot::VerifyNode(uint32 nodeIndex) const
 {
-	uint32 nodeIndex = this->index->GetNodeIndex(path);
-	const FileSystemNodeAttributes& attributes = this->index->GetNodeAttributes(nodeIndex);
+	const FileSystemNodeAttributes& attributes = this->Index().GetNodeAttributes(nodeIndex);
 
 	//just read the file in once with verification
 	UniquePointer<InputStream> input;
 
 	if(attributes.Type() == FileType::Link)
-		input = this->fileSystem->OpenLinkTargetAsStream(path, true);
+		input = this->Filesystem().OpenLinkTargetAsStream(this->Index().GetNodePath(nodeIndex), true);
 	else
-		input = this->fileSystem->OpenFileForReading(nodeIndex, true);
+		input = this->Filesystem().OpenFileForReading(nodeIndex, true);
 	NullOutputStream nullOutputStream;
 	try
 	{
 		const uint64 readSize = input->FlushTo(nullOutputStream);
-		const FileSystemNodeAttributes& fileAttributes = ((FileSystemNodeIndex&)*this->index).GetNodeAttributes(this->index->GetNodeIndex(path));
-		if(readSize != fileAttributes.Size())
+		if(readSize != attributes.Size())
 			return false;
 	}
 	catch(ErrorHandling::VerificationFailedException&)
@@ -321,38 +488,268 @@ bool Snapshot::VerifyNode(const Path& path) const
 	return true;
 }
 
-//Class functions
-UniquePointer<Snapshot> Snapshot::Deserialize(const Path &path)
+//Private methods
+void Snapshot::AcquireIndex(bool walk) const
 {
-	String title = path.GetTitle();
-	String extension = path.GetFileExtension();
+	bool loaded = false;
+	{
+		AutoLock lock(this->loadLock);
+		if(!this->isIndexLoaded)
+		{
+			this->LoadIndex();
+			loaded = true;
+		}
+
+		if(walk)
+			this->nIndexWalkers++;
+		else
+			this->isIndexReferenced = true;
+	}
+
+	//releasing locks the other snapshots, so this must not hold the own lock
+	if(loaded)
+		this->ReleaseWalkedIndexesOverBudget();
+}
+
+void Snapshot::BackupChunkedFile(BackupNodeAttributes& attributes, const Path& filePath, InputStream& inputStream, float32 compressionRate, ProcessStatus& processStatus, const BackupNodeIndex* lastIndex)
+{
+	InjectionContainer &injectionContainer = InjectionContainer::Instance();
+	const Config &config = injectionContainer.Config();
+	ChunkStore& chunkStore = injectionContainer.ChunkStore();
+	CompressionStatistics& compressionStatistics = injectionContainer.CompressionStats();
+
+	Optional<CompressionMethod> compressionMethod;
+	if(compressionRate <= c_maxCompressibleRate)
+		compressionMethod = compressionStatistics.ChooseCompressionMethod(compressionRate, attributes.Size());
 
-	if(extension == u8"lzma")
+	UniquePointer<Crypto::HashFunction> hasher = Crypto::HashFunction::CreateInstance(config.hashAlgorithm);
+	ContentDefinedChunker chunker(inputStream);
+
+	uint64 readSize = 0;
+	uint64 newChunksSize = 0;
+	uint64 storedSize = 0;
+
+	//the chunks are compressed concurrently, so that a large file doesn't keep a single worker busy
+	struct PendingChunk
 	{
-		FileInputStream hashInputStream(path.GetParent() / title + String(c_hashFileSuffix));
-		BufferedInputStream hashBufferedInputStream(hashInputStream);
-		Serialization::JSONDeserializer jsonDeserializer(hashBufferedInputStream);
-		HashAlgorithmAndValue protection;
-		jsonDeserializer >> protection;
+		UniquePointer<FixedArray<uint8>> data;
+		uint64 nBytesStored;
+	};
+	FixedArray<PendingChunk> pendingChunks(Math::Max(injectionContainer.NumberOfWorkers(), 1u));
+	TaskWindow taskWindow(injectionContainer.TaskWindowPool(), pendingChunks.GetNumberOfElements());
+	auto consumeChunk = [&pendingChunks, &newChunksSize, &storedSize](uint32 slot)
+	{
+		PendingChunk& pendingChunk = pendingChunks[slot];
+		if(pendingChunk.nBytesStored)
+		{
+			newChunksSize += pendingChunk.data->GetNumberOfElements();
+			storedSize += pendingChunk.nBytesStored;
+		}
+		pendingChunk.data = nullptr;
+	};
+
+	const uint8* chunkData;
+	uint32 chunkSize;
+	while( (chunkSize = chunker.ReadNextChunk(chunkData)) != 0 )
+	{
+		hasher->Update(chunkData, chunkSize);
+
+		UniquePointer<Crypto::HashFunction> chunkHasher = Crypto::HashFunction::CreateInstance(config.hashAlgorithm);
+		chunkHasher->Update(chunkData, chunkSize);
+		chunkHasher->Finish();
+		Digest chunkHash = Digest::FromHashFunction(*chunkHasher);
+
+		uint32 slot;
+		while(taskWindow.TryAcquireFinishedSlot(slot))
+			consumeChunk(slot);
+
+		bool wasUsed;
+		slot = taskWindow.AcquireSlot(wasUsed);
+		if(wasUsed)
+			consumeChunk(slot);
+
+		//the chunker reuses its buffer for the next chunk
+		PendingChunk& pendingChunk = pendingChunks[slot];
+		pendingChunk.data = new FixedArray<uint8>(chunkSize);
+		MemCopy(pendingChunk.data->Data(), chunkData, chunkSize);
+		taskWindow.Start(slot, [&chunkStore, &pendingChunk, &compressionMethod, chunkHash]()
+		{
+			pendingChunk.nBytesStored = chunkStore.AddChunk(chunkHash, pendingChunk.data->Data(), pendingChunk.data->GetNumberOfElements(), compressionMethod);
+		});
+		attributes.AddChunk({ .hash = chunkHash, .size = chunkSize });
 
-		FileInputStream fileInputStream(path);
-		BufferedInputStream bufferedInputStream(fileInputStream);
-		UniquePointer<Decompressor> decompressor = Decompressor::Create(CompressionStreamFormatType::lzma, bufferedInputStream, false);
-		UniquePointer<Crypto::HashFunction> hashFunction = Crypto::HashFunction::CreateInstance(protection.hashAlgorithm);
-		Crypto::HashingInputStream hashingInputStream(*decompressor, hashFunction.operator->());
+		readSize += chunkSize;
+		processStatus.AddFinishedSize(chunkSize);
+	}
+	taskWindow.WaitForAll(consumeChunk);
 
-		Serialization::XMLDeserializer deserializer(hashingInputStream);
+	if(readSize != attributes.Size())
+		throw StreamPipingFailedException(filePath);
 
-		Path name(title); //strip of .xml
-		UniquePointer<Snapshot> snapshot = new Snapshot(name.GetTitle(), deserializer);
+	hasher->Finish();
+	Digest hash = Digest::FromHashFunction(*hasher);
+
+	if(lastIndex)
+	{
+		//chunks are deduplicated by the chunk store anyway, only the node needs to become a reference
+		uint32 lastNodeIndex = lastIndex->FindNodeIndexByHash(hash);
+		if(lastNodeIndex != Unsigned<uint32>::Max())
+		{
+			this->ReferenceData(attributes, filePath, *lastIndex, lastNodeIndex);
+			return;
+		}
+	}
+
+	if(compressionMethod.HasValue() and newChunksSize)
+		compressionStatistics.AddCompressionRateSample(filePath.GetFileExtension(), storedSize / (float32)newChunksSize, *compressionMethod);
+
+	attributes.AddHashValue(config.hashAlgorithm, hash);
+}
+
+void Snapshot::FreeIndex() const
+{
+	if(!this->isIndexLoaded)
+		return;
+	this->isIndexLoaded = false;
+	this->isIndexReferenced = false;
+	this->fileSystem = nullptr;
+	this->index = nullptr;
+
+	AutoLock resolvedDataLocationsLock(this->resolvedDataLocationsLock);
+	this->resolvedDataLocations.Release();
+}
+
+void Snapshot::LoadIndex() const
+{
+	Clock clock;
+	clock.Start();
 
-		hashFunction->Finish();
-		String got = hashFunction->GetDigestString().ToLowercase();
+	if(this->indexFilePath.GetFileExtension() == c_legacyIndexFileExtension)
+		this->index = ReadLegacyIndexFile(this->indexFilePath, this->IndexHashFilePath());
+	else
+		this->index = ReadIndexFile(this->indexFilePath, this->IndexHashFilePath(), !this->isIndexFileVerified);
+	this->isIndexFileVerified = true;
+	this->index->Freeze();
+
+	const Path& dataPath = InjectionContainer::Instance().Config().dataPath;
+	this->fileSystem = new FlatVolumesFileSystem(dataPath / this->name, *this->index);
+
+	this->indexLoadDuration = clock.GetElapsedMicroseconds();
+	this->lastUseTick = g_useTicks++;
+	this->isIndexLoaded = true;
+}
+
+void Snapshot::ReleaseWalkedIndexesOverBudget() const
+{
+	const uint64 budget = InjectionContainer::Instance().Config().indexMemoryBudget;
+	if( (budget == 0) or (this->snapshotsByName == nullptr) )
+		return;
+
+	uint64 usage = 0;
+	BinaryTreeMap<uint64, const Snapshot*> releasable; //ordered by last use
+	for(const auto& kv : *this->snapshotsByName)
+	{
+		const Snapshot* snapshot = kv.value;
+		AutoLock lock(snapshot->loadLock);
+		if(!snapshot->isIndexLoaded)
+			continue;
+
+		usage += snapshot->EstimateIndexMemoryUsage();
+		if( (snapshot != this) and !snapshot->isIndexReferenced and (snapshot->nIndexWalkers == 0) )
+			releasable.Insert(snapshot->lastUseTick, snapshot);
+	}
+	if(usage <= budget)
+		return;
 
-		if(protection.hashValue != got)
-			throw StreamPipingFailedException(path);
+	for(const auto& kv : releasable)
+	{
+		if(usage <= budget)
+			break;
+
+		//the snapshot might have been used since it was collected
+		AutoLock lock(kv.value->loadLock);
+		if(!kv.value->isIndexLoaded or kv.value->isIndexReferenced or (kv.value->nIndexWalkers != 0))
+			continue;
+		usage -= kv.value->EstimateIndexMemoryUsage();
+		kv.value->FreeIndex();
+	}
+}
 
-		return snapshot;
+void Snapshot::ResolveDataLocation(uint32 nodeIndex, const Snapshot*& dataSnapshot, uint32& dataNodeIndex) const
+{
+	const BackupNodeAttributes& attributes = this->index->GetNodeAttributes(nodeIndex);
+	if(attributes.DataLocation().HasValue())
+	{
+		ASSERT(this->snapshotsByName, u8"Snapshots need to be known to resolve data locations");
+		const String& snapshotName = attributes.DataLocation()->snapshotName;
+		if(this->snapshotsByName->Contains(snapshotName))
+		{
+			dataSnapshot = (*this->snapshotsByName)[snapshotName];
+			dataNodeIndex = attributes.DataLocation()->nodeIndex;
+			return;
+		}
+	}
+
+	//the index was written without data locations, walk the snapshot chain once and remember the result
+	{
+		AutoLock lock(this->resolvedDataLocationsLock);
+		if(this->resolvedDataLocations.Contains(nodeIndex))
+		{
+			const ResolvedDataLocation& resolved = this->resolvedDataLocations[nodeIndex];
+			dataSnapshot = resolved.snapshot;
+			dataNodeIndex = resolved.nodeIndex;
+			return;
+		}
+	}
+
+	Path parentPath;
+	if(attributes.BackReferenceTarget().HasValue())
+		parentPath = *attributes.BackReferenceTarget();
+	else
+		parentPath = this->index->GetNodePath(nodeIndex);
+
+	IndexWalk prevWalk(*this->prev);
+	uint32 prevNodeIndex = this->prev->index->GetNodeIndex(parentPath);
+	if(this->prev->index->HasNodeData(prevNodeIndex))
+	{
+		dataSnapshot = this->prev;
+		dataNodeIndex = prevNodeIndex;
+	}
+	else
+		this->prev->ResolveDataLocation(prevNodeIndex, dataSnapshot, dataNodeIndex);
+
+	AutoLock lock(this->resolvedDataLocationsLock);
+	this->resolvedDataLocations.Insert(nodeIndex, { .snapshot = dataSnapshot, .nodeIndex = dataNodeIndex });
+}
+
+void Snapshot::ReferenceData(BackupNodeAttributes& attributes, const Path& filePath, const BackupNodeIndex& lastIndex, uint32 lastNodeIndex)
+{
+	//same as BackupNodeMetadata or BackupMove
+	BackupNodeAttributes newAttributes(attributes);
+	const Path& lastPath = lastIndex.GetNodePath(lastNodeIndex);
+
+	attributes = lastIndex.GetNodeAttributes(lastNodeIndex);
+	attributes.CopyFrom(newAttributes);
+	attributes.OwnsBlocks(false);
+	attributes.SolidGroup({});
+	if(newAttributes.Fingerprint().HasValue())
+		attributes.Fingerprint(*newAttributes.Fingerprint());
+	if(lastPath != filePath)
+		attributes.BackReferenceTarget(lastPath);
+}
+
+//Class functions
+UniquePointer<Snapshot> Snapshot::Open(const Path &path)
+{
+	String title = path.GetTitle();
+	String extension = path.GetFileExtension();
+
+	if(extension == c_indexFileExtension)
+		return new Snapshot(title, path);
+	if(extension == c_legacyIndexFileExtension)
+	{
+		Path name(title); //strip of .xml
+		return new Snapshot(name.GetTitle(), path);
 	}
 
 	return nullptr; //not an index file
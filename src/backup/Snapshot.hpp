@@ -21,6 +21,7 @@
 using namespace StdXX;
 //Local
 #include "BackupNodeIndex.hpp"
+#include "IndexFile.hpp"
 #include "../status/ProcessStatus.hpp"
 #include "../indexing/OSFileSystemNodeIndex.hpp"
 #include "../Util.hpp"
@@ -28,9 +29,6 @@ using namespace StdXX;
 #include "../InjectionContainer.hpp"
 #include "../backupfilesystem/FlatVolumesFileSystem.hpp"
 
-//Constants
-static const char8_t *const c_hashFileSuffix = u8"_hash.json";
-
 class Snapshot
 {
 public:
@@ -40,14 +38,34 @@ public:
 	//Properties
 	inline const FlatVolumesFileSystem& Filesystem() const
 	{
+		this->EnsureIndexIsReferenced();
 		return *this->fileSystem;
 	}
 
 	inline const BackupNodeIndex& Index() const
 	{
+		this->EnsureIndexIsReferenced();
 		return *this->index;
 	}
 
+	/**
+	 * Time in microseconds that the last loading of the index took.
+	 */
+	inline uint64 IndexLoadDuration() const
+	{
+		return this->indexLoadDuration;
+	}
+
+	inline bool IsIndexLoaded() const
+	{
+		return this->isIndexLoaded;
+	}
+
+	inline uint64 LastUseTick() const
+	{
+		return this->lastUseTick;
+	}
+
 	inline const String& Name() const
 	{
 		return this->name;
@@ -63,28 +81,83 @@ public:
 		this->prev = newPrevious;
 	}
 
+	/**
+	 * Data locations refer to snapshots by name. The map is owned by the snapshot manager.
+	 */
+	inline void SnapshotsByName(const BinaryTreeMap<String, const Snapshot*>* snapshotsByName)
+	{
+		this->snapshotsByName = snapshotsByName;
+	}
+
 	//Methods
 	void BackupMove(uint32 nodeIndex, const OSFileSystemNodeIndex &sourceIndex, const BackupNodeAttributes& oldAttributes, const Path& oldPath);
-	void BackupNode(uint32 index, const OSFileSystemNodeIndex &sourceIndex, ProcessStatus& processStatus);
+	/**
+	 * @param lastIndex - if set, the node is backed up speculatively. Should its hash value show that its data already
+	 * exists in lastIndex, the written data is discarded again and the node becomes a move or a metadata-only change.
+	 */
+	void BackupNode(uint32 index, const OSFileSystemNodeIndex &sourceIndex, ProcessStatus& processStatus, const BackupNodeIndex* lastIndex = nullptr);
 	void BackupNodeMetadata(uint32 index, const BackupNodeAttributes& oldAttributes, const OSFileSystemNodeIndex &sourceIndex);
+	/**
+	 * Compresses the data of small files together as one stream. The files should be ordered so that similar ones are
+	 * next to each other, i.e. by extension and directory.
+	 * @param lastIndex - if set, files whose data already exists in lastIndex are not added to the group but become a
+	 * move or a metadata-only change, as in BackupNode.
+	 */
+	void BackupSolidGroup(const DynamicArray<uint32>& nodeIndices, const OSFileSystemNodeIndex &sourceIndex, ProcessStatus& processStatus, const BackupNodeIndex* lastIndex = nullptr);
 	/**
 	 * Finds the newest snapshot that has the payload data of the node identified by index of this snapshot.
-	 * @param nodeIndex
-	 * @return
+	 * @param dataNodeIndex set to the index of the node in the returned snapshot
 	 */
-	const Snapshot* FindDataSnapshot(uint32 nodeIndex, Path& nodePathInSnapshot) const;
+	const Snapshot* FindDataSnapshot(uint32 nodeIndex, uint32& dataNodeIndex) const;
 	void Mount(const Path& mountPoint) const;
+	/**
+	 * Stores for every node that does not own its data where the data is located.
+	 * The previous snapshot must be set.
+	 */
+	void RecordDataLocations();
+	/**
+	 * Frees the index and filesystem of this snapshot. They are loaded again when accessed the next time.
+	 * Must only be called when no references into the index or open files of this snapshot are held anymore.
+	 * Indexes that were only walked through to resolve data locations are released by the snapshots themselves as soon
+	 * as loading another index exceeds the memory budget.
+	 */
+	void ReleaseIndex() const;
 	void Restore(const Path& restorePoint) const;
 	void Serialize() const;
-	bool VerifyNode(const Path& path) const;
+	/**
+	 * Adds the node with its source attributes to the index so that BackupNode can fill it in later.
+	 * Nodes are staged in one thread before the index is frozen and the nodes are backed up in parallel.
+	 */
+	void StageNode(uint32 index, const OSFileSystemNodeIndex& sourceIndex);
+	bool VerifyNode(uint32 nodeIndex) const;
 
 	//Functions
-	static UniquePointer<Snapshot> Deserialize(const Path& path);
+	/**
+	 * Opens the snapshot of the index file at path without reading the index.
+	 * It is loaded lazily on first access.
+	 * @return nullptr if path is not an index file
+	 */
+	static UniquePointer<Snapshot> Open(const Path& path);
 
 	//Inline
 	inline uint64 ComputeSize() const
 	{
-		return this->index->ComputeSumOfOwnedBlockSizes();
+		return this->Index().ComputeSumOfOwnedBlockSizes();
+	}
+
+	/**
+	 * Rough estimate of the memory that the loaded index occupies.
+	 */
+	inline uint64 EstimateIndexMemoryUsage() const
+	{
+		if(!this->isIndexLoaded)
+			return 0;
+		return this->index->GetNumberOfNodes() * c_estimatedIndexBytesPerNode;
+	}
+
+	inline void FreezeIndex()
+	{
+		this->index->Freeze();
 	}
 
 	inline void WriteProtect()
@@ -96,29 +169,118 @@ public:
 	}
 
 private:
+	struct ResolvedDataLocation
+	{
+		const Snapshot* snapshot;
+		uint32 nodeIndex;
+	};
+
+	/**
+	 * Keeps the index of a snapshot loaded while data locations are resolved through it, without handing out
+	 * references into it.
+	 */
+	class IndexWalk
+	{
+	public:
+		//Constructor
+		inline IndexWalk(const Snapshot& snapshot) : snapshot(snapshot)
+		{
+			snapshot.AcquireIndex(true);
+		}
+
+		//Destructor
+		inline ~IndexWalk()
+		{
+			AutoLock lock(this->snapshot.loadLock);
+			this->snapshot.nIndexWalkers--;
+		}
+
+	private:
+		//Members
+		const Snapshot& snapshot;
+	};
+
+	//Constants
+	static const uint32 c_estimatedIndexBytesPerNode = 1024;
+
 	//Members
 	String name;
-	UniquePointer<BackupNodeIndex> index;
+	Path indexFilePath;
 	Snapshot* prev;
-	UniquePointer<FlatVolumesFileSystem> fileSystem;
+	const BinaryTreeMap<String, const Snapshot*>* snapshotsByName;
+	mutable UniquePointer<BackupNodeIndex> index;
+	mutable UniquePointer<FlatVolumesFileSystem> fileSystem;
+	mutable Mutex loadLock;
+	mutable Atomic<bool> isIndexLoaded;
+	/**
+	 * Whether references into the index may be held outside of this class, i.e. Index() or Filesystem() were called or
+	 * the snapshot was returned by FindDataSnapshot since the index was loaded.
+	 */
+	mutable Atomic<bool> isIndexReferenced;
+	/**
+	 * Number of threads that resolve data locations through the index right now. Protected by loadLock.
+	 */
+	mutable uint32 nIndexWalkers;
+	/**
+	 * Whether the index file was checked against its hash value already. It is write-protected, so reloading the index
+	 * after it was released does not need to hash it again.
+	 */
+	mutable bool isIndexFileVerified;
+	mutable Atomic<uint64> lastUseTick;
+	mutable uint64 indexLoadDuration;
+	/**
+	 * Cache for nodes of indexes that were written without data locations.
+	 */
+	mutable BinaryTreeMap<uint32, ResolvedDataLocation> resolvedDataLocations;
+	mutable Mutex resolvedDataLocationsLock;
 
 	//Constructor
-	Snapshot(const String& name, Serialization::XMLDeserializer& xmlDeserializer);
+	Snapshot(const String& name, const Path& indexFilePath);
+
+	//Methods
+	/**
+	 * Loads the index if necessary and registers the caller as walker or marks the index as referenced.
+	 * If the index had to be loaded, indexes of other snapshots are released afterwards while the memory budget is
+	 * exceeded.
+	 */
+	void AcquireIndex(bool walk) const;
+	void BackupChunkedFile(BackupNodeAttributes& attributes, const Path& filePath, InputStream& inputStream, float32 compressionRate, ProcessStatus& processStatus, const BackupNodeIndex* lastIndex);
+	/**
+	 * Frees the index and filesystem. Must be called with loadLock held.
+	 */
+	void FreeIndex() const;
+	/**
+	 * Must be called with loadLock held.
+	 */
+	void LoadIndex() const;
+	void ReferenceData(BackupNodeAttributes& attributes, const Path& filePath, const BackupNodeIndex& lastIndex, uint32 lastNodeIndex);
+	/**
+	 * Releases the least recently used indexes of other snapshots that are neither referenced nor walked through, until
+	 * the loaded indexes fit into the memory budget or no such index is left.
+	 */
+	void ReleaseWalkedIndexesOverBudget() const;
+	/**
+	 * The index of this snapshot must be walked through or referenced by the caller.
+	 */
+	void ResolveDataLocation(uint32 nodeIndex, const Snapshot*& dataSnapshot, uint32& dataNodeIndex) const;
 
 	//Properties
-	inline Path IndexFilePath() const
+	inline const Path& IndexFilePath() const
 	{
-		return this->PathPrefix() + String(u8".lzma");
+		return this->indexFilePath;
 	}
 
 	inline Path IndexHashFilePath() const
 	{
-		return this->PathPrefix() + String(c_hashFileSuffix);
+		if(this->indexFilePath.GetFileExtension() == c_legacyIndexFileExtension)
+			return this->indexFilePath.GetParent() / this->indexFilePath.GetTitle() + String(c_hashFileSuffix);
+		return this->indexFilePath.String() + String(c_hashFileSuffix);
 	}
 
-	inline Path PathPrefix() const
+	//Inline
+	inline void EnsureIndexIsReferenced() const
 	{
-		const Config &config = InjectionContainer::Instance().Config();
-		return config.indexPath / this->name + String(u8".xml");
+		if(!this->isIndexLoaded or !this->isIndexReferenced)
+			this->AcquireIndex(false);
 	}
 };
\ No newline at end of file
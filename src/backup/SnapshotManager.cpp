@@ -19,40 +19,99 @@
 //Class header
 #include "SnapshotManager.hpp"
 //Local
+#include "ChunkStore.hpp"
 #include "../status/ProcessStatus.hpp"
 #include "../config/CompressionStatistics.hpp"
 #include "../NodeIndexDifferenceResolver.hpp"
+#include "../ParallelFor.hpp"
+
+//Local functions
+static bool IsSolidGroupCandidate(uint32 nodeIndex, const OSFileSystemNodeIndex& sourceIndex)
+{
+	InjectionContainer& ic = InjectionContainer::Instance();
+
+	const FileSystemNodeAttributes& attributes = sourceIndex.GetNodeAttributes(nodeIndex);
+	if( (attributes.Type() != FileType::File) or (attributes.Size() == 0) or (attributes.Size() > ic.Config().solidGroupThreshold) )
+		return false;
+
+	//files that would not be compressed on their own don't gain anything from being grouped
+	return ic.CompressionStats().GetCompressionRate(sourceIndex.GetNodePath(nodeIndex).GetFileExtension()) <= c_maxCompressibleRate;
+}
+
+/**
+ * Orders the nodes by extension and directory, so that similar files are compressed together, and splits them into
+ * groups of at most solidGroupSize bytes.
+ */
+static DynamicArray<DynamicArray<uint32>> FormSolidGroups(const DynamicArray<uint32>& nodeIndices, const OSFileSystemNodeIndex& sourceIndex)
+{
+	struct Candidate
+	{
+		String extension;
+		String directory;
+		uint32 nodeIndex;
+
+		inline bool operator<(const Candidate& other) const
+		{
+			if(this->extension != other.extension)
+				return this->extension < other.extension;
+			if(this->directory != other.directory)
+				return this->directory < other.directory;
+			return this->nodeIndex < other.nodeIndex;
+		}
+	};
+
+	DynamicArray<Candidate> candidates;
+	candidates.EnsureCapacity(nodeIndices.GetNumberOfElements());
+	for(uint32 nodeIndex : nodeIndices)
+	{
+		Path nodePath = sourceIndex.GetNodePath(nodeIndex);
+		candidates.Push({ .extension = nodePath.GetFileExtension().ToLowercase(), .directory = nodePath.GetParent().String(), .nodeIndex = nodeIndex });
+	}
+	candidates.Sort();
+
+	const uint64 maxGroupSize = InjectionContainer::Instance().Config().solidGroupSize;
+
+	DynamicArray<DynamicArray<uint32>> groups;
+	uint64 groupSize = 0;
+	for(const Candidate& candidate : candidates)
+	{
+		uint64 size = sourceIndex.GetNodeAttributes(candidate.nodeIndex).Size();
+		if(groups.IsEmpty() or (groupSize + size > maxGroupSize))
+		{
+			groups.Push({});
+			groupSize = 0;
+		}
+		groups.Last().Push(candidate.nodeIndex);
+		groupSize += size;
+	}
+
+	return groups;
+}
 
 //Constructor
-SnapshotManager::SnapshotManager()
+SnapshotManager::SnapshotManager() : avoidedHashingSize(0)
 {
 	this->ReadInSnapshots();
 }
 
 //Public methods
-bool SnapshotManager::AddSnapshot(const OSFileSystemNodeIndex& sourceIndex)
+bool SnapshotManager::AddSnapshot(const OSFileSystemNodeIndex& sourceIndex, VerificationCoverage& verificationCoverage)
 {
 	InjectionContainer& ic = InjectionContainer::Instance();
 
 	//we simply include all nodes whether they have changed or not and skip diff.deleted
-	const NodeIndexDifferences diff = this->ComputeDifference(sourceIndex, true);
+	//new or changed nodes are hashed while they are backed up, so that they are read only once
+	const NodeIndexDifferences diff = this->ComputeDifference(sourceIndex, true, false);
+	this->avoidedHashingSize = diff.avoidedHashingSize;
 
 	UnprotectFile(ic.Config().dataPath);
+	ic.ChunkStore().Unprotect();
 	UniquePointer<Snapshot> snapshot = new Snapshot();
 
-	const uint64 totalSize = sourceIndex.ComputeTotalSize(diff.differentData);
+	const uint64 totalSize = sourceIndex.ComputeTotalSize(diff.differentData) + sourceIndex.ComputeTotalSize(diff.speculativeData);
 	ProcessStatus& process = ic.StatusTracker().AddProcessStatusTracker(u8"Creating snapshot: " + snapshot->Name(), sourceIndex.GetNumberOfNodes(), totalSize);
 
-	StaticThreadPool& threadPool = InjectionContainer::Instance().TaskQueue();
-	for(uint32 index : diff.differentData)
-	{
-		threadPool.EnqueueTask([&snapshot, index, &sourceIndex, &process]()
-		{
-			snapshot->BackupNode(index, sourceIndex, process);
-			process.IncFinishedCount();
-		});
-	}
-
+	//all nodes are added to the index in this thread and in a fixed order, so that the index is frozen while data is backed up
 	for(uint32 index : diff.differentMetadata)
 	{
 		const BackupNodeIndex& lastIndex = *this->LastIndex();
@@ -61,17 +120,59 @@ bool SnapshotManager::AddSnapshot(const OSFileSystemNodeIndex& sourceIndex)
 		process.IncFinishedCount();
 	}
 
-	for(const auto& kv : diff.moved)
+	for(const NodeMove& move : diff.moved)
 	{
 		const BackupNodeIndex& lastIndex = *this->LastIndex();
-		const BackupNodeAttributes &oldAttributes = lastIndex.GetNodeAttributes(kv.value);
-		snapshot->BackupMove(kv.key, sourceIndex, oldAttributes, lastIndex.GetNodePath(kv.value));
+		const BackupNodeAttributes &oldAttributes = lastIndex.GetNodeAttributes(move.leftIndex);
+		snapshot->BackupMove(move.rightIndex, sourceIndex, oldAttributes, lastIndex.GetNodePath(move.leftIndex));
 		process.IncFinishedCount();
 	}
 
-	threadPool.WaitForAllTasksToComplete();
+	for(uint32 index : diff.differentData)
+		snapshot->StageNode(index, sourceIndex);
+	for(uint32 index : diff.speculativeData)
+		snapshot->StageNode(index, sourceIndex);
+	snapshot->FreezeIndex();
+
+	//small files are taken out of both and compressed in solid groups
+	DynamicArray<uint32> differentData, speculativeData, solidGroupCandidates;
+	for(uint32 index : diff.differentData)
+		(IsSolidGroupCandidate(index, sourceIndex) ? solidGroupCandidates : differentData).Push(index);
+	for(uint32 index : diff.speculativeData)
+		(IsSolidGroupCandidate(index, sourceIndex) ? solidGroupCandidates : speculativeData).Push(index);
+	const DynamicArray<DynamicArray<uint32>> solidGroups = FormSolidGroups(solidGroupCandidates, sourceIndex);
+
+	//one range over all, so that workers don't run idle between them
+	const BackupNodeIndex* lastIndex = this->LastIndex();
+	const uint32 nDifferentData = differentData.GetNumberOfElements();
+	const uint32 nSingleNodes = nDifferentData + speculativeData.GetNumberOfElements();
+	ParallelFor(ic.TaskQueue(), ic.NumberOfWorkers(), nSingleNodes + solidGroups.GetNumberOfElements(), [&snapshot, &differentData, &speculativeData, &solidGroups, &sourceIndex, &process, lastIndex, nDifferentData, nSingleNodes](uint32 i)
+	{
+		if(i < nDifferentData)
+			snapshot->BackupNode(differentData[i], sourceIndex, process);
+		else if(i < nSingleNodes)
+			snapshot->BackupNode(speculativeData[i - nDifferentData], sourceIndex, process, lastIndex);
+		else
+		{
+			//nodes of the differentData kind just don't find their hash value in lastIndex
+			const DynamicArray<uint32>& group = solidGroups[i - nSingleNodes];
+			snapshot->BackupSolidGroup(group, sourceIndex, process, lastIndex);
+			for(uint32 j = 0; j < group.GetNumberOfElements(); j++)
+				process.IncFinishedCount();
+			return;
+		}
+		process.IncFinishedCount();
+	});
 	process.Finished();
 
+	//store where the data of unchanged nodes is located, so that reading them does not need to walk the snapshot chain
+	if(!this->snapshots.IsEmpty())
+	{
+		snapshot->Previous(this->snapshots.Last().operator->());
+		snapshot->SnapshotsByName(&this->snapshotsByName);
+		snapshot->RecordDataLocations();
+	}
+
 	WriteProtectFile(ic.Config().dataPath);
 
 	UnprotectFile(ic.Config().indexPath);
@@ -79,79 +180,204 @@ bool SnapshotManager::AddSnapshot(const OSFileSystemNodeIndex& sourceIndex)
 	snapshot->WriteProtect();
 	WriteProtectFile(ic.Config().indexPath);
 
+	ic.ChunkStore().Serialize();
+	ic.ChunkStore().WriteProtect();
+
 	const Config& config = ic.Config();
 	ic.CompressionStats().Write(config.backupPath);
 
 	//close snapshot and read it in again
 	this->snapshots.Release();
+	this->snapshotsByName.Release();
 	snapshot = nullptr;
 
+	ic.ChunkStore().Reload();
 	this->ReadInSnapshots();
 
 	this->EnsureNoDifferenceExists(sourceIndex);
 
-	DynamicArray<uint32> results = this->VerifySnapshot(*this->snapshots.Last(), true); //verify full snapshot to make sure older required snapshots not have gone corrupt
+	DynamicArray<uint32> results = this->VerifySnapshot(*this->snapshots.Last(), true, verificationCoverage); //verify full snapshot to make sure older required snapshots not have gone corrupt
 	
 	return results.IsEmpty();
 }
 
-DynamicArray<uint32> SnapshotManager::VerifySnapshot(const Snapshot &snapshot, bool full) const
+void SnapshotManager::LoadIndexes(const Snapshot& snapshot) const
+{
+	InjectionContainer& ic = InjectionContainer::Instance();
+
+	DynamicArray<const Snapshot*> snapshotsToLoad;
+	for(const Snapshot* current = &snapshot; current; current = current->Previous())
+	{
+		if(!current->IsIndexLoaded())
+			snapshotsToLoad.Push(current);
+	}
+
+	ProcessStatus& process = ic.StatusTracker().AddProcessStatusTracker(u8"Loading snapshot indexes", snapshotsToLoad.GetNumberOfElements(), 0);
+	StaticThreadPool& threadPool = ic.TaskQueue();
+	for(const Snapshot* current : snapshotsToLoad)
+	{
+		//the previous chain is already linked on the handles, so the indexes can be loaded in any order
+		threadPool.EnqueueTask([current, &process]()
+		{
+			current->Index();
+			process.IncFinishedCount();
+		});
+	}
+	threadPool.WaitForAllTasksToComplete();
+	process.Finished();
+}
+
+void SnapshotManager::ReleaseIndexesOverBudget(const Snapshot& inUse) const
+{
+	const uint64 budget = InjectionContainer::Instance().Config().indexMemoryBudget;
+	if(budget == 0)
+		return;
+
+	uint64 usage = 0;
+	BinaryTreeMap<uint64, const Snapshot*> releasable; //ordered by last use
+	for(const auto& snapshot : this->snapshots)
+	{
+		if(!snapshot->IsIndexLoaded())
+			continue;
+
+		usage += snapshot->EstimateIndexMemoryUsage();
+		if((snapshot.operator->() != &inUse) and (snapshot.operator->() != &this->NewestSnapshot()))
+			releasable.Insert(snapshot->LastUseTick(), snapshot.operator->());
+	}
+	if(usage <= budget)
+		return;
+
+	for(const auto& kv : releasable)
+	{
+		if(usage <= budget)
+			break;
+
+		usage -= kv.value->EstimateIndexMemoryUsage();
+		kv.value->ReleaseIndex();
+	}
+}
+
+DynamicArray<uint32> SnapshotManager::VerifySnapshot(const Snapshot &snapshot, bool full, VerificationCoverage& coverage) const
 {
+	struct DataToVerify
+	{
+		DataIdentifier identifier;
+		const Snapshot* dataSnapshot;
+		uint32 dataNodeIndex;
+		uint64 size;
+		DynamicArray<uint32> nodeIndices;
+	};
+
 	InjectionContainer& ic = InjectionContainer::Instance();
+	const Config& config = ic.Config();
+	StaticThreadPool& threadPool = ic.TaskQueue();
+
+	const BackupNodeIndex& index = snapshot.Index();
+	const uint32 nNodes = index.GetNumberOfNodes();
+
+	//find out where the data of the nodes is stored. This loads the indexes of older snapshots, so it is done in parallel
+	FixedArray<const Snapshot*> dataSnapshots(nNodes);
+	FixedArray<uint32> dataNodeIndices(nNodes);
+	ParallelFor(threadPool, ic.NumberOfWorkers(), nNodes, [&index, &snapshot, &dataSnapshots, &dataNodeIndices](uint32 i)
+	{
+		if(index.GetNodeAttributes(i).Type() == FileType::Directory)
+			dataSnapshots[i] = nullptr;
+		else
+			dataSnapshots[i] = snapshot.FindDataSnapshot(i, dataNodeIndices[i]);
+	});
+
+	//nodes that share their data are verified together
+	BinaryTreeMap<DataIdentifier, DataToVerify> data;
+	for(uint32 i = 0; i < nNodes; i++)
+	{
+		if( (dataSnapshots[i] == nullptr) or (!full and (dataSnapshots[i] != &snapshot)) )
+			continue;
 
-	const FileSystemNodeIndex& index = snapshot.Index();
+		const DataIdentifier identifier = { .snapshotName = dataSnapshots[i]->Name(), .nodeIndex = dataNodeIndices[i] };
+		if(!data.Contains(identifier))
+			data.Insert(identifier, { .identifier = identifier, .dataSnapshot = dataSnapshots[i], .dataNodeIndex = dataNodeIndices[i], .size = index.GetNodeAttributes(i).Size() });
+		data[identifier].nodeIndices.Push(i);
+	}
+
+	//new data is always verified, older data only in part
+	VerificationLedger ledger(config.backupPath);
+	BinaryTreeSet<DataIdentifier> olderData;
+	DynamicArray<const DataToVerify*> dataToVerify;
+	for(const auto& kv : data)
+	{
+		if(kv.value.dataSnapshot == &snapshot)
+			dataToVerify.Push(&kv.value);
+		else
+			olderData.Insert(kv.key);
+		coverage.totalSize += kv.value.size;
+	}
+	for(const DataIdentifier& identifier : ledger.SelectData(olderData, full ? config.verificationPercentage : 100))
+		dataToVerify.Push(&data[identifier]);
+
+	coverage.nNodes = data.GetNumberOfElements();
+	coverage.nVerifiedNodes = dataToVerify.GetNumberOfElements();
+	for(const DataToVerify* entry : dataToVerify)
+		coverage.verifiedSize += entry->size;
 
 	ProcessStatus& process = ic.StatusTracker().AddProcessStatusTracker(u8"Verifying snapshot: " + snapshot.Name(),
-			index.GetNumberOfNodes(), full ? index.ComputeTotalSize() : snapshot.ComputeSize());
-	StaticThreadPool& threadPool = InjectionContainer::Instance().TaskQueue();
+			dataToVerify.GetNumberOfElements(), coverage.verifiedSize);
 
 	DynamicArray<uint32> failedNodes;
 	Mutex failedFilesLock;
-	for(uint32 i = 0; i < index.GetNumberOfNodes(); i++)
+	ParallelFor(threadPool, ic.NumberOfWorkers(), dataToVerify.GetNumberOfElements(), [&dataToVerify, &ledger, &process, &failedNodes, &failedFilesLock](uint32 i)
 	{
-		threadPool.EnqueueTask([&snapshot, i, full, &process, &failedNodes, &failedFilesLock]()
+		const DataToVerify* entry = dataToVerify[i];
+
+		bool successful = entry->dataSnapshot->VerifyNode(entry->dataNodeIndex);
+		if(!successful)
 		{
-			const BackupNodeAttributes &nodeAttributes = snapshot.Index().GetNodeAttributes(i);
-			if(nodeAttributes.Type() != FileType::Directory)
-			{
-				Path realNodePath;
-				const Snapshot* dataSnapshot = snapshot.FindDataSnapshot(i, realNodePath);
-				if(full || (dataSnapshot == &snapshot))
-				{
-					if (!dataSnapshot->VerifyNode(realNodePath))
-					{
-						failedFilesLock.Lock();
-						failedNodes.Push(i);
-						failedFilesLock.Unlock();
-					}
-					process.AddFinishedSize(nodeAttributes.Size());
-				}
-			}
-			process.IncFinishedCount();
-		});
-	}
+			failedFilesLock.Lock();
+			for(uint32 nodeIndex : entry->nodeIndices)
+				failedNodes.Push(nodeIndex);
+			failedFilesLock.Unlock();
+		}
+		ledger.RecordVerification(entry->identifier, successful);
 
-	threadPool.WaitForAllTasksToComplete();
+		process.AddFinishedSize(entry->size);
+		process.IncFinishedCount();
+	});
 	process.Finished();
 
+	failedNodes.Sort();
+	ledger.Write();
+
+	this->ReleaseIndexesOverBudget(snapshot);
+
 	return failedNodes;
 }
 
 //Private methods
-NodeIndexDifferences SnapshotManager::ComputeDifference(const OSFileSystemNodeIndex& sourceIndex, bool updateDefault) const
+NodeIndexDifferences SnapshotManager::ComputeDifference(const OSFileSystemNodeIndex& sourceIndex, bool updateDefault, bool hashNewNodes) const
 {
 	if(this->LastIndex())
 	{
 		NodeIndexDifferenceResolver resolver;
-		NodeIndexDifferences difference = resolver.ComputeDiff(*this->LastIndex(), sourceIndex);
+		NodeIndexDifferences difference = resolver.ComputeDiff(*this->LastIndex(), sourceIndex, hashNewNodes);
 
 		if(updateDefault)
 		{
 			//assume all haven't changed and update only metadata for these
+			FixedArray<bool> isDifferent(sourceIndex.GetNumberOfNodes());
+			for(uint32 i = 0; i < sourceIndex.GetNumberOfNodes(); i++)
+				isDifferent[i] = false;
+			for(uint32 index : difference.differentData)
+				isDifferent[index] = true;
+			for(const NodeMove& move : difference.moved)
+				isDifferent[move.rightIndex] = true;
+			for(uint32 index : difference.speculativeData)
+				isDifferent[index] = true;
+
+			//this includes the nodes that already are in differentMetadata and keeps the array sorted
+			difference.differentMetadata.Release();
 			for(uint32 i = 0; i < sourceIndex.GetNumberOfNodes(); i++)
 			{
-				if(!( difference.differentData.Contains(i) || difference.differentMetadata.Contains(i) || difference.moved.Contains(i) ))
-					difference.differentMetadata.Insert(i);
+				if(!isDifferent[i])
+					difference.differentMetadata.Push(i);
 			}
 		}
 		return difference;
@@ -159,8 +385,9 @@ NodeIndexDifferences SnapshotManager::ComputeDifference(const OSFileSystemNodeIn
 
 	//all nodes of sourceIndex need to be backed up
 	NodeIndexDifferences difference{};
+	difference.differentData.EnsureCapacity(sourceIndex.GetNumberOfNodes());
 	for(uint32 i = 0; i < sourceIndex.GetNumberOfNodes(); i++)
-		difference.differentData.Insert(i);
+		difference.differentData.Push(i);
 	return difference;
 }
 
@@ -187,10 +414,12 @@ void SnapshotManager::ReadInSnapshots()
 	auto files = this->ListSnapshotMetadataFiles();
 	for(const auto& entry : files)
 	{
-		//try to deserialize
-		UniquePointer<Snapshot> snapshot = Snapshot::Deserialize(indexPath / entry);
+		//indexes are loaded on first access
+		UniquePointer<Snapshot> snapshot = Snapshot::Open(indexPath / entry);
 		if(!snapshot.IsNull())
 		{
+			this->snapshotsByName.Insert(snapshot->Name(), snapshot.operator->());
+			snapshot->SnapshotsByName(&this->snapshotsByName);
 			this->snapshots.Push(Move(snapshot));
 			if(this->snapshots.GetNumberOfElements() > 1)
 				this->snapshots.Last()->Previous(this->snapshots[this->snapshots.GetNumberOfElements()-2].operator->());
@@ -200,7 +429,7 @@ void SnapshotManager::ReadInSnapshots()
 
 void SnapshotManager::EnsureNoDifferenceExists(const OSFileSystemNodeIndex &sourceIndex) const
 {
-	const NodeIndexDifferences diffNodeIndicesNew = this->ComputeDifference(sourceIndex, false);
+	const NodeIndexDifferences diffNodeIndicesNew = this->ComputeDifference(sourceIndex, false, true);
 	if(diffNodeIndicesNew.Exist())
 		throw ErrorHandling::VerificationFailedException();
 }
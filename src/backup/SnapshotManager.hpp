@@ -23,6 +23,7 @@ using namespace StdXX;
 #include "../indexing/FileSystemNodeIndex.hpp"
 #include "Snapshot.hpp"
 #include "../NodeIndexDifferenceResolver.hpp"
+#include "VerificationLedger.hpp"
 
 class SnapshotManager
 {
@@ -31,23 +32,45 @@ public:
 	SnapshotManager();
 
 	//Properties
+	/**
+	 * Size of the new nodes of the last AddSnapshot call that were ruled out as copies of nodes of the newest snapshot
+	 * without hashing them.
+	 */
+	inline uint64 AvoidedHashingSize() const
+	{
+		return this->avoidedHashingSize;
+	}
+
 	inline const DynamicArray<UniquePointer<Snapshot>>& Snapshots() const
 	{
 		return this->snapshots;
 	}
 
 	//Methods
-	bool AddSnapshot(const OSFileSystemNodeIndex& sourceIndex);
-	DynamicArray<uint32> VerifySnapshot(const Snapshot& snapshot, bool full) const;
+	bool AddSnapshot(const OSFileSystemNodeIndex& sourceIndex, VerificationCoverage& verificationCoverage);
+	/**
+	 * Loads the indexes of snapshot and of all its predecessors concurrently on the task queue.
+	 * Use this when the whole chain is needed anyway, instead of loading the indexes one after another on first access.
+	 */
+	void LoadIndexes(const Snapshot& snapshot) const;
+	/**
+	 * Releases the indexes of the least recently used snapshots until all loaded indexes fit into the configured memory
+	 * budget. The indexes of the newest snapshot and of inUse are kept.
+	 * Must only be called when no references into the indexes of other snapshots are held.
+	 */
+	void ReleaseIndexesOverBudget(const Snapshot& inUse) const;
+	/**
+	 * Verifies the nodes whose data was written in this snapshot.
+	 * If full is set, nodes whose data is stored in older snapshots are verified as well, but only if the verification
+	 * ledger selects their data for reverification.
+	 */
+	DynamicArray<uint32> VerifySnapshot(const Snapshot& snapshot, bool full, VerificationCoverage& coverage) const;
 
 	//Inline
 	inline const Snapshot* FindSnapshot(const String& name) const
 	{
-		for(const auto& snapshot : this->snapshots)
-		{
-			if(snapshot->Name() == name)
-				return snapshot.operator->();
-		}
+		if(this->snapshotsByName.Contains(name))
+			return this->snapshotsByName[name];
 		return nullptr;
 	}
 
@@ -58,10 +81,12 @@ public:
 
 private:
 	//Members
+	uint64 avoidedHashingSize;
 	DynamicArray<UniquePointer<Snapshot>> snapshots;
+	BinaryTreeMap<String, const Snapshot*> snapshotsByName;
 
 	//Methods
-	NodeIndexDifferences ComputeDifference(const OSFileSystemNodeIndex& sourceIndex, bool updateDefault) const;
+	NodeIndexDifferences ComputeDifference(const OSFileSystemNodeIndex& sourceIndex, bool updateDefault, bool hashNewNodes) const;
 	void EnsureNoDifferenceExists(const OSFileSystemNodeIndex& sourceIndex) const;
 	DynamicArray<String> ListSnapshotMetadataFiles();
 	void ReadInSnapshots();
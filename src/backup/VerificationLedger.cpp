@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "VerificationLedger.hpp"
+
+//Constructor
+VerificationLedger::VerificationLedger(const Path& dirPath) : dirPath(dirPath)
+{
+	File file(dirPath / this->c_ledgerFileName);
+	if(!file.Exists())
+		return; //nothing was verified yet
+
+	FileInputStream fileInputStream(file.Path());
+	BufferedInputStream bufferedInputStream(fileInputStream);
+	TextReader textReader(bufferedInputStream, TextCodecType::UTF8);
+	CommonFileFormats::CSVReader csvReader(textReader, CommonFileFormats::csvDialect_excel);
+
+	//skip first line
+	String cell;
+	for(uint8 i = 0; i < 4; i++)
+		csvReader.ReadCell(cell);
+
+	//read lines
+	String snapshotName, nodeIndex, result;
+	while(!textReader.IsAtEnd())
+	{
+		DataVerification verification;
+
+		csvReader.ReadCell(snapshotName);
+		csvReader.ReadCell(nodeIndex);
+		csvReader.ReadCell(verification.lastVerificationTime);
+		csvReader.ReadCell(result);
+		verification.successful = result == u8"ok";
+
+		this->data.Insert({ .snapshotName = snapshotName, .nodeIndex = nodeIndex.ToUInt32() }, verification);
+	}
+}
+
+//Public methods
+void VerificationLedger::RecordVerification(const DataIdentifier& data, bool successful)
+{
+	AutoLock lock(this->dataLock);
+
+	DataVerification& verification = this->data[data];
+	verification.lastVerificationTime = DateTime::Now().ToISOString();
+	verification.successful = successful;
+}
+
+BinaryTreeSet<DataIdentifier> VerificationLedger::SelectData(const BinaryTreeSet<DataIdentifier>& data, uint8 percentage) const
+{
+	BinaryTreeSet<DataIdentifier> selected;
+	BinaryTreeMap<String, DynamicArray<DataIdentifier>> verifiedData; //ordered by verification time
+	uint32 nVerified = 0;
+
+	for(const DataIdentifier& identifier : data)
+	{
+		if(this->data.Contains(identifier))
+		{
+			const DataVerification& verification = this->data[identifier];
+			if(verification.successful)
+			{
+				verifiedData[verification.lastVerificationTime].Push(identifier);
+				nVerified++;
+				continue;
+			}
+		}
+
+		selected.Insert(identifier);
+	}
+
+	uint32 nToReverify = (nVerified * percentage + 99) / 100;
+	for(const auto& kv : verifiedData)
+	{
+		for(const DataIdentifier& identifier : kv.value)
+		{
+			if(nToReverify == 0)
+				return selected;
+			selected.Insert(identifier);
+			nToReverify--;
+		}
+	}
+
+	return selected;
+}
+
+void VerificationLedger::Write() const
+{
+	FileOutputStream fileOutputStream(this->dirPath / this->c_ledgerFileName, true);
+	BufferedOutputStream bufferedOutputStream(fileOutputStream);
+	CommonFileFormats::CSVWriter csvWriter(bufferedOutputStream, CommonFileFormats::csvDialect_excel);
+
+	csvWriter << u8"Snapshot" << u8"Node" << u8"Last verification" << u8"Result" << endl;
+	for(const auto& kv : this->data)
+	{
+		csvWriter.WriteCell(kv.key.snapshotName);
+		csvWriter.WriteCell(String::Number(kv.key.nodeIndex));
+		csvWriter.WriteCell(kv.value.lastVerificationTime);
+		csvWriter.WriteCell(kv.value.successful ? u8"ok" : u8"failed");
+		csvWriter.TerminateRow();
+	}
+
+	bufferedOutputStream.Flush();
+}
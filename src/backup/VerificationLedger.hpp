@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+using namespace StdXX::FileSystem;
+
+/**
+ * The data of a node, identified by the snapshot that stores it and the index of the node in that snapshot.
+ * Verifying the node reads all of its data, including the chunks it references.
+ */
+struct DataIdentifier
+{
+	String snapshotName;
+	uint32 nodeIndex;
+
+	//Operators
+	inline bool operator<(const DataIdentifier& other) const
+	{
+		if(this->snapshotName == other.snapshotName)
+			return this->nodeIndex < other.nodeIndex;
+		return this->snapshotName < other.snapshotName;
+	}
+
+	inline bool operator==(const DataIdentifier& other) const
+	{
+		return (this->snapshotName == other.snapshotName) and (this->nodeIndex == other.nodeIndex);
+	}
+};
+
+struct DataVerification
+{
+	String lastVerificationTime; //ISO format, so that it can be compared lexicographically
+	bool successful;
+};
+
+struct VerificationCoverage
+{
+	uint32 nVerifiedNodes = 0;
+	uint32 nNodes = 0;
+	uint64 verifiedSize = 0;
+	uint64 totalSize = 0;
+};
+
+/**
+ * Persists when the data of the nodes of the backup was verified the last time and with which result.
+ * Coverage is tracked per node and not per volume, as a volume also holds data of nodes that were not read.
+ */
+class VerificationLedger
+{
+public:
+	//Constructor
+	explicit VerificationLedger(const Path& dirPath);
+
+	//Methods
+	void RecordVerification(const DataIdentifier& data, bool successful);
+	/**
+	 * Selects the data that is verified again.
+	 * This is all data that was never verified or whose last verification failed plus the given percentage of the
+	 * remaining data, starting with the data that was verified least recently.
+	 */
+	BinaryTreeSet<DataIdentifier> SelectData(const BinaryTreeSet<DataIdentifier>& data, uint8 percentage) const;
+	void Write() const;
+
+private:
+	//Constants
+	const String c_ledgerFileName = u8"verification_ledger.csv";
+
+	//Members
+	Path dirPath;
+	BinaryTreeMap<DataIdentifier, DataVerification> data;
+	Mutex dataLock;
+};
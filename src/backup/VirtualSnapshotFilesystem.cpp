@@ -22,28 +22,16 @@
 //Public methods
 UniquePointer<DirectoryEnumerator> VirtualSnapshotFilesystem::EnumerateChildren(const Path &path) const
 {
-	if(!this->snapshot.Index().HasNodeIndex(path))
+	const BackupNodeIndex& index = this->snapshot.Index();
+	uint32 nodeIndex = index.FindNodeIndex(path);
+	if(nodeIndex == Unsigned<uint32>::Max())
 		return nullptr;
 
-	uint32 nodeIndex = this->snapshot.Index().GetNodeIndex(path);
-	DynamicArray<uint32> children;
-
-	auto& index = this->snapshot.Index();
-	for(uint32 i = 0; i < index.GetNumberOfNodes(); i++)
-	{
-		if(i == nodeIndex)
-			continue;
-
-		const auto& nodePath = index.GetNodePath(i);
-		if(nodePath.GetParent() == path)
-			children.Push(i);
-	}
-
 	class VirtualDirectoryEnumerator : public DirectoryEnumerator
 	{
 	public:
 		//Constructor
-		inline VirtualDirectoryEnumerator(DynamicArray<uint32>&& children, const BackupNodeIndex& index) : children(Move(children)), index(index)
+		inline VirtualDirectoryEnumerator(const DynamicArray<uint32>& children, const BackupNodeIndex& index) : children(children), index(index)
 		{
 			this->currentIndex = -1;
 		}
@@ -61,7 +49,7 @@ UniquePointer<DirectoryEnumerator> VirtualSnapshotFilesystem::EnumerateChildren(
 				this->currentIndex++;
 				uint32 nodeIndex = this->children[this->currentIndex];
 				this->directoryEntry.type = this->index.GetNodeAttributes(nodeIndex).Type();
-				this->directoryEntry.name = this->index.GetNodePath(nodeIndex).GetName();
+				this->directoryEntry.name = this->index.GetNodeName(nodeIndex);
 				return true;
 			}
 			return false;
@@ -69,42 +57,54 @@ UniquePointer<DirectoryEnumerator> VirtualSnapshotFilesystem::EnumerateChildren(
 
 	private:
 		//Members
-		DynamicArray<uint32> children;
+		const DynamicArray<uint32>& children;
 		const BackupNodeIndex& index;
 		int32 currentIndex;
 		DirectoryEntry directoryEntry;
 	};
 
-	return new VirtualDirectoryEnumerator(Move(children), index);
+	return new VirtualDirectoryEnumerator(index.ChildrenOf(nodeIndex), index);
 }
 
 UniquePointer<InputStream> VirtualSnapshotFilesystem::OpenFileForReading(const Path &path, bool verify) const
 {
-	if(!this->snapshot.Index().HasNodeIndex(path))
+	uint32 nodeIndex = this->snapshot.Index().FindNodeIndex(path);
+	if(nodeIndex == Unsigned<uint32>::Max())
 		return nullptr;
 
-	uint32 nodeIndex = this->snapshot.Index().GetNodeIndex(path);
-	Path snapshotPath;
-	const Snapshot* dataSnapshot = this->snapshot.FindDataSnapshot(nodeIndex, snapshotPath);
+	uint32 dataNodeIndex;
+	const Snapshot* dataSnapshot = this->snapshot.FindDataSnapshot(nodeIndex, dataNodeIndex);
 
-	return dataSnapshot->Filesystem().OpenFileForReading(snapshotPath, true);
+	return dataSnapshot->Filesystem().OpenFileForReading(dataNodeIndex, true);
 }
 
 Optional<FileInfo> VirtualSnapshotFilesystem::QueryFileInfo(const Path &path) const
 {
-	if(!this->snapshot.Index().HasNodeIndex(path))
+	uint32 nodeIndex = this->snapshot.Index().FindNodeIndex(path);
+	if(nodeIndex == Unsigned<uint32>::Max())
 		return {};
 
-	uint32 nodeIndex = this->snapshot.Index().GetNodeIndex(path);
-
 	const BackupNodeAttributes& attributes = this->snapshot.Index().GetNodeAttributes(nodeIndex);
 
+	//stat is called for every entry of every listed directory, don't sum up the blocks each time
+	AutoLock lock(this->fileInfoCacheLock);
+	if(!this->fileInfoCache.Contains(nodeIndex))
+	{
+		CachedFileInfo cachedFileInfo;
+		cachedFileInfo.type = attributes.Type();
+		cachedFileInfo.size = attributes.Size();
+		cachedFileInfo.storedSize = attributes.ComputeSumOfBlockSizes();
+		cachedFileInfo.lastModifiedTime = attributes.LastModifiedTime();
+		this->fileInfoCache.Insert(nodeIndex, cachedFileInfo);
+	}
+	const CachedFileInfo& cachedFileInfo = this->fileInfoCache[nodeIndex];
+
 	FileInfo fileInfo;
-	fileInfo.type = attributes.Type();
-	fileInfo.size = attributes.Size();
-	fileInfo.lastModifiedTime = attributes.LastModifiedTime();
+	fileInfo.type = cachedFileInfo.type;
+	fileInfo.size = cachedFileInfo.size;
+	fileInfo.lastModifiedTime = cachedFileInfo.lastModifiedTime;
 	fileInfo.permissions = attributes.Permissions().Clone();
-	fileInfo.storedSize = attributes.ComputeSumOfBlockSizes();
+	fileInfo.storedSize = cachedFileInfo.storedSize;
 
 	return fileInfo;
 }
@@ -40,6 +40,16 @@ public:
 	//TODO: NOT IMPLEMENTED
 
 private:
+	struct CachedFileInfo
+	{
+		FileType type;
+		uint64 size;
+		uint64 storedSize;
+		Optional<DateTime> lastModifiedTime;
+	};
+
 	//Members
 	const Snapshot& snapshot;
+	mutable BinaryTreeMap<uint32, CachedFileInfo> fileInfoCache;
+	mutable Mutex fileInfoCacheLock;
 };
\ No newline at end of file
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "ChunkedInputStream.hpp"
+//Local
+#include "../backup/ChunkStore.hpp"
+
+//Public methods
+uint32 ChunkedInputStream::GetBytesAvailable() const
+{
+	if(this->currentChunk.IsNull())
+		return 0;
+	return this->currentChunk->GetBytesAvailable();
+}
+
+bool ChunkedInputStream::IsAtEnd() const
+{
+	if(this->nextChunkIndex < this->chunks.GetNumberOfElements())
+		return false;
+	return this->currentChunk.IsNull() or this->currentChunk->IsAtEnd();
+}
+
+uint32 ChunkedInputStream::ReadBytes(void *destination, uint32 count)
+{
+	uint8* dest = static_cast<uint8 *>(destination);
+
+	while(count and this->OpenNextChunkIfRequired())
+	{
+		uint32 nBytesRead = this->currentChunk->ReadBytes(dest, count);
+
+		dest += nBytesRead;
+		count -= nBytesRead;
+	}
+
+	return dest - static_cast<uint8 *>(destination);
+}
+
+uint32 ChunkedInputStream::Skip(uint32 nBytes)
+{
+	uint32 nBytesSkipped = 0;
+	while(nBytes and this->OpenNextChunkIfRequired())
+	{
+		uint32 nSkipped = this->currentChunk->Skip(nBytes);
+
+		nBytesSkipped += nSkipped;
+		nBytes -= nSkipped;
+	}
+
+	return nBytesSkipped;
+}
+
+//Private methods
+bool ChunkedInputStream::OpenNextChunkIfRequired()
+{
+	while(this->currentChunk.IsNull() or this->currentChunk->IsAtEnd())
+	{
+		if(this->nextChunkIndex >= this->chunks.GetNumberOfElements())
+			return false;
+
+		const ChunkReference& chunkReference = this->chunks[this->nextChunkIndex++];
+		this->currentChunk = this->chunkStore.OpenChunk(chunkReference.hash, this->verify);
+	}
+	return true;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXX.hpp>
+using namespace StdXX;
+//Local
+#include "../backup/BackupNodeAttributes.hpp"
+
+//Forward declarations
+class ChunkStore;
+
+/**
+ * Reads the data of a node that was backed up in chunking mode by concatenating its chunks from the chunk store.
+ */
+class ChunkedInputStream : public InputStream
+{
+public:
+	//Constructor
+	inline ChunkedInputStream(const ChunkStore& chunkStore, const DynamicArray<ChunkReference>& chunks, bool verify)
+		: chunkStore(chunkStore), chunks(chunks), verify(verify)
+	{
+		this->nextChunkIndex = 0;
+	}
+
+	//Methods
+	uint32 GetBytesAvailable() const override;
+	bool IsAtEnd() const override;
+	uint32 ReadBytes(void *destination, uint32 count) override;
+	uint32 Skip(uint32 nBytes) override;
+
+private:
+	//Members
+	const ChunkStore& chunkStore;
+	const DynamicArray<ChunkReference>& chunks;
+	bool verify;
+	uint32 nextChunkIndex;
+	UniquePointer<InputStream> currentChunk;
+
+	//Methods
+	bool OpenNextChunkIfRequired();
+};
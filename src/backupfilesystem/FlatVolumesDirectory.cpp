@@ -47,7 +47,7 @@ public:
 		const auto& children = this->index.ChildrenOf(this->directoryIndex);
 		uint32 childIndex = children[this->currentChildIndex];
 
-		return this->index.GetNodePath(childIndex).GetName();
+		return this->index.GetNodeName(childIndex);
 	}
 
 	void Next() override
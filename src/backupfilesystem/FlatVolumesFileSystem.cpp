@@ -18,6 +18,10 @@
  */
 //Class header
 #include "FlatVolumesFileSystem.hpp"
+//Global
+#ifdef XPC_OS_LINUX
+#include <unistd.h>
+#endif
 //Local
 #include "VolumesOutputStream.hpp"
 #include "../InjectionContainer.hpp"
@@ -27,6 +31,10 @@
 #include "FlatVolumesDirectory.hpp"
 #include "FlatVolumesLink.hpp"
 #include "FlatVolumesBlockInputStream.hpp"
+#include "ChunkedInputStream.hpp"
+#include "SliceInputStream.hpp"
+#include "FramedInputStream.hpp"
+#include "../backup/ChunkStore.hpp"
 
 //Constructor
 FlatVolumesFileSystem::FlatVolumesFileSystem(const Path &dirPath, BackupNodeIndex& index)
@@ -36,30 +44,51 @@ FlatVolumesFileSystem::FlatVolumesFileSystem(const Path &dirPath, BackupNodeInde
 	this->writing.nextVolumeNumber = 0;
 
 	//count volumes
-	BinaryTreeSet<uint64> volumes;
+	uint64 nVolumes = 0;
 	for(uint32 i = 0; i < index.GetNumberOfNodes(); i++)
 	{
 		const BackupNodeAttributes& attributes = index.GetNodeAttributes(i);
 		for(const Block& block : attributes.Blocks())
-			volumes.Insert(block.volumeNumber);
+			nVolumes = Math::Max(nVolumes, block.volumeNumber + 1);
 	}
 
-	this->reading.volumes = new FixedArray<VolumeForReading>(volumes.GetNumberOfElements());
+	this->reading.volumes = new FixedArray<VolumeForReading>(nVolumes);
 	this->reading.nOpenVolumes = 0;
 }
 
 //Public methods
-void FlatVolumesFileSystem::CloseFile(const VolumesOutputStream& outputStream)
+UniquePointer<FlatVolumesFileSystem::OpenVolumeForWriting> FlatVolumesFileSystem::AcquireVolume()
 {
-	AutoLock lock(this->writing.openVolumesMutex);
-	for(OpenVolumeForWriting& openVolume : this->writing.openVolumes)
+	AutoLock lock(this->writing.freeVolumesMutex);
+
+	if(!this->writing.freeVolumes.IsEmpty())
+		return this->writing.freeVolumes.Pop();
+
+	if(!this->writing.createdDataDir)
 	{
-		if(openVolume.ownedWriter == &outputStream)
+		File dir(this->dirPath);
+		if(dir.Exists())
 		{
-			openVolume.ownedWriter = nullptr;
-			break;
+			//a file system that is written to over several runs (i.e. the chunk store) must not overwrite existing volumes
+			for(const DirectoryEntry& entry : dir)
+				this->writing.nextVolumeNumber = Math::Max(this->writing.nextVolumeNumber, entry.name.ToUInt64() + 1);
 		}
+		else
+			dir.CreateDirectory();
+		this->writing.createdDataDir = true;
 	}
+
+	UniquePointer<OpenVolumeForWriting> volume = new OpenVolumeForWriting;
+	volume->number = this->writing.nextVolumeNumber++;
+	volume->file = new FileOutputStream(this->dirPath / String::Number(volume->number));
+	volume->leftSize = InjectionContainer::Instance().Config().volumeSize;
+
+	return volume;
+}
+
+void FlatVolumesFileSystem::CommitBlocks(const Path& filePath, const DynamicArray<Block>& blocks)
+{
+	this->index.AddBlocks(filePath, blocks);
 }
 
 UniquePointer<OutputStream> FlatVolumesFileSystem::CreateFile(const Path &filePath)
@@ -72,6 +101,21 @@ void FlatVolumesFileSystem::CreateLink(const Path &linkPath, const Path &linkTar
 	NOT_IMPLEMENTED_ERROR; //implement me
 }
 
+void FlatVolumesFileSystem::DiscardFile(OutputStream& writer, const Path& filePath)
+{
+	VolumesOutputStream& volumesOutputStream = static_cast<VolumesOutputStream&>(writer);
+	if(!this->index.HasNodeIndex(filePath))
+	{
+		//the file was never added to the index, only the writer knows its blocks
+		volumesOutputStream.DiscardUncommittedBlocks();
+		return;
+	}
+
+	volumesOutputStream.Flush(); //commit all blocks, so that the index knows all of them
+	DynamicArray<Block> blocks = this->index.RemoveBlocks(filePath);
+	volumesOutputStream.ReclaimSpace(blocks);
+}
+
 void FlatVolumesFileSystem::Flush()
 {
 	NOT_IMPLEMENTED_ERROR; //implement me
@@ -106,27 +150,48 @@ void FlatVolumesFileSystem::Move(const Path &from, const Path &to)
 UniquePointer<InputStream> FlatVolumesFileSystem::OpenFileForReading(uint32 fileIndex, bool verify) const
 {
 	const BackupNodeAttributes& attributes = this->index.GetNodeAttributes(fileIndex);
-	this->IncrementVolumeCounters(attributes.Blocks());
 
-	UniquePointer<InputStream> blockInputStream = new FlatVolumesBlockInputStream(*this, attributes.Blocks());
-
-	ChainedInputStream* chain = new ChainedInputStream(StdXX::Move(blockInputStream));
+	//the data of members of a solid group is stored in the blocks of the leader
+	const BackupNodeAttributes& dataAttributes = attributes.SolidGroup().HasValue() ? this->index.GetNodeAttributes(attributes.SolidGroup()->leaderNodeIndex) : attributes;
 
 	const Config &config = InjectionContainer::Instance().Config();
 
-	chain->Add( new BufferedInputStream(chain->GetEnd()) );
-
-	if(attributes.CompressionSetting().HasValue())
+	ChainedInputStream* chain;
+	if(dataAttributes.Frames().HasValue())
 	{
-		CompressionSettings compressionSettings;
-		ConfigManager::GetCompressionSettings(*attributes.CompressionSetting(), compressionSettings);
-		chain->Add(Decompressor::Create(compressionSettings.compressionStreamFormatType, chain->GetEnd(), verify));
+		//every frame is decompressed on its own
+		chain = new ChainedInputStream(new FramedInputStream(*this, dataAttributes, verify));
 	}
+	else
+	{
+		UniquePointer<InputStream> blockInputStream;
+		if(dataAttributes.Chunks().IsEmpty())
+		{
+			this->IncrementVolumeCounters(dataAttributes.Blocks());
+			blockInputStream = new FlatVolumesBlockInputStream(*this, dataAttributes.Blocks());
+		}
+		else
+			blockInputStream = new ChunkedInputStream(InjectionContainer::Instance().ChunkStore(), dataAttributes.Chunks(), verify);
+
+		chain = new ChainedInputStream(StdXX::Move(blockInputStream));
+
+		chain->Add( new BufferedInputStream(chain->GetEnd()) );
+
+		if(dataAttributes.CompressionSetting().HasValue())
+		{
+			CompressionSettings compressionSettings;
+			ConfigManager::GetCompressionSettings(*dataAttributes.CompressionSetting(), compressionSettings);
+			chain->Add(Decompressor::Create(compressionSettings.compressionStreamFormatType, chain->GetEnd(), verify));
+		}
+	}
+
+	if(attributes.SolidGroup().HasValue())
+		chain->Add(new SliceInputStream(chain->GetEnd(), attributes.SolidGroup()->offset, attributes.Size()));
 
 	if(verify)
 	{
 		Crypto::HashAlgorithm hashAlgorithm = config.hashAlgorithm;
-		String expected = attributes.Hash(hashAlgorithm);
+		String expected = attributes.Hash(hashAlgorithm).ToHexString();
 		chain->Add(new Crypto::CheckedHashingInputStream(chain->GetEnd(), hashAlgorithm, expected));
 	}
 
@@ -164,27 +229,37 @@ uint32 FlatVolumesFileSystem::ReadBytes(const FlatVolumesBlockInputStream &reade
 	return dest - static_cast<uint8 *>(destination);
 }
 
-void FlatVolumesFileSystem::WriteBytes(const VolumesOutputStream& writer, const void *source, uint32 size)
+void FlatVolumesFileSystem::ReleaseVolume(UniquePointer<OpenVolumeForWriting>&& volume)
 {
-	const uint8* src = static_cast<const uint8 *>(source);
-	while(size)
+	if(volume->leftSize == 0)
 	{
-		uint64 leftSize;
-		SeekableOutputStream& outputStream = this->FindStream(&writer, leftSize);
+		volume = nullptr; //closes the file
+		return;
+	}
 
-		uint32 bytesToWrite = Math::Min( (uint32)leftSize, (uint32)size );
-		uint64 offset = outputStream.QueryCurrentOffset();
-		uint32 nBytesWritten = outputStream.WriteBytes(src, bytesToWrite);
+	AutoLock lock(this->writing.freeVolumesMutex);
+	this->writing.freeVolumes.Push(StdXX::Move(volume));
+}
 
-		src += nBytesWritten;
-		size -= nBytesWritten;
-		this->BytesWereWrittenToVolume(&writer, offset, nBytesWritten);
-	}
+void FlatVolumesFileSystem::TruncateVolume(OpenVolumeForWriting& volume, uint64 size)
+{
+	volume.file->Flush();
+	volume.file->SeekTo(size);
+
+#ifdef XPC_OS_LINUX
+	String volumePath = (this->dirPath / String::Number(volume.number)).String().ToUTF8();
+	if(truncate(reinterpret_cast<const char*>(volumePath.GetRawZeroTerminatedData()), size) == 0)
+		return;
+#endif
+	//otherwise the data behind size stays in the volume file until it is overwritten by following writes. No block refers to it
 }
 
 void FlatVolumesFileSystem::WriteProtect()
 {
-	this->writing.openVolumes.Release(); //close open files
+	{
+		AutoLock lock(this->writing.freeVolumesMutex);
+		this->writing.freeVolumes.Release(); //close open files
+	}
 
 	File dir(this->dirPath);
 
@@ -206,25 +281,6 @@ SpaceInfo FlatVolumesFileSystem::QuerySpace() const
 }
 
 //Private methods
-void FlatVolumesFileSystem::BytesWereWrittenToVolume(const VolumesOutputStream* writer, uint64 offset, uint32 nBytesWritten)
-{
-	AutoLock lock(this->writing.openVolumesMutex);
-
-	auto it = this->writing.openVolumes.begin();
-	while(it != this->writing.openVolumes.end())
-	{
-		if((*it).ownedWriter == writer)
-		{
-			this->index.AddBlock(writer->Path(), (*it).number, offset, nBytesWritten);
-			(*it).leftSize -= nBytesWritten;
-			if((*it).leftSize == 0)
-				it.Remove();
-			break;
-		}
-		++it;
-	}
-}
-
 void FlatVolumesFileSystem::CloseUnusedVolumes() const
 {
 	AutoLock lock(this->reading.nOpenVolumesLock);
@@ -243,51 +299,6 @@ void FlatVolumesFileSystem::CloseUnusedVolumes() const
 	}
 }
 
-SeekableOutputStream &FlatVolumesFileSystem::FindStream(const OutputStream *writer, uint64 &leftSize)
-{
-	AutoLock lock(this->writing.openVolumesMutex);
-
-	OpenVolumeForWriting* free = nullptr;
-	for(OpenVolumeForWriting& openVolume : this->writing.openVolumes)
-	{
-		if(openVolume.ownedWriter == writer)
-		{
-			leftSize = openVolume.leftSize;
-			return *openVolume.file;
-		}
-		if(openVolume.ownedWriter == nullptr)
-			free = &openVolume;
-	}
-
-	if(free)
-	{
-		free->ownedWriter = writer;
-
-		leftSize = free->leftSize;
-		return *free->file;
-	}
-
-	if(!this->writing.createdDataDir)
-	{
-		File dir(this->dirPath);
-		dir.CreateDirectory();
-		this->writing.createdDataDir = true;
-	}
-
-	OpenVolumeForWriting newVolume;
-	newVolume.number = this->writing.nextVolumeNumber++;
-	newVolume.file = new FileOutputStream(this->dirPath / String::Number(newVolume.number));
-	newVolume.ownedWriter = writer;
-	newVolume.leftSize = InjectionContainer::Instance().Config().volumeSize;
-
-	leftSize = newVolume.leftSize;
-	SeekableOutputStream& result = *newVolume.file;
-
-	this->writing.openVolumes.InsertTail(StdXX::Move(newVolume));
-
-	return result;
-}
-
 void FlatVolumesFileSystem::IncrementVolumeCounters(const DynamicArray<Block> &blocks) const
 {
 	for(const Block& b : blocks)
@@ -25,7 +25,6 @@ using namespace StdXX::FileSystem;
 
 //Forward declarations
 class FlatVolumesBlockInputStream;
-class VolumesOutputStream;
 
 class FlatVolumesFileSystem : public RWFileSystem
 {
@@ -36,28 +35,49 @@ class FlatVolumesFileSystem : public RWFileSystem
 		Mutex mutex;
 	};
 
+public:
+	/**
+	 * A volume that is being filled. It is owned by exactly one writer at a time, so writing to it needs no lock.
+	 */
 	struct OpenVolumeForWriting
 	{
 		uint64 number;
 		UniquePointer<FileOutputStream> file;
 		uint64 leftSize;
-		const OutputStream* ownedWriter;
 	};
-public:
+
 	//Constructor
 	FlatVolumesFileSystem(const Path &dirPath, BackupNodeIndex& index);
 
 	//Methods
-	void CloseFile(const VolumesOutputStream& writer);
+	/**
+	 * Hands out a volume that is not full for exclusive use, creating a new one if no such volume is free.
+	 */
+	UniquePointer<OpenVolumeForWriting> AcquireVolume();
+	void CommitBlocks(const Path& filePath, const DynamicArray<Block>& blocks);
 	UniquePointer<OutputStream> CreateFile(const Path &filePath) override;
 	void CreateLink(const Path &linkPath, const Path &linkTargetPath) override;
+	/**
+	 * Removes all blocks that were written by writer for the file.
+	 * The space of blocks at the end of the volume that writer still owns is reused for following writes.
+	 * Blocks in volumes that are already full can not be reclaimed and remain as unreferenced data.
+	 */
+	void DiscardFile(OutputStream& writer, const Path& filePath);
 	void Flush() override;
+	void IncrementVolumeCounters(const DynamicArray<Block>& blocks) const;
 	void Move(const Path &from, const Path &to) override;
 	UniquePointer<InputStream> OpenFileForReading(uint32 fileIndex, bool verify) const;
 	UniquePointer<InputStream> OpenFileForReading(const Path &path, bool verify) const override;
 	UniquePointer<InputStream> OpenLinkTargetAsStream(const Path& linkPath, bool verify) const;
 	uint32 ReadBytes(const FlatVolumesBlockInputStream& reader, void *destination, uint64 volumeNumber, uint64 offset, uint32 count) const;
-	void WriteBytes(const VolumesOutputStream& writer, const void* source, uint32 size);
+	/**
+	 * Returns a volume for the next writer. Full volumes are closed instead.
+	 */
+	void ReleaseVolume(UniquePointer<OpenVolumeForWriting>&& volume);
+	/**
+	 * Cuts the volume file off at size and continues writing there.
+	 */
+	void TruncateVolume(OpenVolumeForWriting& volume, uint64 size);
 	void WriteProtect();
 	SpaceInfo QuerySpace() const override;
 
@@ -96,15 +116,12 @@ private:
 	{
 		bool createdDataDir;
 		uint64 nextVolumeNumber;
-		LinkedList<OpenVolumeForWriting> openVolumes;
-		Mutex openVolumesMutex;
+		DynamicArray<UniquePointer<OpenVolumeForWriting>> freeVolumes;
+		Mutex freeVolumesMutex;
 	} writing;
 
 	//Methods
-	void BytesWereWrittenToVolume(const VolumesOutputStream* writer, uint64 offset, uint32 nBytesWritten);
 	void CloseUnusedVolumes() const;
-	SeekableOutputStream& FindStream(const OutputStream* writer, uint64& leftSize);
-	void IncrementVolumeCounters(const DynamicArray<Block>& blocks) const;
 	SeekableInputStream& LockVolumeStream(uint64 volumeNumber) const;
 
 	//Inline
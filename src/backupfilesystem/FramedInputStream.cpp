@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "FramedInputStream.hpp"
+//Local
+#include "FlatVolumesBlockInputStream.hpp"
+#include "../config/ConfigManager.hpp"
+
+//Local functions
+/**
+ * @return the blocks that hold the size bytes at offset of the data that is stored in blocks
+ */
+static DynamicArray<Block> SliceBlocks(const DynamicArray<Block>& blocks, uint64 offset, uint64 size)
+{
+	DynamicArray<Block> slice;
+	for(const Block& block : blocks)
+	{
+		if(size == 0)
+			break;
+		if(offset >= block.size)
+		{
+			offset -= block.size;
+			continue;
+		}
+
+		uint64 sliceSize = Math::Min(block.size - offset, size);
+		slice.Push({ .volumeNumber = block.volumeNumber, .offset = block.offset + offset, .size = sliceSize });
+		offset = 0;
+		size -= sliceSize;
+	}
+
+	return slice;
+}
+
+//Constructor
+FramedInputStream::FramedInputStream(const FlatVolumesFileSystem& fileSystem, const BackupNodeAttributes& attributes, bool verify)
+	: fileSystem(fileSystem), attributes(attributes), verify(verify), nextFrameIndex(0), nextFrameOffset(0), leftSizeInFrame(0)
+{
+	CompressionSettings compressionSettings;
+	ConfigManager::GetCompressionSettings(*attributes.CompressionSetting(), compressionSettings);
+	this->compressionStreamFormatType = compressionSettings.compressionStreamFormatType;
+}
+
+//Public methods
+uint32 FramedInputStream::GetBytesAvailable() const
+{
+	if(this->currentFrame.IsNull())
+		return 0;
+	return Math::Min((uint64)this->currentFrame->GetBytesAvailable(), this->leftSizeInFrame);
+}
+
+bool FramedInputStream::IsAtEnd() const
+{
+	return (this->leftSizeInFrame == 0) and (this->nextFrameIndex >= this->attributes.Frames()->compressedSizes.GetNumberOfElements());
+}
+
+uint32 FramedInputStream::ReadBytes(void *destination, uint32 count)
+{
+	uint8* dest = static_cast<uint8 *>(destination);
+
+	while(count and this->OpenNextFrameIfRequired())
+	{
+		uint32 nBytesRead = this->currentFrame->ReadBytes(dest, Math::Min((uint64)count, this->leftSizeInFrame));
+		if(nBytesRead == 0)
+			break;
+
+		dest += nBytesRead;
+		count -= nBytesRead;
+		this->leftSizeInFrame -= nBytesRead;
+	}
+
+	return dest - static_cast<uint8 *>(destination);
+}
+
+uint32 FramedInputStream::Skip(uint32 nBytes)
+{
+	uint32 nBytesSkipped = 0;
+	while(nBytes)
+	{
+		//frames that are skipped completely are never read
+		if( (this->leftSizeInFrame == 0) and (this->nextFrameIndex < this->attributes.Frames()->compressedSizes.GetNumberOfElements()) )
+		{
+			uint64 frameSize = this->GetFrameSize(this->nextFrameIndex);
+			if(frameSize <= nBytes)
+			{
+				this->AdvanceFrame();
+				nBytesSkipped += frameSize;
+				nBytes -= frameSize;
+				continue;
+			}
+		}
+
+		if(!this->OpenNextFrameIfRequired())
+			break;
+
+		uint32 nSkipped = this->currentFrame->Skip(Math::Min((uint64)nBytes, this->leftSizeInFrame));
+		if(nSkipped == 0)
+			break;
+
+		nBytesSkipped += nSkipped;
+		nBytes -= nSkipped;
+		this->leftSizeInFrame -= nSkipped;
+	}
+
+	return nBytesSkipped;
+}
+
+//Private methods
+void FramedInputStream::AdvanceFrame()
+{
+	this->nextFrameOffset += this->attributes.Frames()->compressedSizes[this->nextFrameIndex];
+	this->nextFrameIndex++;
+}
+
+uint64 FramedInputStream::GetFrameSize(uint32 frameIndex) const
+{
+	const FrameTable& frames = *this->attributes.Frames();
+	if(frameIndex + 1 < frames.compressedSizes.GetNumberOfElements())
+		return frames.frameSize;
+	return this->attributes.Size() - uint64(frameIndex) * frames.frameSize;
+}
+
+bool FramedInputStream::OpenNextFrameIfRequired()
+{
+	if(this->leftSizeInFrame)
+		return true;
+	if(this->nextFrameIndex >= this->attributes.Frames()->compressedSizes.GetNumberOfElements())
+		return false;
+
+	uint64 compressedSize = this->attributes.Frames()->compressedSizes[this->nextFrameIndex];
+
+	//the streams of the previous frame still reference its blocks
+	this->currentFrame = nullptr;
+	this->frameBlocks = SliceBlocks(this->attributes.Blocks(), this->nextFrameOffset, compressedSize);
+	this->fileSystem.IncrementVolumeCounters(this->frameBlocks);
+
+	ChainedInputStream* chain = new ChainedInputStream(new FlatVolumesBlockInputStream(this->fileSystem, this->frameBlocks));
+	chain->Add(new BufferedInputStream(chain->GetEnd()));
+	chain->Add(Decompressor::Create(this->compressionStreamFormatType, chain->GetEnd(), this->verify));
+	this->currentFrame = chain;
+
+	this->leftSizeInFrame = this->GetFrameSize(this->nextFrameIndex);
+	this->AdvanceFrame();
+
+	return true;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+//Local
+#include "../backup/BackupNodeAttributes.hpp"
+#include "FlatVolumesFileSystem.hpp"
+
+/**
+ * Reads and decompresses the data of a node that was compressed in frames.
+ * Every frame is opened on its own, so that skipping over whole frames does not need to read or decompress them.
+ */
+class FramedInputStream : public InputStream
+{
+public:
+	//Constructor
+	FramedInputStream(const FlatVolumesFileSystem& fileSystem, const BackupNodeAttributes& attributes, bool verify);
+
+	//Methods
+	uint32 GetBytesAvailable() const override;
+	bool IsAtEnd() const override;
+	uint32 ReadBytes(void *destination, uint32 count) override;
+	uint32 Skip(uint32 nBytes) override;
+
+private:
+	//Members
+	const FlatVolumesFileSystem& fileSystem;
+	const BackupNodeAttributes& attributes;
+	CompressionStreamFormatType compressionStreamFormatType;
+	bool verify;
+	uint32 nextFrameIndex;
+	uint64 nextFrameOffset;
+	uint64 leftSizeInFrame;
+	DynamicArray<Block> frameBlocks;
+	UniquePointer<InputStream> currentFrame;
+
+	//Methods
+	void AdvanceFrame();
+	uint64 GetFrameSize(uint32 frameIndex) const;
+	bool OpenNextFrameIfRequired();
+};
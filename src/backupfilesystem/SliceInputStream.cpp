@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "SliceInputStream.hpp"
+
+//Public methods
+uint32 SliceInputStream::GetBytesAvailable() const
+{
+	if(this->nBytesToSkip)
+		return 0;
+	return Math::Min((uint64)this->inputStream.GetBytesAvailable(), this->leftSize);
+}
+
+bool SliceInputStream::IsAtEnd() const
+{
+	return (this->leftSize == 0) or this->inputStream.IsAtEnd();
+}
+
+uint32 SliceInputStream::ReadBytes(void *destination, uint32 count)
+{
+	if(!this->SkipToSlice())
+		return 0;
+
+	uint32 nBytesRead = this->inputStream.ReadBytes(destination, Math::Min((uint64)count, this->leftSize));
+	this->leftSize -= nBytesRead;
+	return nBytesRead;
+}
+
+uint32 SliceInputStream::Skip(uint32 nBytes)
+{
+	if(!this->SkipToSlice())
+		return 0;
+
+	uint32 nBytesSkipped = this->inputStream.Skip(Math::Min((uint64)nBytes, this->leftSize));
+	this->leftSize -= nBytesSkipped;
+	return nBytesSkipped;
+}
+
+//Private methods
+bool SliceInputStream::SkipToSlice()
+{
+	//the data before the slice is only skipped on the first access, so that opening the stream stays cheap
+	while(this->nBytesToSkip)
+	{
+		uint32 nBytesSkipped = this->inputStream.Skip(Math::Min(this->nBytesToSkip, (uint64)Unsigned<uint32>::Max()));
+		if(nBytesSkipped == 0)
+			return false;
+		this->nBytesToSkip -= nBytesSkipped;
+	}
+	return true;
+}
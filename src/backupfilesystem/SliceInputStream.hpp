@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+
+/**
+ * Reads size bytes of another stream, starting at offset. Used for the members of a solid group, whose data is a slice
+ * of the decompressed stream of the group.
+ */
+class SliceInputStream : public InputStream
+{
+public:
+	//Constructor
+	inline SliceInputStream(InputStream& inputStream, uint64 offset, uint64 size) : inputStream(inputStream), nBytesToSkip(offset), leftSize(size)
+	{
+	}
+
+	//Methods
+	uint32 GetBytesAvailable() const override;
+	bool IsAtEnd() const override;
+	uint32 ReadBytes(void *destination, uint32 count) override;
+	uint32 Skip(uint32 nBytes) override;
+
+private:
+	//Members
+	InputStream& inputStream;
+	uint64 nBytesToSkip;
+	uint64 leftSize;
+
+	//Methods
+	bool SkipToSlice();
+};
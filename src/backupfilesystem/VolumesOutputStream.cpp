@@ -18,8 +18,6 @@
  */
 //Class header
 #include "VolumesOutputStream.hpp"
-//Local
-#include "FlatVolumesFileSystem.hpp"
 
 //Constructor
 VolumesOutputStream::VolumesOutputStream(FlatVolumesFileSystem &fileSystem, const class Path& path) : fileSystem(fileSystem), path(path)
@@ -29,17 +27,83 @@ VolumesOutputStream::VolumesOutputStream(FlatVolumesFileSystem &fileSystem, cons
 //Destructor
 VolumesOutputStream::~VolumesOutputStream()
 {
-	this->fileSystem.CloseFile(*this);
+	this->Flush();
+	if(!this->volume.IsNull())
+		this->fileSystem.ReleaseVolume(StdXX::Move(this->volume));
 }
 
 //Public methods
+void VolumesOutputStream::DiscardUncommittedBlocks()
+{
+	this->ReclaimSpace(this->uncommittedBlocks);
+	this->uncommittedBlocks.Release();
+}
+
 void VolumesOutputStream::Flush()
 {
-	//this stream always flushes
+	//data is written through to the volume files, only the blocks need to be committed
+	if(this->uncommittedBlocks.IsEmpty())
+		return;
+
+	this->fileSystem.CommitBlocks(this->path, this->uncommittedBlocks);
+	this->uncommittedBlocks.Release();
+}
+
+void VolumesOutputStream::ReclaimSpace(const DynamicArray<Block>& blocks)
+{
+	if(this->volume.IsNull())
+		return;
+
+	const uint64 currentOffset = this->volume->file->QueryCurrentOffset();
+	uint64 endOffset = currentOffset;
+	for(uint32 i = blocks.GetNumberOfElements(); i > 0; i--)
+	{
+		const Block& block = blocks[i - 1];
+		if( (block.volumeNumber != this->volume->number) or (block.offset + block.size != endOffset) )
+			break;
+		endOffset = block.offset;
+		this->volume->leftSize += block.size;
+	}
+	if(endOffset != currentOffset)
+		this->fileSystem.TruncateVolume(*this->volume, endOffset);
 }
 
 uint32 VolumesOutputStream::WriteBytes(const void *source, uint32 size)
 {
-	this->fileSystem.WriteBytes(*this, source, size);
+	const uint8* src = static_cast<const uint8 *>(source);
+	uint32 leftBytes = size;
+	while(leftBytes)
+	{
+		if(this->volume.IsNull())
+			this->volume = this->fileSystem.AcquireVolume();
+
+		uint32 bytesToWrite = (uint32)Math::Min(this->volume->leftSize, (uint64)leftBytes);
+		uint64 offset = this->volume->file->QueryCurrentOffset();
+		uint32 nBytesWritten = this->volume->file->WriteBytes(src, bytesToWrite);
+
+		src += nBytesWritten;
+		leftBytes -= nBytesWritten;
+		this->AddBlock(offset, nBytesWritten);
+
+		this->volume->leftSize -= nBytesWritten;
+		if(this->volume->leftSize == 0)
+			this->fileSystem.ReleaseVolume(StdXX::Move(this->volume));
+	}
 	return size;
+}
+
+//Private methods
+void VolumesOutputStream::AddBlock(uint64 offset, uint32 size)
+{
+	uint64 volumeNumber = this->volume->number;
+	if(!this->uncommittedBlocks.IsEmpty())
+	{
+		Block& lastBlock = this->uncommittedBlocks.Last();
+		if( (lastBlock.volumeNumber == volumeNumber) and ((lastBlock.offset + lastBlock.size) == offset) )
+		{
+			lastBlock.size += size;
+			return;
+		}
+	}
+	this->uncommittedBlocks.Push({ .volumeNumber = volumeNumber, .offset = offset, .size = size });
 }
\ No newline at end of file
@@ -19,10 +19,13 @@
 #include <StdXX.hpp>
 using namespace StdXX;
 using namespace StdXX::FileSystem;
+//Local
+#include "FlatVolumesFileSystem.hpp"
 
-//Forward declarations
-class FlatVolumesFileSystem;
-
+/**
+ * Writes into a volume that this stream owns exclusively, so writing takes no lock.
+ * The written blocks are collected in the stream and committed to the index when the stream is flushed or destroyed.
+ */
 class VolumesOutputStream : public OutputStream
 {
 public:
@@ -39,11 +42,25 @@ public:
 	}
 
 	//Methods
+	/**
+	 * Forgets the blocks that were not committed yet and reuses their space if possible.
+	 */
+	void DiscardUncommittedBlocks();
 	void Flush() override;
+	/**
+	 * Reuses the space of the given blocks if they are at the end of the owned volume. The volume file is truncated
+	 * accordingly, so that no unreferenced data remains at its end.
+	 */
+	void ReclaimSpace(const DynamicArray<Block>& blocks);
 	uint32 WriteBytes(const void *source, uint32 size) override;
 
 private:
 	//Members
 	FlatVolumesFileSystem& fileSystem;
-	const class Path& path;
+	class Path path;
+	UniquePointer<FlatVolumesFileSystem::OpenVolumeForWriting> volume;
+	DynamicArray<Block> uncommittedBlocks;
+
+	//Methods
+	void AddBlock(uint64 offset, uint32 size);
 };
\ No newline at end of file
@@ -20,19 +20,47 @@
 using namespace StdXX;
 //Local
 #include "../indexing/OSFileSystemNodeIndex.hpp"
+#include "../indexing/SourceWatcher.hpp"
 #include "../status/StatusTracker.hpp"
 #include "../backup/SnapshotManager.hpp"
 #include "../config/CompressionStatistics.hpp"
+#include "Commands.hpp"
 
 int32 CommandAddSnapshot(SnapshotManager& snapshotManager)
 {
 	InjectionContainer& ic = InjectionContainer::Instance();
 
-	OSFileSystemNodeIndex sourceIndex(ic.Config().sourcePath);
-	if(snapshotManager.AddSnapshot(sourceIndex))
+	const Config& config = ic.Config();
+
+	//if a watcher ran since the newest snapshot was created, only the nodes that it reported as changed need to be read
+	DirtyPathJournal journal(config.backupPath);
+	UniquePointer<IncrementalScanSource> incrementalSource;
+	if(!snapshotManager.Snapshots().IsEmpty() and SourceWatcher::Synchronize(config.backupPath) and journal.Take(snapshotManager.NewestSnapshot().Name()))
+		incrementalSource = new IncrementalScanSource{ .previousIndex = snapshotManager.NewestSnapshot().Index(), .journal = journal };
+
+	SourceScanCache scanCache(config.backupPath);
+	OSFileSystemNodeIndex sourceIndex(config.sourcePath, &scanCache, incrementalSource.operator->());
+	scanCache.Write();
+	stdOut << u8"Read " << sourceIndex.GetNumberOfNodes() << u8" nodes of the source directory in " << sourceIndex.ScanDuration() / 1000 << u8" ms using "
+		<< sourceIndex.NumberOfFileSystemQueries() << u8" file system queries." << endl;
+	if(!incrementalSource.IsNull())
+		stdOut << u8"The watcher reported " << journal.NumberOfDirtyPaths() << u8" changed paths, " << sourceIndex.NumberOfReusedNodes() << u8" unchanged nodes were taken from the newest snapshot." << endl;
+
+	VerificationCoverage verificationCoverage;
+	if(snapshotManager.AddSnapshot(sourceIndex, verificationCoverage))
+	{
 		stdOut << u8"Snapshot creation successful." << endl;
+		if(snapshotManager.AvoidedHashingSize())
+			stdOut << u8"Backed up " << String::FormatBinaryPrefixed(snapshotManager.AvoidedHashingSize()) << u8" of new nodes without speculating on a copy in the newest snapshot because no node of it can have the same data." << endl;
+		const CompressionStatistics& compressionStatistics = ic.CompressionStats();
+		stdOut << u8"The compressibility probe confirmed the estimate of the file type for " << compressionStatistics.NumberOfProbeHits() << u8" files and overruled it for "
+			<< compressionStatistics.NumberOfProbeMisses() << u8" files." << endl;
+		if(SourceWatcher::IsRunning(config.backupPath))
+			journal.AppendBase(snapshotManager.NewestSnapshot().Name());
+	}
 	else
 		stdOut << u8"Snapshot creation failed. The snapshot is corrupt." << endl;
+	OutputVerificationCoverage(verificationCoverage);
 
 	return EXIT_SUCCESS;
 }
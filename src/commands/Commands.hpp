@@ -24,6 +24,7 @@ using namespace StdXX::FileSystem;
 
 //Prototypes
 int32 CommandAddSnapshot(SnapshotManager& snapshotManager);
+int32 CommandConvertIndexFiles();
 int32 CommandDiffSnapshots(const SnapshotManager& snapshotManager, const String& snapshotName, const String& otherSnapshotName);
 int32 CommandDiffSnapshotWithSourceDirectory(const SnapshotManager& snapshotManager, const String& snapshotName);
 int32 CommandInit(const Path& backupPath, const Path& sourcePath);
@@ -31,4 +32,8 @@ int32 CommandOutputSnapshotHashValues(const Snapshot& snapshot);
 int32 CommandOutputSnapshotHashValues(const Snapshot& snapshot, const String& hashAlgorithm);
 int32 CommandOutputSnapshotStats(const Snapshot& snapshot);
 int32 CommandVerifyAllSnapshots(const SnapshotManager& snapshotManager);
-int32 CommandVerifySnapshot(const SnapshotManager& snapshotManager, const Snapshot& snapshot, bool full);
\ No newline at end of file
+int32 CommandVerifySnapshot(const SnapshotManager& snapshotManager, const Snapshot& snapshot, bool full);
+int32 CommandWatch();
+
+void LoadSnapshotIndexes(const SnapshotManager& snapshotManager, const Snapshot& snapshot);
+void OutputVerificationCoverage(const VerificationCoverage& coverage);
\ No newline at end of file
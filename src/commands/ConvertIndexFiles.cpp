@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Corresponding header
+#include "Commands.hpp"
+//Local
+#include "../backup/IndexFile.hpp"
+#include "../Util.hpp"
+
+static bool IndexesAreEqual(const BackupNodeIndex& index, const BackupNodeIndex& other)
+{
+	if(index.GetNumberOfNodes() != other.GetNumberOfNodes())
+		return false;
+
+	for(uint32 i = 0; i < index.GetNumberOfNodes(); i++)
+	{
+		const BackupNodeAttributes& attributes = index.GetNodeAttributes(i);
+		const BackupNodeAttributes& otherAttributes = other.GetNodeAttributes(i);
+
+		if(index.GetNodePath(i) != other.GetNodePath(i))
+			return false;
+		if( (attributes != otherAttributes) or (attributes.ComputeSumOfBlockSizes() != otherAttributes.ComputeSumOfBlockSizes()) )
+			return false;
+		if(attributes.HashValues().GetNumberOfElements() != otherAttributes.HashValues().GetNumberOfElements())
+			return false;
+		for(const HashValue& hashValue : attributes.HashValues())
+		{
+			const Digest* otherHash = otherAttributes.FindHash(hashValue.algorithm);
+			if( (otherHash == nullptr) or (*otherHash != hashValue.digest) )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+int32 CommandConvertIndexFiles()
+{
+	const Path& indexPath = InjectionContainer::Instance().Config().indexPath;
+
+	DynamicArray<String> legacyIndexFiles;
+	File dir(indexPath);
+	for(const auto& entry : dir)
+	{
+		if( (entry.type == FileType::File) and (Path(entry.name).GetFileExtension() == c_legacyIndexFileExtension) )
+			legacyIndexFiles.Push(entry.name);
+	}
+
+	if(legacyIndexFiles.IsEmpty())
+	{
+		stdOut << u8"All index files are already in the binary format." << endl;
+		return EXIT_SUCCESS;
+	}
+
+	UnprotectFile(indexPath);
+	for(const String& fileName : legacyIndexFiles)
+	{
+		Path xmlName = Path(fileName).GetTitle(); //strip of .lzma
+		String snapshotName = xmlName.GetTitle(); //strip of .xml
+
+		Path legacyIndexFilePath = indexPath / fileName;
+		Path legacyIndexHashFilePath = indexPath / xmlName.String() + String(c_hashFileSuffix);
+		Path indexFilePath = indexPath / snapshotName + (u8"." + String(c_indexFileExtension));
+		Path indexHashFilePath = indexFilePath.String() + String(c_hashFileSuffix);
+
+		UniquePointer<BackupNodeIndex> legacyIndex = ReadLegacyIndexFile(legacyIndexFilePath, legacyIndexHashFilePath);
+		WriteIndexFile(*legacyIndex, indexFilePath, indexHashFilePath);
+
+		//only remove the old file if the new one can be read back and is equal
+		UniquePointer<BackupNodeIndex> index = ReadIndexFile(indexFilePath, indexHashFilePath);
+		if(!IndexesAreEqual(*legacyIndex, *index))
+		{
+			stdErr << u8"Conversion of index of snapshot '" << snapshotName << u8"' failed. The old index is kept." << endl;
+			File(indexFilePath).DeleteFile();
+			File(indexHashFilePath).DeleteFile();
+			WriteProtectFile(indexPath);
+			return EXIT_FAILURE;
+		}
+
+		WriteProtectFile(indexFilePath);
+		WriteProtectFile(indexHashFilePath);
+		File(legacyIndexFilePath).DeleteFile();
+		File(legacyIndexHashFilePath).DeleteFile();
+
+		stdOut << u8"Converted index of snapshot '" << snapshotName << u8"'." << endl;
+	}
+	WriteProtectFile(indexPath);
+
+	return EXIT_SUCCESS;
+}
@@ -44,16 +44,19 @@ static void Diff(const Snapshot& snapshot, const FileSystemNodeIndex& sourceInde
 		csvWriter << path.String() << u8"metadata (only) has changed" << endl;
 	}
 
-	for(const auto& kv : differences.moved)
+	for(const NodeMove& move : differences.moved)
 	{
-		const Path& oldPath = snapshot.Index().GetNodePath(kv.value);
-		const Path& newPath = sourceIndex.GetNodePath(kv.key);
+		const Path& oldPath = snapshot.Index().GetNodePath(move.leftIndex);
+		const Path& newPath = sourceIndex.GetNodePath(move.rightIndex);
 
 		csvWriter << oldPath.String() << u8"node was moved" << newPath.String() << endl;
 	}
 
 	if(!differences.Exist())
 	    csvWriter << u8"No differences exist" << endl;
+
+	if(differences.avoidedHashingSize)
+		stdOut << u8"Skipped hashing " << String::FormatBinaryPrefixed(differences.avoidedHashingSize) << u8" of new nodes because no node of the snapshot can have the same data." << endl;
 }
 
 int32 CommandDiffSnapshotWithSourceDirectory(const SnapshotManager& snapshotManager, const String& snapshotName)
@@ -64,7 +67,10 @@ int32 CommandDiffSnapshotWithSourceDirectory(const SnapshotManager& snapshotMana
 		stdErr << u8"Snapshot with name '" << snapshotName << u8"' not found." << endl;
 		return EXIT_FAILURE;
 	}
-	OSFileSystemNodeIndex sourceIndex(InjectionContainer::Instance().Config().sourcePath);
+	const Config& config = InjectionContainer::Instance().Config();
+	//diff is read-only, it uses the listings of the last backup but doesn't replace them
+	SourceScanCache scanCache(config.backupPath);
+	OSFileSystemNodeIndex sourceIndex(config.sourcePath, &scanCache);
 	Diff(*snapshot, sourceIndex);
 
 	return EXIT_SUCCESS;
@@ -93,5 +93,8 @@ int32 CommandInit(const Path& backupPath, const Path& sourcePath)
 	File indexDir(c.Config().indexPath);
 	indexDir.CreateDirectories();
 
+	File chunkStoreDir(c.Config().chunkStorePath);
+	chunkStoreDir.CreateDirectories();
+
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Corresponding header
+#include "Commands.hpp"
+
+void LoadSnapshotIndexes(const SnapshotManager& snapshotManager, const Snapshot& snapshot)
+{
+	Clock clock;
+	clock.Start();
+	snapshotManager.LoadIndexes(snapshot);
+	const uint64 elapsed = clock.GetElapsedMicroseconds();
+
+	uint64 summedUpDuration = 0;
+	stdOut << u8"Snapshot index loading times:" << endl;
+	for(const Snapshot* current = &snapshot; current; current = current->Previous())
+	{
+		stdOut << current->Name() << u8": " << current->Index().GetNumberOfNodes() << u8" nodes in " << current->IndexLoadDuration() / 1000 << u8" ms" << endl;
+		summedUpDuration += current->IndexLoadDuration();
+	}
+	stdOut << u8"Loaded all indexes in " << elapsed / 1000 << u8" ms (" << summedUpDuration / 1000 << u8" ms summed up over all snapshots)." << endl;
+}
@@ -19,6 +19,7 @@
 //Local
 #include "../config/ConfigManager.hpp"
 #include "../backup/SnapshotManager.hpp"
+#include "../ParallelFor.hpp"
 #include "../Serialization.hpp"
 #include "../StreamPipingFailedException.hpp"
 #include "../status/StatusTrackingOutputStream.hpp"
@@ -27,17 +28,18 @@ static String GenerateHashValue(uint32 i, const BackupNodeIndex& index, Crypto::
 {
 	const BackupNodeAttributes& attributes = index.GetNodeAttributes(i);
 
-	if(attributes.HashValues().Contains(hashAlgorithm))
-		return attributes.Hash(hashAlgorithm);
+	const Digest* storedHash = attributes.FindHash(hashAlgorithm);
+	if(storedHash)
+		return storedHash->ToHexString();
 
-	Path realNodePath;
-	const Snapshot* dataSnapshot = snapshot.FindDataSnapshot(i, realNodePath);
+	uint32 dataNodeIndex;
+	const Snapshot* dataSnapshot = snapshot.FindDataSnapshot(i, dataNodeIndex);
 
 	UniquePointer<InputStream> input;
 	if(attributes.Type() == FileType::Link)
-		input = dataSnapshot->Filesystem().OpenLinkTargetAsStream(realNodePath, false);
+		input = dataSnapshot->Filesystem().OpenLinkTargetAsStream(dataSnapshot->Index().GetNodePath(dataNodeIndex), false);
 	else
-		input = dataSnapshot->Filesystem().OpenFileForReading(realNodePath, false);
+		input = dataSnapshot->Filesystem().OpenFileForReading(dataNodeIndex, false);
 	NullOutputStream nullOutputStream;
 	Crypto::HashingOutputStream hashingOutputStream(nullOutputStream, hashAlgorithm);
 
@@ -45,7 +47,7 @@ static String GenerateHashValue(uint32 i, const BackupNodeIndex& index, Crypto::
 
 	uint64 readSize = input->FlushTo(statusTrackingOutputStream);
 	if(readSize != attributes.Size())
-		throw StreamPipingFailedException(realNodePath);
+		throw StreamPipingFailedException(index.GetNodePath(i));
 
 	UniquePointer<Crypto::HashFunction> hasher = hashingOutputStream.Reset();
 	hasher->Finish();
@@ -65,24 +67,20 @@ static int32 OutputSnapshotHashValues(const Snapshot& snapshot, Crypto::HashAlgo
 	Mutex csvWriterMutex;
 
 	ProcessStatus& process = statusTracker.AddProcessStatusTracker(u8"Generating hash values", index.GetNumberOfNodes(), index.ComputeTotalSize());
-	for(uint32 i = 0; i < index.GetNumberOfNodes(); i++)
+	ParallelFor(threadPool, ic.NumberOfWorkers(), index.GetNumberOfNodes(), [&csvWriter, &csvWriterMutex, &index, hashAlgorithm, &snapshot, &process](uint32 i)
 	{
 		const BackupNodeAttributes& attributes = index.GetNodeAttributes(i);
 		if(attributes.Type() == FileType::Directory)
-			continue;
+			return;
 
-		threadPool.EnqueueTask([&csvWriter, &csvWriterMutex, &index, i, hashAlgorithm, &snapshot, &process]()
-		{
-			String hash = GenerateHashValue(i, index, hashAlgorithm, snapshot, process);
+		String hash = GenerateHashValue(i, index, hashAlgorithm, snapshot, process);
 
-			csvWriterMutex.Lock();
-			csvWriter << index.GetNodePath(i).String() << hash << endl;
-			csvWriterMutex.Unlock();
+		csvWriterMutex.Lock();
+		csvWriter << index.GetNodePath(i).String() << hash << endl;
+		csvWriterMutex.Unlock();
 
-			process.IncFinishedCount();
-		});
-	}
-	threadPool.WaitForAllTasksToComplete();
+		process.IncFinishedCount();
+	});
 	process.Finished();
 
 	return EXIT_SUCCESS;
@@ -17,6 +17,7 @@
  * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "../backup/SnapshotManager.hpp"
+#include "../backup/ChunkStore.hpp"
 
 int32 CommandOutputSnapshotStats(const Snapshot& snapshot)
 {
@@ -46,6 +47,8 @@ int32 CommandOutputSnapshotStats(const Snapshot& snapshot)
 		}
 	}
 
+	const ChunkStore& chunkStore = InjectionContainer::Instance().ChunkStore();
+
 	stdOut << u8"Number of nodes: " << index.GetNumberOfNodes() << endl
 		<< u8"Number of directories: " << nDirs << endl
 		<< u8"Number of files: " << nFiles << endl
@@ -54,6 +57,8 @@ int32 CommandOutputSnapshotStats(const Snapshot& snapshot)
 		<< u8"Total size of nodes including backreferences: " << String::FormatBinaryPrefixed(index.ComputeTotalSize()) << endl
 		<< u8"Total stored size of nodes including backreferences: " << String::FormatBinaryPrefixed(index.ComputeSumOfBlockSizes()) << endl
 		<< u8"Total stored size of nodes excluding backreferences: " << String::FormatBinaryPrefixed(totalStoredSize) << endl
+		<< u8"Number of chunks in chunk store (shared by all snapshots): " << chunkStore.NumberOfChunks() << endl
+		<< u8"Total stored size of chunk store: " << String::FormatBinaryPrefixed(chunkStore.ComputeStoredSize()) << endl
 		;
 
 
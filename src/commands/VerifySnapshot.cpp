@@ -39,14 +39,24 @@ bool OutputVerificationResults(const DynamicArray<uint32> failedNodes, const Sna
 	return false;
 }
 
+void OutputVerificationCoverage(const VerificationCoverage& coverage)
+{
+	stdOut << u8"Verified " << coverage.nVerifiedNodes << u8" of " << coverage.nNodes << u8" nodes ("
+		<< String::FormatBinaryPrefixed(coverage.verifiedSize) << u8" of " << String::FormatBinaryPrefixed(coverage.totalSize) << u8")." << endl;
+}
+
 static bool Verify(const SnapshotManager& snapshotManager, const Snapshot &snapshot, bool full)
 {
-	DynamicArray<uint32> failedNodes = snapshotManager.VerifySnapshot(snapshot, full);
+	VerificationCoverage coverage;
+	DynamicArray<uint32> failedNodes = snapshotManager.VerifySnapshot(snapshot, full, coverage);
+	OutputVerificationCoverage(coverage);
 	return OutputVerificationResults(failedNodes, snapshot);
 }
 
 int32 CommandVerifyAllSnapshots(const SnapshotManager& snapshotManager)
 {
+	LoadSnapshotIndexes(snapshotManager, snapshotManager.NewestSnapshot());
+
 	DynamicArray<String> snapshotsWithCorruption;
 	for(const auto& snapshot : snapshotManager.Snapshots())
 	{
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Corresponding header
+#include "Commands.hpp"
+//Local
+#include "../indexing/SourceWatcher.hpp"
+#include "../InjectionContainer.hpp"
+
+int32 CommandWatch()
+{
+	const Config& config = InjectionContainer::Instance().Config();
+
+#ifdef XPC_OS_LINUX
+	if(SourceWatcher::IsRunning(config.backupPath))
+	{
+		stdErr << u8"A watcher for this backup directory is already running." << endl;
+		return EXIT_FAILURE;
+	}
+
+	SourceWatcher watcher(config.sourcePath, config.backupPath);
+	if(!watcher.Start())
+	{
+		stdErr << u8"Could not watch " << config.sourcePath.String() << u8" for changes." << endl;
+		return EXIT_FAILURE;
+	}
+
+	stdOut << u8"Watching " << config.sourcePath.String() << u8" for changes." << endl;
+	watcher.Run();
+
+	stdErr << u8"Stopped watching " << config.sourcePath.String() << u8", it can't be watched anymore." << endl;
+	return EXIT_FAILURE;
+#else
+	stdErr << u8"Watching the source directory is not supported on this platform." << endl;
+	return EXIT_FAILURE;
+#endif
+}
@@ -24,6 +24,9 @@
 //Constructor
 CompressionStatistics::CompressionStatistics(const Path &path)
 {
+	this->nProbeHits = 0;
+	this->nProbeMisses = 0;
+
 	//read in compression stats
 	FileInputStream fileInputStream(path / this->c_comprStatsFileName);
 	BufferedInputStream bufferedInputStream(fileInputStream);
@@ -47,14 +50,46 @@ CompressionStatistics::CompressionStatistics(const Path &path)
 }
 
 //Public methods
-void CompressionStatistics::AddCompressionRateSample(const String &fileExtension, float32 compressionRate)
+void CompressionStatistics::AddCompressionRateSample(const String &fileExtension, float32 compressionRate, const CompressionMethod& compressionMethod)
 {
 	AutoLock lock(this->compressionStatsLock);
 
 	compressionRate = Math::Clamp(compressionRate, 0.0f, 1.0f);
 
 	String extLower = fileExtension.ToLowercase();
-	this->compressionStats[extLower] = (this->compressionStats[extLower] + compressionRate) / 2.0f;
+	float32& estimate = this->compressionStats[extLower];
+	/*
+	 * A bad rate of a faster tier doesn't mean that the configured codec would do badly as well, it would only push the
+	 * estimate towards the faster tiers even more. A good rate however means that the configured codec would do at least
+	 * as well, so that data which starts to compress well gets back to the configured codec.
+	 */
+	if(!compressionMethod.isConfiguredCodec and (compressionRate >= estimate))
+		return;
+	estimate = (estimate + compressionRate) / 2.0f;
+}
+
+CompressionMethod CompressionStatistics::ChooseCompressionMethod(float32 compressionRate, uint64 size) const
+{
+	InjectionContainer &injectionContainer = InjectionContainer::Instance();
+	const Config& config = injectionContainer.Config();
+
+	if(config.fastCompressionThreshold and (size >= config.fastCompressionThreshold))
+		return { .setting = CompressionSetting::zlib, .level = Math::Min(c_fastCompressionLevel, config.maxCompressionLevel) };
+	if(compressionRate > config.strongCompressionRate)
+		return { .setting = CompressionSetting::zlib, .level = Math::Min(c_mediumCompressionLevel, config.maxCompressionLevel) };
+	return { .setting = injectionContainer.ConfigManager().CompressionSetting(), .level = this->GetCompressionLevel(compressionRate), .isConfiguredCodec = true };
+}
+
+float32 CompressionStatistics::CombineWithProbe(float32 compressionRate, float32 probedCompressionRate)
+{
+	if( (compressionRate <= c_maxCompressibleRate) == (probedCompressionRate <= c_maxCompressibleRate) )
+	{
+		this->nProbeHits++;
+		return compressionRate;
+	}
+
+	this->nProbeMisses++;
+	return probedCompressionRate;
 }
 
 uint8 CompressionStatistics::GetCompressionLevel(float32 compressionRate) const
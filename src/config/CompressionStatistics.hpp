@@ -20,16 +20,61 @@
 #include <StdXX.hpp>
 using namespace StdXX;
 using namespace StdXX::FileSystem;
+//Local
+#include "../CompressionSetting.hpp"
+
+//Constants
+/**
+ * Data with a higher estimated compression rate is not worth compressing and is stored as is.
+ */
+const float32 c_maxCompressibleRate = 0.9f;
 
 class CompressionStatistics
 {
 public:
 	//Constructors
-	CompressionStatistics() = default;
+	inline CompressionStatistics()
+	{
+		this->nProbeHits = 0;
+		this->nProbeMisses = 0;
+	}
+
 	explicit CompressionStatistics(const Path& path);
 
+	//Properties
+	/**
+	 * Number of probed files for which the estimate of the file type was right about whether to compress them.
+	 */
+	inline uint64 NumberOfProbeHits() const
+	{
+		return this->nProbeHits;
+	}
+
+	/**
+	 * Number of probed files for which the estimate of the file type was overruled by the probe.
+	 */
+	inline uint64 NumberOfProbeMisses() const
+	{
+		return this->nProbeMisses;
+	}
+
     //Methods
-	void AddCompressionRateSample(const String& fileExtension, float32 compressionRate);
+	/**
+	 * The estimates are the rates of the configured codec. The faster tiers compress worse, so their rates are upper
+	 * bounds of the rate that the configured codec would have reached and can only lower an estimate.
+	 */
+	void AddCompressionRateSample(const String& fileExtension, float32 compressionRate, const CompressionMethod& compressionMethod);
+	/**
+	 * The policy that picks the codec tier for data of the given estimated compression rate and size:
+	 * large files get the fast tier, data that compresses poorly the medium tier and all other data the configured codec.
+	 */
+	CompressionMethod ChooseCompressionMethod(float32 compressionRate, uint64 size) const;
+	/**
+	 * Combines the estimate of the file type with the one that was probed from the data of the file.
+	 * The probe is followed if the two disagree on whether the file is worth compressing at all, as it looked at the
+	 * actual data. Counts as a hit or miss of the estimate of the file type.
+	 */
+	float32 CombineWithProbe(float32 compressionRate, float32 probedCompressionRate);
 	uint8 GetCompressionLevel(float32 compressionRate) const;
 	float32 GetCompressionRate(const String& fileExtension);
     void Write(const Path& dirPath);
@@ -43,8 +88,12 @@ public:
 private:
     //Constants
     const String c_comprStatsFileName = u8"compression_stats.csv";
+	static constexpr uint8 c_fastCompressionLevel = 1;
+	static constexpr uint8 c_mediumCompressionLevel = 6;
 
     //Members
 	BinaryTreeMap<String, float32> compressionStats;
 	Mutex compressionStatsLock;
+	Atomic<uint64> nProbeHits;
+	Atomic<uint64> nProbeMisses;
 };
\ No newline at end of file
@@ -31,13 +31,49 @@ struct Config : CompressionSettings
 	Path sourcePath;
 	uint32 blockSize;
 	uint64 volumeSize;
+	/**
+	 * Files with at least this size are split into content-defined chunks, which are deduplicated in the chunk store.
+	 * 0 disables chunking.
+	 */
+	uint64 chunkingThreshold;
+	/**
+	 * Files with at most this size are compressed together in solid groups. 0 disables solid groups.
+	 */
+	uint64 solidGroupThreshold;
+	/**
+	 * Maximum uncompressed size of a solid group. Restoring a single member needs to decompress up to this much data.
+	 */
+	uint64 solidGroupSize;
+	/**
+	 * Files that are not chunked and have at least twice this size are compressed in frames of this size, which are
+	 * compressed concurrently. 0 disables frames.
+	 */
+	uint64 compressionFrameSize;
+	/**
+	 * Files with at least this size are compressed with the fast codec. 0 disables this.
+	 */
+	uint64 fastCompressionThreshold;
+	/**
+	 * Files whose estimated compression rate is above this value use the medium codec instead of the configured one.
+	 */
+	float32 strongCompressionRate;
 	uint8 maxCompressionLevel;
 	Crypto::HashAlgorithm hashAlgorithm;
 	StatusTrackerType statusTrackerType;
 	uint16 statusTrackerPort;
+	/**
+	 * Percentage of the already verified node data that is verified again by a full verification.
+	 */
+	uint8 verificationPercentage;
+	/**
+	 * Memory in bytes that the loaded indexes of older snapshots may occupy before the least recently used ones are released.
+	 * 0 means unlimited.
+	 */
+	uint64 indexMemoryBudget;
 
 	//derived fields, not configurable
 	Path backupPath;
+	Path chunkStorePath;
 	Path dataPath;
 	Path indexPath;
 };
\ No newline at end of file
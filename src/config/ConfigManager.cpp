@@ -28,20 +28,42 @@ using namespace StdXX::Serialization;
 //Constants
 const char8_t* c_blockSize = u8"blockSize";
 
+const char8_t* c_chunkingThreshold = u8"chunkingThreshold";
+
 const char8_t* c_compression = u8"compression";
 const char8_t* c_compression_lzma = u8"lzma";
 
+const char8_t* c_compressionFrameSize = u8"compressionFrameSize";
+const uint64 c_defaultCompressionFrameSize = 16;
+
+const char8_t* c_fastCompressionThreshold = u8"fastCompressionThreshold";
+const uint64 c_defaultFastCompressionThreshold = 1024;
+
 const char8_t* c_maxCompressionLevel = u8"maxCompressionLevel";
 
 static const char8_t *const c_hashAlgorithm = u8"hashAlgorithm";
 
+const char8_t* c_indexMemoryBudget = u8"indexMemoryBudget";
+const uint64 c_defaultIndexMemoryBudget = 2048;
+
+const char8_t* c_solidGroupSize = u8"solidGroupSize";
+const uint64 c_defaultSolidGroupSize = 4;
+
+const char8_t* c_solidGroupThreshold = u8"solidGroupThreshold";
+
 static const char8_t *const c_sourcePath = u8"sourcePath";
 
+const char8_t* c_strongCompressionRate = u8"strongCompressionRate";
+const uint8 c_defaultStrongCompressionRate = 60;
+
 const char8_t* c_statusTracker = u8"statusTracker";
 const char8_t* c_statusTracker_web = u8"web";
 
 const char8_t* c_statusTracker_port = u8"statusTrackerPort";
 
+const char8_t* c_verificationPercentage = u8"verificationPercentage";
+const uint8 c_defaultVerificationPercentage = 10;
+
 const char8_t* c_volumeSize = u8"volumeSize";
 
 namespace StdXX::Serialization
@@ -58,12 +80,28 @@ namespace StdXX::Serialization
 			& Binding(c_blockSize, config.blockSize)
 			& Binding(c_volumeSize, config.volumeSize)
 		;
+		Optional<uint64> chunkingThreshold;
+		ar & Binding(c_chunkingThreshold, chunkingThreshold);
+		Optional<uint64> solidGroupThreshold;
+		ar & Binding(c_solidGroupThreshold, solidGroupThreshold);
+		Optional<uint64> solidGroupSize;
+		ar & Binding(c_solidGroupSize, solidGroupSize);
+		Optional<uint64> compressionFrameSize;
+		ar & Binding(c_compressionFrameSize, compressionFrameSize);
+		Optional<uint64> fastCompressionThreshold;
+		ar & Binding(c_fastCompressionThreshold, fastCompressionThreshold);
+		Optional<uint8> strongCompressionRate;
+		ar & Binding(c_strongCompressionRate, strongCompressionRate);
 		CustomArchive(ar, c_compression, compressionSetting);
 		ar & Binding(c_maxCompressionLevel, config.maxCompressionLevel);
 		CustomArchive(ar, c_hashAlgorithm, config.hashAlgorithm);
 		ar & Binding(c_statusTracker, StringMapping(config.statusTrackerType, statusTrackerMapping))
 			& Binding(c_statusTracker_port, config.statusTrackerPort)
 		;
+		Optional<uint8> verificationPercentage;
+		ar & Binding(c_verificationPercentage, verificationPercentage);
+		Optional<uint64> indexMemoryBudget;
+		ar & Binding(c_indexMemoryBudget, indexMemoryBudget);
 
 		ConfigManager::GetCompressionSettings(compressionSetting, config);
 
@@ -72,6 +110,21 @@ namespace StdXX::Serialization
 
 		config.blockSize *= KiB;
 		config.volumeSize *= MiB;
+		config.chunkingThreshold = chunkingThreshold.HasValue() ? (*chunkingThreshold * MiB) : 0; //older backup dirs don't have the field
+		config.solidGroupThreshold = solidGroupThreshold.HasValue() ? (*solidGroupThreshold * KiB) : 0; //older backup dirs don't have the field
+		config.solidGroupSize = (solidGroupSize.HasValue() ? *solidGroupSize : c_defaultSolidGroupSize) * MiB;
+		config.compressionFrameSize = compressionFrameSize.HasValue() ? (*compressionFrameSize * MiB) : 0; //older backup dirs don't have the field
+		if(config.compressionFrameSize > Unsigned<uint32>::Max())
+			throw ConfigException(u8"Invalid value for field '" + String(c_compressionFrameSize) + u8"'");
+		//older backup dirs don't have the fields and compress everything with the configured codec
+		config.fastCompressionThreshold = fastCompressionThreshold.HasValue() ? (*fastCompressionThreshold * MiB) : 0;
+		if(strongCompressionRate.HasValue() and (*strongCompressionRate > 100))
+			throw ConfigException(u8"Invalid value for field '" + String(c_strongCompressionRate) + u8"'");
+		config.strongCompressionRate = (strongCompressionRate.HasValue() ? *strongCompressionRate : 100) / 100.0f;
+		config.verificationPercentage = verificationPercentage.HasValue() ? *verificationPercentage : c_defaultVerificationPercentage;
+		if(config.verificationPercentage > 100)
+			throw ConfigException(u8"Invalid value for field '" + String(c_verificationPercentage) + u8"'");
+		config.indexMemoryBudget = (indexMemoryBudget.HasValue() ? *indexMemoryBudget : c_defaultIndexMemoryBudget) * MiB;
 	}
 }
 
@@ -110,11 +163,19 @@ void ConfigManager::Write(const Path &dirPath)
 	this->WriteConfigStringValue(textWriter, 1, c_sourcePath, this->config.sourcePath.String(), u8"The path to the directory that should be backed up");
 	this->WriteConfigValue(textWriter, 1, c_blockSize, 1024, u8"The maximum size of a block in KiB");
 	this->WriteConfigValue(textWriter, 1, c_volumeSize, 100, u8"The maximum size of a volume in MiB");
+	this->WriteConfigValue(textWriter, 1, c_chunkingThreshold, 64, u8"Files of at least this size in MiB are split into chunks that are only stored once for the whole backup. 0 disables chunking");
+	this->WriteConfigValue(textWriter, 1, c_solidGroupThreshold, 64, u8"Files of at most this size in KiB are compressed together in groups, which improves the compression of many small files. 0 disables grouping");
+	this->WriteConfigValue(textWriter, 1, c_solidGroupSize, c_defaultSolidGroupSize, u8"The maximum size of such a group in MiB before compression. Restoring a single file of a group reads up to this much data");
 	this->WriteConfigStringValue(textWriter, 1, c_compression, c_compression_lzma, u8"The used compression method");
+	this->WriteConfigValue(textWriter, 1, c_fastCompressionThreshold, c_defaultFastCompressionThreshold, u8"Files of at least this size in MiB are compressed with the fast codec (zlib at a low level), so that they don't limit the throughput of the whole backup. 0 disables this");
+	this->WriteConfigValue(textWriter, 1, c_strongCompressionRate, (uint32)c_defaultStrongCompressionRate, u8"Files whose type is estimated to compress to at most this percentage of their size are compressed with the configured compression method. Files that compress worse use the medium codec (zlib), for which the strong one would hardly save any space");
+	this->WriteConfigValue(textWriter, 1, c_compressionFrameSize, c_defaultCompressionFrameSize, u8"Files of at least twice this size in MiB that are not chunked are compressed in frames of this size by several threads at once. 0 disables frames");
 	this->WriteConfigValue(textWriter, 1, c_maxCompressionLevel, 6, u8"The maximum compression level");
 	this->WriteConfigStringValue(textWriter, 1, c_hashAlgorithm, c_hashAlgorithm_sha512_256, u8"The algorithm used to compute hash values");
 	this->WriteConfigStringValue(textWriter, 1, c_statusTracker, c_statusTracker_web, u8"The type of status reporting that should be used. Currently there is 'terminal' and 'web'.");
 	this->WriteConfigValue(textWriter, 1, c_statusTracker_port, 8080, u8"Port that the status tracking web service will listen on if enabled.");
+	this->WriteConfigValue(textWriter, 1, c_verificationPercentage, (uint32)c_defaultVerificationPercentage, u8"Percentage of the older node data that is verified again after a backup, the least recently verified ones first. Newly written data is always verified");
+	this->WriteConfigValue(textWriter, 1, c_indexMemoryBudget, c_defaultIndexMemoryBudget, u8"Memory in MiB that the indexes of older snapshots may occupy. The least recently used ones are released when it is exceeded. 0 means unlimited");
 	textWriter << u8"}" << endl;
 
 	bufferedOutputStream.Flush();
@@ -129,5 +190,16 @@ void ConfigManager::GetCompressionSettings(enum CompressionSetting compressionSe
 			settings.compressionAlgorithm = CompressionAlgorithm::LZMA;
 			settings.compressionStreamFormatType = CompressionStreamFormatType::lzma;
 			break;
+		case CompressionSetting::zlib:
+			settings.compressionAlgorithm = CompressionAlgorithm::DEFLATE;
+			settings.compressionStreamFormatType = CompressionStreamFormatType::zlib;
+			break;
 	}
+}
+
+UniquePointer<Compressor> ConfigManager::CreateCompressor(const CompressionMethod& compressionMethod, OutputStream& outputStream)
+{
+	CompressionSettings compressionSettings;
+	GetCompressionSettings(compressionMethod.setting, compressionSettings);
+	return Compressor::Create(compressionSettings.compressionStreamFormatType, compressionSettings.compressionAlgorithm, outputStream, compressionMethod.level);
 }
\ No newline at end of file
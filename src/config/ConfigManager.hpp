@@ -35,9 +35,13 @@ public:
 	void Write(const Path& dirPath);
 
 	//Functions
+	static UniquePointer<Compressor> CreateCompressor(const CompressionMethod& compressionMethod, OutputStream& outputStream);
 	static void GetCompressionSettings(enum CompressionSetting compressionSetting, CompressionSettings& settings);
 
 	//Properties
+	/**
+	 * The configured codec, which is used for all data that compresses well.
+	 */
 	enum CompressionSetting CompressionSetting() const
 	{
 		return CompressionSetting::lzma;
@@ -59,6 +63,7 @@ private:
 	//Inline
 	inline void SetPathsInConfig()
 	{
+		this->config.chunkStorePath = this->config.backupPath / String(u8"chunks");
 		this->config.dataPath = this->config.backupPath / String(u8"data");
 		this->config.indexPath = this->config.backupPath / String(u8"index");
 	}
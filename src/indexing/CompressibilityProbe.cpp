@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "CompressibilityProbe.hpp"
+
+//Constants
+static const uint32 c_probeSampleSize = 16 * 1024;
+static const uint8 c_probeNumberOfSamples = 4;
+static const uint64 c_probeMinSize = c_probeNumberOfSamples * c_probeSampleSize;
+/**
+ * Data with more bits per byte is not worth compressing.
+ */
+static const float32 c_incompressibleEntropy = 7.5f;
+
+struct Magic
+{
+	uint8 offset;
+	uint8 length;
+	const char* bytes;
+};
+
+static const Magic c_compressedFormatMagics[] = {
+	{ 0, 2, "\x1F\x8B" }, //gzip
+	{ 0, 3, "BZh" }, //bzip2
+	{ 0, 6, "\xFD" "7zXZ\x00" }, //xz
+	{ 0, 4, "\x28\xB5\x2F\xFD" }, //zstd
+	{ 0, 6, "7z\xBC\xAF\x27\x1C" }, //7z
+	{ 0, 4, "PK\x03\x04" }, //zip and all formats that are based on it (docx, jar, ...)
+	{ 0, 6, "Rar!\x1A\x07" }, //rar
+	{ 0, 4, "\x89PNG" }, //png
+	{ 0, 3, "\xFF\xD8\xFF" }, //jpeg
+	{ 0, 4, "GIF8" }, //gif
+	{ 8, 4, "WEBP" }, //webp
+	{ 4, 4, "ftyp" }, //mp4, mov, heic
+	{ 0, 4, "\x1A\x45\xDF\xA3" }, //matroska, webm
+	{ 0, 4, "OggS" }, //ogg
+	{ 0, 4, "fLaC" }, //flac
+	{ 0, 3, "ID3" }, //mp3
+	{ 0, 6, "LUKS\xBA\xBE" }, //luks
+};
+
+//Class functions
+Optional<float32> CompressibilityProbe::EstimateCompressionRate(SeekableInputStream& inputStream, uint64 size)
+{
+	if(size < c_probeMinSize)
+		return {};
+
+	Optional<float32> compressionRate = SampleCompressionRate(inputStream, size);
+	inputStream.SeekTo(0);
+	return compressionRate;
+}
+
+float32 CompressibilityProbe::ComputeEntropy(const uint32 (&histogram)[256], uint64 nBytes)
+{
+	float32 entropy = 0;
+	for(uint32 count : histogram)
+	{
+		if(count == 0)
+			continue;
+		float32 p = count / (float32)nBytes;
+		entropy -= p * log2f(p);
+	}
+	return entropy;
+}
+
+bool CompressibilityProbe::HasCompressedFormatMagic(const uint8* data, uint32 size)
+{
+	for(const Magic& magic : c_compressedFormatMagics)
+	{
+		if( (magic.offset + magic.length <= size) and (MemCmp(data + magic.offset, magic.bytes, magic.length) == 0) )
+			return true;
+	}
+	return false;
+}
+
+Optional<float32> CompressibilityProbe::SampleCompressionRate(SeekableInputStream& inputStream, uint64 size)
+{
+	FixedArray<uint8> buffer(c_probeSampleSize);
+	uint32 histograms[4][256] = {};
+	uint64 nSampledBytes = 0;
+
+	for(uint8 i = 0; i < c_probeNumberOfSamples; i++)
+	{
+		//evenly spread, the first one at the start so that the magic number can be checked
+		inputStream.SeekTo((size - c_probeSampleSize) / (c_probeNumberOfSamples - 1) * i);
+
+		uint32 nBytesRead = 0;
+		while(nBytesRead < c_probeSampleSize)
+		{
+			uint32 nRead = inputStream.ReadBytes(buffer.Data() + nBytesRead, c_probeSampleSize - nBytesRead);
+			if(nRead == 0)
+				return {}; //the data is shorter than expected
+			nBytesRead += nRead;
+		}
+
+		if( (i == 0) and HasCompressedFormatMagic(buffer.Data(), nBytesRead) )
+			return 1.0f;
+
+		UpdateHistograms(histograms, buffer.Data(), nBytesRead);
+		nSampledBytes += nBytesRead;
+	}
+
+	uint32 histogram[256];
+	for(uint32 i = 0; i < 256; i++)
+		histogram[i] = histograms[0][i] + histograms[1][i] + histograms[2][i] + histograms[3][i];
+
+	float32 entropy = ComputeEntropy(histogram, nSampledBytes);
+	if(entropy >= c_incompressibleEntropy)
+		return 1.0f;
+	return entropy / 8;
+}
+
+void CompressibilityProbe::UpdateHistograms(uint32 (&histograms)[4][256], const uint8* data, uint32 size)
+{
+	//four histograms, so that runs of equal bytes don't serialize on incrementing the same counter
+	uint32 i = 0;
+	for(; i + 4 <= size; i += 4)
+	{
+		histograms[0][data[i]]++;
+		histograms[1][data[i + 1]]++;
+		histograms[2][data[i + 2]]++;
+		histograms[3][data[i + 3]]++;
+	}
+	for(; i < size; i++)
+		histograms[0][data[i]]++;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+
+/**
+ * Estimates how well the data of a file compresses from a few samples of it, before any compression is set up.
+ * Data that starts with the magic number of an already compressed format is treated as incompressible. Otherwise the
+ * estimate is the order-0 entropy of the sampled bytes, which is close to 8 bits per byte for compressed or encrypted
+ * data no matter how the file is named.
+ */
+class CompressibilityProbe
+{
+public:
+	//Class functions
+	/**
+	 * Reads only the sampled parts of the data and seeks back to the start afterwards, so that the same stream can be
+	 * used for backing up the data.
+	 * @return the estimated compression rate, or nothing if the data is too small to be worth probing
+	 */
+	static Optional<float32> EstimateCompressionRate(SeekableInputStream& inputStream, uint64 size);
+
+private:
+	//Class functions
+	static float32 ComputeEntropy(const uint32 (&histogram)[256], uint64 nBytes);
+	static bool HasCompressedFormatMagic(const uint8* data, uint32 size);
+	static Optional<float32> SampleCompressionRate(SeekableInputStream& inputStream, uint64 size);
+	static void UpdateHistograms(uint32 (&histograms)[4][256], const uint8* data, uint32 size);
+};
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXX.hpp>
+using namespace StdXX;
+using namespace StdXX::FileSystem;
+
+class DirectoryScanFailedException : public Exception
+{
+public:
+	struct Failure
+	{
+		Path directoryPath;
+		String reason;
+
+		//Inline operators
+		inline bool operator<(const Failure& other) const
+		{
+			return this->directoryPath < other.directoryPath;
+		}
+	};
+
+	//Constructor
+	inline DirectoryScanFailedException(DynamicArray<Failure>&& failures) : failures(Move(failures))
+	{
+	}
+
+	//Properties
+	String Description() const override
+	{
+		String description = u8"The following directories could not be read:";
+		for(const Failure& failure : this->failures)
+			description += u8"\n" + failure.directoryPath.String() + u8": " + failure.reason;
+		return description;
+	}
+
+private:
+	//Members
+	DynamicArray<Failure> failures;
+};
\ No newline at end of file
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "DirtyPathJournal.hpp"
+//Global
+#ifdef XPC_OS_LINUX
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+enum class JournalRecordType : uint8
+{
+	/**
+	 * A watcher started, changes before this point are unknown.
+	 */
+	Start = 0,
+	/**
+	 * The snapshot with the given name was created, all changes since then follow.
+	 */
+	Base = 1,
+	/**
+	 * The node itself or the listing of the directory changed.
+	 */
+	DirtyNode = 2,
+	/**
+	 * The whole subtree of the node needs to be read again.
+	 */
+	DirtySubtree = 3,
+	/**
+	 * The kernel dropped notifications.
+	 */
+	Overflow = 4,
+};
+
+//Constants
+/**
+ * Payloads are paths or snapshot names. Longer ones can only come from a corrupt journal.
+ */
+static const uint32 c_maxPayloadLength = 1 * MiB;
+
+//Local functions
+static void AddRecord(DynamicArray<uint8>& records, JournalRecordType type, const String& payload)
+{
+	String utf8 = payload.ToUTF8();
+	uint32 length = utf8.GetSize();
+
+	records.Push(static_cast<uint8>(type));
+	for(uint8 i = 0; i < 4; i++)
+		records.Push(static_cast<uint8>(length >> (8 * i)));
+	for(uint32 i = 0; i < length; i++)
+		records.Push(utf8.GetRawData()[i]);
+}
+
+//Constructor
+DirtyPathJournal::DirtyPathJournal(const Path& dirPath) : dirPath(dirPath)
+{
+}
+
+//Public methods
+void DirtyPathJournal::AppendBase(const String& snapshotName)
+{
+	DynamicArray<uint8> records;
+	AddRecord(records, JournalRecordType::Base, snapshotName);
+	this->Append(records);
+}
+
+void DirtyPathJournal::AppendDirtyPaths(const BinaryTreeSet<Path>& nodePaths, const BinaryTreeSet<Path>& subtreePaths)
+{
+	DynamicArray<uint8> records;
+	for(const Path& path : nodePaths)
+		AddRecord(records, JournalRecordType::DirtyNode, path.String());
+	for(const Path& path : subtreePaths)
+		AddRecord(records, JournalRecordType::DirtySubtree, path.String());
+	this->Append(records);
+}
+
+void DirtyPathJournal::AppendOverflow()
+{
+	DynamicArray<uint8> records;
+	AddRecord(records, JournalRecordType::Overflow, {});
+	this->Append(records);
+}
+
+void DirtyPathJournal::AppendStart()
+{
+	DynamicArray<uint8> records;
+	AddRecord(records, JournalRecordType::Start, DateTime::Now().ToISOString());
+	this->Append(records);
+}
+
+bool DirtyPathJournal::IsDirty(const Path& nodePath) const
+{
+	if(this->dirtyNodes.Contains(nodePath))
+		return true;
+
+	Path current = nodePath;
+	while(true)
+	{
+		if(this->dirtySubtrees.Contains(current))
+			return true;
+
+		Path parent = current.GetParent();
+		if(parent.String().IsEmpty() or (parent.String() == current.String()))
+			break;
+		current = parent;
+	}
+	return false;
+}
+
+bool DirtyPathJournal::Take(const String& newestSnapshotName)
+{
+	this->dirtyNodes.Release();
+	this->dirtySubtrees.Release();
+
+#ifdef XPC_OS_LINUX
+	Path takenJournalPath = this->dirPath / this->c_takenJournalFileName;
+	String journalPathUtf8 = (this->dirPath / this->c_journalFileName).String().ToUTF8();
+	String takenJournalPathUtf8 = takenJournalPath.String().ToUTF8();
+
+	int fd = open(reinterpret_cast<const char*>(journalPathUtf8.GetRawZeroTerminatedData()), O_RDONLY);
+	if(fd == -1)
+		return false;
+
+	//the watcher holds the lock while appending, so no records get lost in the moved file
+	flock(fd, LOCK_EX);
+	int result = rename(reinterpret_cast<const char*>(journalPathUtf8.GetRawZeroTerminatedData()), reinterpret_cast<const char*>(takenJournalPathUtf8.GetRawZeroTerminatedData()));
+	close(fd);
+	if(result != 0)
+		return false;
+
+	bool isComplete;
+	try
+	{
+		FileInputStream fileInputStream(takenJournalPath);
+		BufferedInputStream bufferedInputStream(fileInputStream);
+		isComplete = this->Read(bufferedInputStream, newestSnapshotName);
+	}
+	catch(const Exception&)
+	{
+		isComplete = false;
+	}
+
+	if(!isComplete)
+	{
+		this->dirtyNodes.Release();
+		this->dirtySubtrees.Release();
+	}
+	return isComplete;
+#else
+	return false;
+#endif
+}
+
+//Private methods
+void DirtyPathJournal::Append(const DynamicArray<uint8>& records)
+{
+	if(records.IsEmpty())
+		return;
+
+#ifdef XPC_OS_LINUX
+	String journalPath = (this->dirPath / this->c_journalFileName).String().ToUTF8();
+	const char* journalPathRaw = reinterpret_cast<const char*>(journalPath.GetRawZeroTerminatedData());
+
+	//the journal may be moved aside while waiting for the lock, in that case append to the new one
+	int fd;
+	while(true)
+	{
+		fd = open(journalPathRaw, O_WRONLY | O_CREAT | O_APPEND, 0644);
+		if(fd == -1)
+			return;
+		flock(fd, LOCK_EX);
+
+		struct stat openedInfo, currentInfo;
+		if( (fstat(fd, &openedInfo) == 0) and (stat(journalPathRaw, &currentInfo) == 0) and (openedInfo.st_ino == currentInfo.st_ino) )
+			break;
+		close(fd);
+	}
+
+	uint32 nBytesWritten = 0;
+	while(nBytesWritten < records.GetNumberOfElements())
+	{
+		ssize_t result = write(fd, &records[nBytesWritten], records.GetNumberOfElements() - nBytesWritten);
+		if(result <= 0)
+			break;
+		nBytesWritten += result;
+	}
+	close(fd);
+#endif
+}
+
+bool DirtyPathJournal::Read(InputStream& inputStream, const String& newestSnapshotName)
+{
+	bool hasBase = false;
+	while(!inputStream.IsAtEnd())
+	{
+		uint8 header[5];
+		if(inputStream.ReadBytes(header, sizeof(header)) != sizeof(header))
+			return false; //truncated record
+
+		JournalRecordType type = static_cast<JournalRecordType>(header[0]);
+		uint32 length = 0;
+		for(uint8 i = 0; i < 4; i++)
+			length |= uint32(header[1 + i]) << (8 * i);
+		if(length > c_maxPayloadLength)
+			return false;
+
+		FixedArray<uint8> bytes(length);
+		if(inputStream.ReadBytes(bytes.Data(), length) != length)
+			return false; //truncated record
+		String payload = String::CopyUtf8Bytes(bytes.Data(), length);
+
+		switch(type)
+		{
+			case JournalRecordType::Start:
+			case JournalRecordType::Overflow:
+				return false; //changes might have been missed
+			case JournalRecordType::Base:
+				if(payload == newestSnapshotName)
+					hasBase = true;
+				break;
+			case JournalRecordType::DirtyNode:
+				this->dirtyNodes.Insert(payload);
+				break;
+			case JournalRecordType::DirtySubtree:
+				this->dirtySubtrees.Insert(payload);
+				break;
+			default:
+				return false;
+		}
+	}
+
+	return hasBase;
+}
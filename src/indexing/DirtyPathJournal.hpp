@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+using namespace StdXX::FileSystem;
+
+/**
+ * Journal of the nodes of the source directory that were changed since the newest snapshot was created.
+ * The watcher appends to it while it runs, adding a snapshot takes it over so that only the changed parts of the source
+ * directory need to be read again.
+ *
+ * The journal can only be trusted if a watcher was running the whole time since the newest snapshot was created and the
+ * kernel did not drop any notifications. Otherwise the source directory must be scanned completely.
+ */
+class DirtyPathJournal
+{
+public:
+	//Constructor
+	explicit DirtyPathJournal(const Path& dirPath);
+
+	//Properties
+	inline uint32 NumberOfDirtyPaths() const
+	{
+		return this->dirtyNodes.GetNumberOfElements() + this->dirtySubtrees.GetNumberOfElements();
+	}
+
+	//Methods
+	void AppendBase(const String& snapshotName);
+	void AppendDirtyPaths(const BinaryTreeSet<Path>& nodePaths, const BinaryTreeSet<Path>& subtreePaths);
+	void AppendOverflow();
+	void AppendStart();
+	/**
+	 * @return true if the node itself or one of its parents was changed since the journal was taken
+	 */
+	bool IsDirty(const Path& nodePath) const;
+	/**
+	 * Moves the journal aside so that the watcher continues in a new one and reads the changed paths.
+	 *
+	 * @return true if the journal covers all changes since the snapshot with the given name was created
+	 */
+	bool Take(const String& newestSnapshotName);
+
+private:
+	//Constants
+	const String c_journalFileName = u8"dirty_paths.journal";
+	const String c_takenJournalFileName = u8"dirty_paths.journal.taken";
+
+	//Members
+	Path dirPath;
+	BinaryTreeSet<Path> dirtyNodes;
+	BinaryTreeSet<Path> dirtySubtrees;
+
+	//Methods
+	void Append(const DynamicArray<uint8>& records);
+	bool Read(InputStream& inputStream, const String& newestSnapshotName);
+};
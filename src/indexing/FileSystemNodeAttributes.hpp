@@ -23,6 +23,26 @@ using namespace StdXX::FileSystem;
 //Local
 #include "../Util.hpp"
 
+/**
+ * Identifies a node within the file system independently of its path, i.e. it stays the same when the node is renamed.
+ */
+struct NodeIdentity
+{
+	uint64 deviceId;
+	uint64 inode;
+
+	//Inline operators
+	inline bool operator<(const NodeIdentity& other) const
+	{
+		return (this->deviceId < other.deviceId) or ((this->deviceId == other.deviceId) and (this->inode < other.inode));
+	}
+
+	inline bool operator==(const NodeIdentity& other) const
+	{
+		return (this->deviceId == other.deviceId) and (this->inode == other.inode);
+	}
+};
+
 class FileSystemNodeAttributes
 {
 public:
@@ -57,6 +77,19 @@ public:
 	virtual ~FileSystemNodeAttributes() = default;
 
 	//Properties
+	/**
+	 * Not known for every node, e.g. for nodes of snapshots that were created by older versions.
+	 */
+	inline const Optional<NodeIdentity>& Identity() const
+	{
+		return this->identity;
+	}
+
+	inline void Identity(const NodeIdentity& identity)
+	{
+		this->identity = identity;
+	}
+
 	inline const Optional<DateTime>& LastModifiedTime() const
 	{
 		return this->lastModifiedTime;
@@ -84,6 +117,7 @@ public:
         this->size = attributes.size;
         this->permissions = attributes.permissions->Clone();
         this->lastModifiedTime = attributes.lastModifiedTime;
+        this->identity = attributes.identity;
 
         return *this;
     }
@@ -105,6 +139,7 @@ public:
 		this->type = other.type;
 		this->size = other.size;
 		this->lastModifiedTime = other.lastModifiedTime;
+		this->identity = other.identity;
 	}
 
 private:
@@ -113,4 +148,5 @@ private:
 	uint64 size;
 	UniquePointer<FileSystem::Permissions> permissions;
 	Optional<DateTime> lastModifiedTime;
+	Optional<NodeIdentity> identity;
 };
\ No newline at end of file
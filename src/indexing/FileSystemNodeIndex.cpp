@@ -22,6 +22,52 @@
 #include "../InjectionContainer.hpp"
 #include "../status/StatusTracker.hpp"
 
+//Constants
+static const uint32 c_minNumberOfSlots = 16;
+
+//Local functions
+static uint32 HashBytes(const uint8* bytes, uint32 size)
+{
+	//FNV-1a
+	uint32 hash = 2166136261u;
+	for(uint32 i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * Finds the next component of a UTF-8 encoded path, starting at offset.
+ * @return false if there are no more components
+ */
+static bool NextPathComponent(const uint8* path, uint32 pathSize, uint32& offset, uint32& componentOffset, uint32& componentSize)
+{
+	while( (offset < pathSize) and (path[offset] == u8'/') )
+		offset++;
+	if(offset == pathSize)
+		return false;
+
+	componentOffset = offset;
+	while( (offset < pathSize) and (path[offset] != u8'/') )
+		offset++;
+	componentSize = offset - componentOffset;
+	return true;
+}
+
+//Constructor
+FileSystemNodeIndex::FileSystemNodeIndex()
+{
+	this->isFrozen = false;
+
+	this->names.Push(String().ToUTF8());
+	this->RehashNames(c_minNumberOfSlots);
+	this->RehashChildren(c_minNumberOfSlots);
+
+	this->pathEntries.Push({ .parent = Unsigned<uint32>::Max(), .nameId = 0, .nodeIndex = Unsigned<uint32>::Max() });
+}
+
 //Public methods
 uint64 FileSystemNodeIndex::ComputeTotalSize() const
 {
@@ -31,11 +77,185 @@ uint64 FileSystemNodeIndex::ComputeTotalSize() const
 	return totalSize;
 }
 
-uint64 FileSystemNodeIndex::ComputeTotalSize(const BinaryTreeSet<uint32> &nodeIndices) const
+uint64 FileSystemNodeIndex::ComputeTotalSize(const DynamicArray<uint32> &nodeIndices) const
 {
 	uint64 totalSize = 0;
 	for(uint32 nodeIndex : nodeIndices)
 		totalSize += this->GetNodeAttributes(nodeIndex).Size();
 
 	return totalSize;
+}
+
+Path FileSystemNodeIndex::GetNodePath(uint32 index) const
+{
+	ReadLock lock(*this);
+
+	uint32 entryIndex = this->nodePathEntries[index];
+	if(entryIndex == c_rootPathEntryIndex)
+		return u8"/";
+
+	DynamicArray<uint32> nameIdsFromLeaf;
+	for(; entryIndex != c_rootPathEntryIndex; entryIndex = this->pathEntries[entryIndex].parent)
+		nameIdsFromLeaf.Push(this->pathEntries[entryIndex].nameId);
+
+	String path;
+	for(uint32 i = nameIdsFromLeaf.GetNumberOfElements(); i--;)
+		path += u8"/" + this->names[nameIdsFromLeaf[i]];
+	return path;
+}
+
+DynamicArray<uint32> FileSystemNodeIndex::ListNodesTopDown() const
+{
+	ReadLock lock(*this);
+
+	//an entry is always created after the entry of its parent
+	DynamicArray<uint32> nodeIndices;
+	nodeIndices.EnsureCapacity(this->nodeAttributes.GetNumberOfElements());
+	for(const PathEntry& entry : this->pathEntries)
+	{
+		if(entry.nodeIndex != Unsigned<uint32>::Max())
+			nodeIndices.Push(entry.nodeIndex);
+	}
+
+	return nodeIndices;
+}
+
+//Protected methods
+uint32 FileSystemNodeIndex::AddChildNode(uint32 parentNodeIndex, const uint8* name, uint32 nameSize, UniquePointer<FileSystemNodeAttributes>&& attributes)
+{
+	AutoLock lock(this->lock);
+	ASSERT(!this->isFrozen, u8"Can't add nodes to a frozen index");
+
+	uint32 index = this->nodeAttributes.Push(Move(attributes));
+	uint32 entryIndex = this->InsertChildEntry(this->nodePathEntries[parentNodeIndex], this->InsertName(name, nameSize));
+	this->pathEntries[entryIndex].nodeIndex = index;
+	this->nodePathEntries.Push(entryIndex);
+	return index;
+}
+
+//Private methods
+uint32 FileSystemNodeIndex::FindChildSlot(uint32 parentEntryIndex, uint32 nameId) const
+{
+	const FixedArray<uint32>& slots = *this->childSlots;
+	uint32 hash = (parentEntryIndex * 2654435761u) ^ (nameId * 2246822519u);
+
+	uint32 mask = slots.GetNumberOfElements() - 1;
+	uint32 slot = hash & mask;
+	while(slots[slot] != Unsigned<uint32>::Max())
+	{
+		const PathEntry& entry = this->pathEntries[slots[slot]];
+		if( (entry.parent == parentEntryIndex) and (entry.nameId == nameId) )
+			break;
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+uint32 FileSystemNodeIndex::FindNameSlot(const uint8* name, uint32 nameSize) const
+{
+	const FixedArray<uint32>& slots = *this->nameSlots;
+
+	uint32 mask = slots.GetNumberOfElements() - 1;
+	uint32 slot = HashBytes(name, nameSize) & mask;
+	while(slots[slot] != Unsigned<uint32>::Max())
+	{
+		uint32 nameId = slots[slot];
+		if( (this->names[nameId].GetSize() == nameSize) and (MemCmp(this->GetNameBytes(nameId), name, nameSize) == 0) )
+			break;
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+uint32 FileSystemNodeIndex::FindPathEntry(const Path& path) const
+{
+	String pathUtf8 = path.String().ToUTF8();
+	const uint8* pathBytes = reinterpret_cast<const uint8*>(pathUtf8.GetRawData());
+
+	uint32 entryIndex = c_rootPathEntryIndex;
+	uint32 offset = 0, componentOffset, componentSize;
+	while(NextPathComponent(pathBytes, pathUtf8.GetSize(), offset, componentOffset, componentSize))
+	{
+		uint32 nameId = (*this->nameSlots)[this->FindNameSlot(pathBytes + componentOffset, componentSize)];
+		if(nameId == Unsigned<uint32>::Max())
+			return Unsigned<uint32>::Max();
+
+		entryIndex = (*this->childSlots)[this->FindChildSlot(entryIndex, nameId)];
+		if(entryIndex == Unsigned<uint32>::Max())
+			return Unsigned<uint32>::Max();
+	}
+
+	return entryIndex;
+}
+
+uint32 FileSystemNodeIndex::InsertChildEntry(uint32 parentEntryIndex, uint32 nameId)
+{
+	uint32 slot = this->FindChildSlot(parentEntryIndex, nameId);
+	if((*this->childSlots)[slot] != Unsigned<uint32>::Max())
+		return (*this->childSlots)[slot];
+
+	uint32 entryIndex = this->pathEntries.Push({ .parent = parentEntryIndex, .nameId = nameId, .nodeIndex = Unsigned<uint32>::Max() });
+	(*this->childSlots)[slot] = entryIndex;
+
+	//keep the load factor at most 1/2 so that probe sequences stay short. All entries except the root are children
+	if(2 * this->pathEntries.GetNumberOfElements() > this->childSlots->GetNumberOfElements())
+		this->RehashChildren(2 * this->childSlots->GetNumberOfElements());
+
+	return entryIndex;
+}
+
+uint32 FileSystemNodeIndex::InsertName(const uint8* name, uint32 nameSize)
+{
+	uint32 slot = this->FindNameSlot(name, nameSize);
+	if((*this->nameSlots)[slot] != Unsigned<uint32>::Max())
+		return (*this->nameSlots)[slot];
+
+	uint32 nameId = this->names.Push(String::CopyUtf8Bytes(name, nameSize));
+	(*this->nameSlots)[slot] = nameId;
+
+	if(2 * this->names.GetNumberOfElements() > this->nameSlots->GetNumberOfElements())
+		this->RehashNames(2 * this->nameSlots->GetNumberOfElements());
+
+	return nameId;
+}
+
+uint32 FileSystemNodeIndex::InsertPathEntry(const Path& path)
+{
+	String pathUtf8 = path.String().ToUTF8();
+	const uint8* pathBytes = reinterpret_cast<const uint8*>(pathUtf8.GetRawData());
+
+	uint32 entryIndex = c_rootPathEntryIndex;
+	uint32 offset = 0, componentOffset, componentSize;
+	while(NextPathComponent(pathBytes, pathUtf8.GetSize(), offset, componentOffset, componentSize))
+	{
+		uint32 nameId = this->InsertName(pathBytes + componentOffset, componentSize);
+		entryIndex = this->InsertChildEntry(entryIndex, nameId);
+	}
+
+	return entryIndex;
+}
+
+void FileSystemNodeIndex::RehashChildren(uint32 nSlots)
+{
+	this->childSlots = new FixedArray<uint32>(nSlots);
+	for(uint32 i = 0; i < nSlots; i++)
+		(*this->childSlots)[i] = Unsigned<uint32>::Max();
+
+	for(uint32 i = 0; i < this->pathEntries.GetNumberOfElements(); i++)
+	{
+		if(i == c_rootPathEntryIndex)
+			continue;
+		const PathEntry& entry = this->pathEntries[i];
+		(*this->childSlots)[this->FindChildSlot(entry.parent, entry.nameId)] = i;
+	}
+}
+
+void FileSystemNodeIndex::RehashNames(uint32 nSlots)
+{
+	this->nameSlots = new FixedArray<uint32>(nSlots);
+	for(uint32 i = 0; i < nSlots; i++)
+		(*this->nameSlots)[i] = Unsigned<uint32>::Max();
+
+	for(uint32 i = 0; i < this->names.GetNumberOfElements(); i++)
+		(*this->nameSlots)[this->FindNameSlot(this->GetNameBytes(i), this->names[i].GetSize())] = i;
 }
\ No newline at end of file
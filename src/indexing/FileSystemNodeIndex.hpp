@@ -26,6 +26,9 @@ using namespace StdXX::FileSystem;
 class FileSystemNodeIndex
 {
 public:
+	//Constructor
+	FileSystemNodeIndex();
+
 	//Destructor
 	virtual ~FileSystemNodeIndex() {}
 
@@ -36,40 +39,76 @@ public:
 	 * @return
 	 */
 	uint64 ComputeTotalSize() const;
-	uint64 ComputeTotalSize(const BinaryTreeSet<uint32>& nodeIndices) const;
+	uint64 ComputeTotalSize(const DynamicArray<uint32>& nodeIndices) const;
+	Path GetNodePath(uint32 index) const;
+	/**
+	 * Lists the indices of all nodes so that every node comes after the node of its parent directory.
+	 */
+	DynamicArray<uint32> ListNodesTopDown() const;
 
 	//Properties
-	inline const BijectiveMap<Path, uint32> PathMap() const
-    {
-	    return this->pathMap;
-    }
+	inline bool IsFrozen() const
+	{
+		return this->isFrozen;
+	}
 
 	//Inline
 	inline uint32 AddNode(const Path& path, UniquePointer<FileSystemNodeAttributes>&& attributes)
 	{
 	    AutoLock lock(this->lock);
+		ASSERT(!this->isFrozen, u8"Can't add nodes to a frozen index");
 
 		uint32 index = this->nodeAttributes.Push(Move(attributes));
-		this->pathMap.Insert(path.IsAbsolute() ? path : u8"/" + path.String(), index);
+		uint32 entryIndex = this->InsertPathEntry(path);
+		this->pathEntries[entryIndex].nodeIndex = index;
+		this->nodePathEntries.Push(entryIndex);
 		return index;
 	}
 
+	/**
+	 * Once frozen, no more nodes can be added and lookups don't take the lock anymore.
+	 * The attributes of a node may still be changed by the one that owns the node.
+	 */
+	inline void Freeze()
+	{
+		AutoLock lock(this->lock);
+		this->isFrozen = true;
+	}
+
+	/**
+	 * @return the index of the node or Unsigned<uint32>::Max() if path is not part of the index
+	 */
+	inline uint32 FindNodeIndex(const Path& path) const
+	{
+		ReadLock lock(*this);
+
+		uint32 entryIndex = this->FindPathEntry(path);
+		if(entryIndex == Unsigned<uint32>::Max())
+			return Unsigned<uint32>::Max();
+		return this->pathEntries[entryIndex].nodeIndex;
+	}
+
 	inline const FileSystemNodeAttributes& GetNodeAttributes(uint32 index) const
 	{
-        AutoLock lock(this->lock);
+        ReadLock lock(*this);
 
 		return *this->nodeAttributes[index];
 	}
 
 	inline uint32 GetNodeIndex(const Path& path) const
 	{
-        AutoLock lock(this->lock);
-		return this->pathMap.Get(path);
+        ReadLock lock(*this);
+
+		uint32 entryIndex = this->FindPathEntry(path);
+		ASSERT(entryIndex != Unsigned<uint32>::Max(), u8"Path is not in index");
+		return this->pathEntries[entryIndex].nodeIndex;
 	}
 
-	inline const Path& GetNodePath(uint32 index) const
+	inline String GetNodeName(uint32 index) const
 	{
-		return this->pathMap.GetReverse(index);
+		ReadLock lock(*this);
+
+		return this->names[this->pathEntries[this->nodePathEntries[index]].nameId];
 	}
 
 	inline uint32 GetNumberOfNodes() const
@@ -77,17 +116,110 @@ public:
 		return this->nodeAttributes.GetNumberOfElements();
 	}
 
+	/**
+	 * @return the index of the node of the parent directory or Unsigned<uint32>::Max() if it is not part of the index
+	 */
+	inline uint32 GetParentNodeIndex(uint32 index) const
+	{
+		ReadLock lock(*this);
+
+		uint32 entryIndex = this->nodePathEntries[index];
+		if(entryIndex == c_rootPathEntryIndex)
+			return Unsigned<uint32>::Max();
+		return this->pathEntries[this->pathEntries[entryIndex].parent].nodeIndex;
+	}
+
 	inline bool HasNodeIndex(const Path& path) const
 	{
-		return this->pathMap.Contains(path);
+		ReadLock lock(*this);
+
+		uint32 entryIndex = this->FindPathEntry(path);
+		return (entryIndex != Unsigned<uint32>::Max()) and (this->pathEntries[entryIndex].nodeIndex != Unsigned<uint32>::Max());
 	}
 
 protected:
     //Members
     mutable Mutex lock;
 
+	//Methods
+	/**
+	 * Adds a node below the node with index parentNodeIndex, which must have been added before.
+	 * Unlike AddNode, the path of the parent is not resolved again.
+	 * @param name UTF-8 encoded
+	 */
+	uint32 AddChildNode(uint32 parentNodeIndex, const uint8* name, uint32 nameSize, UniquePointer<FileSystemNodeAttributes>&& attributes);
+
 private:
+	/**
+	 * Locks the index only while it is not frozen.
+	 */
+	class ReadLock
+	{
+	public:
+		//Constructor
+		inline ReadLock(const FileSystemNodeIndex& index) : mutex(index.isFrozen ? nullptr : &index.lock)
+		{
+			if(this->mutex)
+				this->mutex->Lock();
+		}
+
+		//Destructor
+		inline ~ReadLock()
+		{
+			if(this->mutex)
+				this->mutex->Unlock();
+		}
+
+	private:
+		//Members
+		Mutex* mutex;
+	};
+
+	/**
+	 * An entry in the prefix tree of all node paths.
+	 * Directories that are not part of the index themselves but have nodes below them get an entry as well.
+	 */
+	struct PathEntry
+	{
+		uint32 parent;
+		uint32 nameId;
+		uint32 nodeIndex;
+	};
+
+	//Constants
+	static const uint32 c_rootPathEntryIndex = 0;
+
 	//Members
+	bool isFrozen;
 	DynamicArray<UniquePointer<FileSystemNodeAttributes>> nodeAttributes;
-	BijectiveMap<Path, uint32> pathMap;
+	DynamicArray<PathEntry> pathEntries;
+	DynamicArray<uint32> nodePathEntries;
+	/**
+	 * Path components are stored only once, UTF-8 encoded, and are referenced by id.
+	 */
+	DynamicArray<String> names;
+	/**
+	 * Open addressing tables with linear probing (like DigestIndex).
+	 * nameSlots holds name ids and is keyed by the bytes of the name.
+	 * childSlots holds entry indices and is keyed by (parent entry index, name id) of the entry.
+	 * Empty slots are Unsigned<uint32>::Max().
+	 */
+	UniquePointer<FixedArray<uint32>> nameSlots;
+	UniquePointer<FixedArray<uint32>> childSlots;
+
+	//Methods
+	uint32 FindChildSlot(uint32 parentEntryIndex, uint32 nameId) const;
+	uint32 FindNameSlot(const uint8* name, uint32 nameSize) const;
+	uint32 FindPathEntry(const Path& path) const;
+	uint32 InsertChildEntry(uint32 parentEntryIndex, uint32 nameId);
+	uint32 InsertName(const uint8* name, uint32 nameSize);
+	uint32 InsertPathEntry(const Path& path);
+	void RehashChildren(uint32 nSlots);
+	void RehashNames(uint32 nSlots);
+
+	//Inline
+	inline const uint8* GetNameBytes(uint32 nameId) const
+	{
+		return reinterpret_cast<const uint8*>(this->names[nameId].GetRawData());
+	}
 };
\ No newline at end of file
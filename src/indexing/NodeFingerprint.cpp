@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "NodeFingerprint.hpp"
+
+//Constants
+static const uint64 c_fingerprintSampleSize = 64 * 1024;
+
+//Constructor
+NodeFingerprinter::NodeFingerprinter(uint64 size) : size(size), position(0)
+{
+	//independent of the configured hash algorithm, so that fingerprints of all snapshots can be compared
+	this->hasher = Crypto::HashFunction::CreateInstance(Crypto::HashAlgorithm::MD5);
+
+	uint8 encodedSize[8];
+	for(uint8 i = 0; i < sizeof(encodedSize); i++)
+		encodedSize[i] = static_cast<uint8>(size >> (8 * i));
+	this->hasher->Update(encodedSize, sizeof(encodedSize));
+
+	if(size <= 3 * c_fingerprintSampleSize)
+	{
+		this->nSamples = 1;
+		this->sampleOffsets[0] = 0;
+	}
+	else
+	{
+		this->nSamples = 3;
+		this->sampleOffsets[0] = 0;
+		this->sampleOffsets[1] = size / 2 - c_fingerprintSampleSize / 2;
+		this->sampleOffsets[2] = size - c_fingerprintSampleSize;
+	}
+}
+
+//Public methods
+NodeFingerprint NodeFingerprinter::Finish()
+{
+	this->hasher->Finish();
+
+	NodeFingerprint fingerprint;
+	ASSERT(this->hasher->GetDigestSize() == sizeof(fingerprint.digest), u8"Unexpected digest size");
+	this->hasher->StoreDigest(fingerprint.digest);
+	return fingerprint;
+}
+
+void NodeFingerprinter::Update(const uint8* data, uint32 size)
+{
+	uint64 begin = this->position;
+	uint64 end = this->position + size;
+	for(uint8 i = 0; i < this->nSamples; i++)
+	{
+		uint64 sampleBegin = Math::Max(this->sampleOffsets[i], begin);
+		uint64 sampleEnd = Math::Min(this->sampleOffsets[i] + this->SampleSize(), end);
+		if(sampleBegin < sampleEnd)
+			this->hasher->Update(data + (sampleBegin - begin), sampleEnd - sampleBegin);
+	}
+	this->position = end;
+}
+
+//Private methods
+uint64 NodeFingerprinter::SampleSize() const
+{
+	if(this->nSamples == 1)
+		return this->size;
+	return c_fingerprintSampleSize;
+}
+
+//Class functions
+NodeFingerprint NodeFingerprinter::Compute(InputStream& inputStream, uint64 size)
+{
+	NodeFingerprinter fingerprinter(size);
+	FixedArray<uint8> buffer(c_fingerprintSampleSize);
+
+	uint64 position = 0;
+	for(uint8 i = 0; i < fingerprinter.nSamples; i++)
+	{
+		uint64 offset = fingerprinter.sampleOffsets[i];
+		while(position < offset)
+		{
+			uint32 nBytesSkipped = inputStream.Skip(Math::Min(offset - position, (uint64)Unsigned<uint32>::Max()));
+			if(nBytesSkipped == 0)
+				return fingerprinter.Finish(); //the data is shorter than expected
+			position += nBytesSkipped;
+		}
+
+		fingerprinter.position = position;
+		uint64 nBytesLeft = fingerprinter.SampleSize();
+		while(nBytesLeft)
+		{
+			uint32 nBytesRead = inputStream.ReadBytes(buffer.Data(), Math::Min(nBytesLeft, c_fingerprintSampleSize));
+			if(nBytesRead == 0)
+				return fingerprinter.Finish();
+
+			fingerprinter.Update(buffer.Data(), nBytesRead);
+			nBytesLeft -= nBytesRead;
+			position += nBytesRead;
+		}
+	}
+
+	return fingerprinter.Finish();
+}
+
+uint64 NodeFingerprinter::SampledSize(uint64 size)
+{
+	return Math::Min(size, 3 * c_fingerprintSampleSize);
+}
+
+//FingerprintingInputStream public methods
+uint32 FingerprintingInputStream::GetBytesAvailable() const
+{
+	return this->inputStream.GetBytesAvailable();
+}
+
+bool FingerprintingInputStream::IsAtEnd() const
+{
+	return this->inputStream.IsAtEnd();
+}
+
+uint32 FingerprintingInputStream::ReadBytes(void *destination, uint32 count)
+{
+	uint32 nBytesRead = this->inputStream.ReadBytes(destination, count);
+	this->fingerprinter.Update(static_cast<const uint8 *>(destination), nBytesRead);
+	return nBytesRead;
+}
+
+uint32 FingerprintingInputStream::Skip(uint32 nBytes)
+{
+	//skipped data still needs to be fingerprinted
+	uint8 buffer[4096];
+	uint32 nBytesSkipped = 0;
+	while(nBytesSkipped < nBytes)
+	{
+		uint32 nBytesRead = this->ReadBytes(buffer, Math::Min(nBytes - nBytesSkipped, (uint32)sizeof(buffer)));
+		if(nBytesRead == 0)
+			break;
+		nBytesSkipped += nBytesRead;
+	}
+	return nBytesSkipped;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+
+/**
+ * Cheap fingerprint of the data of a node, computed over the size and the first, middle and last
+ * c_fingerprintSampleSize bytes. Nodes with different fingerprints have different data, while equal fingerprints only
+ * indicate that the data might be equal.
+ */
+struct NodeFingerprint
+{
+	uint8 digest[16];
+
+	//Inline operators
+	inline bool operator==(const NodeFingerprint& other) const
+	{
+		return MemCmp(this->digest, other.digest, sizeof(this->digest)) == 0;
+	}
+
+	inline bool operator!=(const NodeFingerprint& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+class NodeFingerprinter
+{
+public:
+	//Constructor
+	NodeFingerprinter(uint64 size);
+
+	//Methods
+	NodeFingerprint Finish();
+	/**
+	 * Passes the data of the node, which has to be in order and without gaps.
+	 */
+	void Update(const uint8* data, uint32 size);
+
+	//Class functions
+	/**
+	 * Reads only the sampled parts of the data.
+	 */
+	static NodeFingerprint Compute(InputStream& inputStream, uint64 size);
+	/**
+	 * @return how many bytes of data with the given size are read for computing the fingerprint
+	 */
+	static uint64 SampledSize(uint64 size);
+
+private:
+	//Members
+	UniquePointer<Crypto::HashFunction> hasher;
+	uint64 size;
+	uint64 position;
+	uint64 sampleOffsets[3];
+	uint8 nSamples;
+
+	//Methods
+	uint64 SampleSize() const;
+};
+
+/**
+ * Computes the fingerprint of the data that is read through it.
+ */
+class FingerprintingInputStream : public InputStream
+{
+public:
+	//Constructor
+	inline FingerprintingInputStream(InputStream& inputStream, NodeFingerprinter& fingerprinter) : inputStream(inputStream), fingerprinter(fingerprinter)
+	{
+	}
+
+	//Methods
+	uint32 GetBytesAvailable() const override;
+	bool IsAtEnd() const override;
+	uint32 ReadBytes(void *destination, uint32 count) override;
+	uint32 Skip(uint32 nBytes) override;
+
+private:
+	//Members
+	InputStream& inputStream;
+	NodeFingerprinter& fingerprinter;
+};
@@ -18,19 +18,55 @@
  */
 //Class header
 #include "OSFileSystemNodeIndex.hpp"
+//Global
+#ifdef XPC_OS_LINUX
+#include <sys/stat.h>
+#endif
 //Local
 #include "../InjectionContainer.hpp"
 #include "../status/StatusTracker.hpp"
 #include "LinkPointsOutOfIndexDirException.hpp"
 #include "../config/ConfigManager.hpp"
 #include "../StreamPipingFailedException.hpp"
+#include "../Util.hpp"
 #include "Filtering/ThumbsDbFilter.hpp"
 #include "Filtering/DesktopIniFilter.hpp"
 #include "Filtering/AppleDoubleFilter.hpp"
 #include "Filtering/AppleDesktopServicesStoreFilter.hpp"
 
+//Local functions
+#ifdef XPC_OS_LINUX
+/**
+ * @param changeTime set to the time the inode of the node was last changed
+ * @return nullptr if the node could not be queried
+ */
+static UniquePointer<FileSystemNodeAttributes> ReadNodeAttributes(const Path& fileSystemPath, Optional<DateTime>& changeTime)
+{
+	String fileSystemPathUtf8 = fileSystemPath.String().ToUTF8();
+	struct stat nodeStat;
+	if(lstat(reinterpret_cast<const char*>(fileSystemPathUtf8.GetRawZeroTerminatedData()), &nodeStat) != 0)
+		return nullptr;
+
+	FileType type = FileType::File;
+	if(S_ISDIR(nodeStat.st_mode))
+		type = FileType::Directory;
+	else if(S_ISLNK(nodeStat.st_mode))
+		type = FileType::Link;
+
+	int64 lastModified = int64(nodeStat.st_mtim.tv_sec) * 1000 + nodeStat.st_mtim.tv_nsec / 1000000;
+	changeTime = MillisecondsToDateTime(int64(nodeStat.st_ctim.tv_sec) * 1000 + nodeStat.st_ctim.tv_nsec / 1000000);
+	UniquePointer<FileSystemNodeAttributes> attributes = new FileSystemNodeAttributes(type, (type == FileType::Directory) ? 0 : static_cast<uint64>(nodeStat.st_size),
+		MillisecondsToDateTime(lastModified), new POSIXPermissions(nodeStat.st_uid, nodeStat.st_gid, nodeStat.st_mode & 07777));
+	if(type != FileType::Directory)
+		attributes->Identity({ .deviceId = static_cast<uint64>(nodeStat.st_dev), .inode = static_cast<uint64>(nodeStat.st_ino) });
+
+	return attributes;
+}
+#endif
+
 //Constructor
-OSFileSystemNodeIndex::OSFileSystemNodeIndex(const Path &path) : basePath(path)
+OSFileSystemNodeIndex::OSFileSystemNodeIndex(const Path &path, SourceScanCache* scanCache, const IncrementalScanSource* incrementalSource)
+	: basePath(path), scanCache(scanCache), incrementalSource(incrementalSource)
 {
     this->fileFilters.Push(new AppleDesktopServicesStoreFilter);
 	this->fileFilters.Push(new AppleDoubleFilter);
@@ -41,18 +77,38 @@ OSFileSystemNodeIndex::OSFileSystemNodeIndex(const Path &path) : basePath(path)
 }
 
 //Public methods
-String OSFileSystemNodeIndex::ComputeNodeHash(uint32 nodeIndex) const
+NodeFingerprint OSFileSystemNodeIndex::ComputeNodeFingerprint(uint32 nodeIndex) const
+{
+	const FileSystemNodeAttributes& attributes = this->GetNodeAttributes(nodeIndex);
+	ASSERT(attributes.Type() != FileType::Directory, u8"Can't fingerprint directory");
+
+	const Path &nodePath = this->GetNodePath(nodeIndex);
+
+	if(attributes.Type() == FileType::File)
+		return NodeFingerprinter::Compute(*this->OpenFile(nodePath), attributes.Size());
+	return NodeFingerprinter::Compute(*this->OpenLinkTargetAsStream(nodePath), attributes.Size());
+}
+
+Digest OSFileSystemNodeIndex::ComputeNodeHash(uint32 nodeIndex) const
 {
 	const FileSystemNodeAttributes& attributes = this->GetNodeAttributes(nodeIndex);
 	ASSERT(attributes.Type() != FileType::Directory, u8"Can't hash directory");
 
 	const Path &nodePath = this->GetNodePath(nodeIndex);
 
-	UniquePointer<InputStream> inputStream;
+	UniquePointer<SeekableInputStream> fileInputStream;
+	UniquePointer<InputStream> linkInputStream;
+	InputStream* inputStream;
 	if(attributes.Type() == FileType::File)
-		inputStream = this->OpenFile(nodePath);
-	else if(attributes.Type() == FileType::Link)
-		inputStream = this->OpenLinkTargetAsStream(nodePath);
+	{
+		fileInputStream = this->OpenFile(nodePath);
+		inputStream = fileInputStream.operator->();
+	}
+	else
+	{
+		linkInputStream = this->OpenLinkTargetAsStream(nodePath);
+		inputStream = linkInputStream.operator->();
+	}
 
 	InjectionContainer &injectionContainer = InjectionContainer::Instance();
 	const Config &config = injectionContainer.Config();
@@ -65,7 +121,7 @@ String OSFileSystemNodeIndex::ComputeNodeHash(uint32 nodeIndex) const
 	if(readSize != attributes.Size())
 		throw StreamPipingFailedException(nodePath);
 
-	return hasher->GetDigestString().ToLowercase();
+	return Digest::FromHashFunction(*hasher);
 }
 
 UniquePointer<InputStream> OSFileSystemNodeIndex::OpenLinkTargetAsStream(const Path& nodePath) const
@@ -75,48 +131,158 @@ UniquePointer<InputStream> OSFileSystemNodeIndex::OpenLinkTargetAsStream(const P
 	return new StringInputStream(linkTarget.String(), true);
 }
 
-UniquePointer<InputStream> OSFileSystemNodeIndex::OpenFile(const Path &filePath) const
+UniquePointer<SeekableInputStream> OSFileSystemNodeIndex::OpenFile(const Path &filePath) const
 {
 	return new FileInputStream(this->MapNodePathToFileSystemPath(filePath));
 }
 
 //Private methods
+void OSFileSystemNodeIndex::AddScannedNodes(ScannedNode& node)
+{
+	this->AddNode(node.path, Move(node.attributes));
+	for(const auto& kv : node.children)
+		this->AddScannedNodes(*kv.value);
+}
+
+void OSFileSystemNodeIndex::EnqueueDirectoryScan(ScannedNode& directory, ProcessStatus& findStatus)
+{
+	InjectionContainer::Instance().TaskQueue().EnqueueTask([this, &directory, &findStatus]()
+	{
+		try
+		{
+			this->ScanDirectory(directory, findStatus);
+		}
+		catch(const LinkPointsOutOfIndexDirException&)
+		{
+			this->linkPointsOutOfIndexDir = true;
+		}
+		catch(const Exception& e)
+		{
+			//the other directories are still scanned, all failures are reported together once the walk is finished
+			AutoLock lock(this->scanFailuresLock);
+			this->scanFailures.Push({ .directoryPath = directory.path, .reason = e.Description() });
+		}
+	});
+}
+
 void OSFileSystemNodeIndex::GenerateIndex()
 {
 	InjectionContainer& ic = InjectionContainer::Instance();
 
 	ProcessStatus& findStatus = ic.StatusTracker().AddProcessStatusTracker(u8"Reading directory");
-	this->IndexFile(String(u8"/"), findStatus);
+
+	//directories are read in parallel. Nodes are added only afterwards and sorted by name, so that the index does not depend on the scheduling
+	ScannedNode root;
+	root.path = String(u8"/");
+	this->linkPointsOutOfIndexDir = false;
+	this->nFileSystemQueries = 1;
+	this->nReusedNodes = 0;
+	if(this->ScanNode(root, File(this->basePath).Type(), findStatus) and (root.attributes->Type() == FileType::Directory))
+		this->EnqueueDirectoryScan(root, findStatus);
+	ic.TaskQueue().WaitForAllTasksToComplete();
+
+	if(this->linkPointsOutOfIndexDir)
+		throw LinkPointsOutOfIndexDirException();
+	if(!this->scanFailures.IsEmpty())
+	{
+		this->scanFailures.Sort();
+		throw DirectoryScanFailedException(Move(this->scanFailures));
+	}
+
+	this->AddScannedNodes(root);
 	findStatus.Finished();
+	this->scanDuration = findStatus.GetDurationInMicroseconds();
+
+	this->Freeze();
 }
 
-void OSFileSystemNodeIndex::IndexDirectoryChildren(const Path& path, ProcessStatus& findStatus)
+void OSFileSystemNodeIndex::ScanDirectory(ScannedNode& directory, ProcessStatus& findStatus)
 {
-	File dir(this->MapNodePathToFileSystemPath(path));
+	const Optional<DateTime>& lastModifiedTime = directory.attributes->LastModifiedTime();
 
-	for(const DirectoryEntry& child : dir)
+	DynamicArray<CachedDirectoryEntry> entries;
+	if(directory.previousNodeIndex != Unsigned<uint32>::Max())
+	{
+		//the listing did not change since the previous snapshot
+		const BackupNodeIndex& previousIndex = this->incrementalSource->previousIndex;
+		for(uint32 childIndex : previousIndex.ChildrenOf(directory.previousNodeIndex))
+			entries.Push({ .name = previousIndex.GetNodeName(childIndex), .type = previousIndex.GetNodeAttributes(childIndex).Type() });
+	}
+	else
 	{
-		this->IndexFile(path / child.name, findStatus);
+		const DynamicArray<CachedDirectoryEntry>* cachedEntries = this->scanCache ? this->scanCache->FindListing(directory.path, lastModifiedTime, directory.changeTime) : nullptr;
+		if(cachedEntries)
+			entries = *cachedEntries;
+		else
+		{
+			File dir(this->MapNodePathToFileSystemPath(directory.path));
+			this->nFileSystemQueries++;
+
+			for(const DirectoryEntry& child : dir)
+				entries.Push({ .name = child.name, .type = child.type });
+		}
+	}
+
+	if(this->scanCache)
+		this->scanCache->RecordListing(directory.path, lastModifiedTime, directory.changeTime, entries);
+
+	for(const CachedDirectoryEntry& child : entries)
+	{
+		UniquePointer<ScannedNode> childNode = new ScannedNode;
+		childNode->path = directory.path / child.name;
+		if(!this->ScanNode(*childNode, child.type, findStatus))
+			continue;
+
+		ScannedNode& scannedChild = *childNode;
+		directory.children.Insert(child.name, Move(childNode));
+		if(scannedChild.attributes->Type() == FileType::Directory)
+			this->EnqueueDirectoryScan(scannedChild, findStatus);
 	}
 }
 
-void OSFileSystemNodeIndex::IndexFile(const Path& filePath, ProcessStatus& findStatus)
+bool OSFileSystemNodeIndex::ScanNode(ScannedNode& node, FileType entryType, ProcessStatus& findStatus)
 {
-	File file(this->MapNodePathToFileSystemPath(filePath));
+	//the directory listing already tells the type, only query the node once for the remaining metadata
+	if( (entryType == FileType::File) and !this->ShouldFileBeIndexed(node.path) )
+		return false;
+
+	if(this->incrementalSource and !this->incrementalSource->journal.IsDirty(node.path))
+	{
+		const BackupNodeIndex& previousIndex = this->incrementalSource->previousIndex;
+		uint32 previousNodeIndex = previousIndex.FindNodeIndex(node.path);
+		if(previousNodeIndex != Unsigned<uint32>::Max())
+		{
+			node.attributes = new FileSystemNodeAttributes(previousIndex.GetNodeAttributes(previousNodeIndex));
+			node.previousNodeIndex = previousNodeIndex;
+			this->nReusedNodes++;
+
+			findStatus.AddTotalSize(node.attributes->Size());
+			findStatus.IncFileCount();
+			return true;
+		}
+	}
 
-	if( (file.Type() == FileType::File) and !this->ShouldFileBeIndexed(filePath) )
-		return;
-	if(file.Type() == FileType::Link)
-		this->VerifyThatLinkPointsInsideBackupPath(filePath, file);
+	File file(this->MapNodePathToFileSystemPath(node.path));
+	if(entryType == FileType::Link)
+	{
+		this->VerifyThatLinkPointsInsideBackupPath(node.path, file);
+		this->nFileSystemQueries++;
+	}
 
-	UniquePointer<FileSystemNodeAttributes> attributes = new FileSystemNodeAttributes(file.Info());
+#ifdef XPC_OS_LINUX
+	//a single lstat gives the attributes as well as the identity, which allows to recognize renamed nodes without reading their data
+	node.attributes = ReadNodeAttributes(file.Path(), node.changeTime);
+	if(node.attributes.IsNull())
+		node.attributes = new FileSystemNodeAttributes(file.Info());
+#else
+	node.attributes = new FileSystemNodeAttributes(file.Info());
+#endif
+	this->nFileSystemQueries++;
 
-	findStatus.AddTotalSize(attributes->Size());
-	this->AddNode(filePath, Move(attributes));
+	findStatus.AddTotalSize(node.attributes->Size());
 	findStatus.IncFileCount();
 
-	if(file.Type() == FileType::Directory)
-		this->IndexDirectoryChildren(filePath, findStatus);
+	return true;
 }
 
 bool OSFileSystemNodeIndex::ShouldFileBeIndexed(const Path &filePath) const
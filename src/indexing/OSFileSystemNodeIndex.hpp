@@ -24,27 +24,101 @@ using namespace StdXX::FileSystem;
 #include "FileSystemNodeIndex.hpp"
 #include "../status/ProcessStatus.hpp"
 #include "Filtering/FileFilter.hpp"
+#include "SourceScanCache.hpp"
+#include "DirtyPathJournal.hpp"
+#include "NodeFingerprint.hpp"
+#include "DirectoryScanFailedException.hpp"
+#include "../backup/BackupNodeIndex.hpp"
+
+/**
+ * The index of the newest snapshot together with the paths that were changed since it was created.
+ */
+struct IncrementalScanSource
+{
+	const BackupNodeIndex& previousIndex;
+	const DirtyPathJournal& journal;
+};
 
 class OSFileSystemNodeIndex : public FileSystemNodeIndex
 {
 public:
 	//Constructor
-	OSFileSystemNodeIndex(const Path& path);
+	/**
+	 * @param scanCache - if set, directories that were not modified since the last scan are not read again and the
+	 * listings of this scan are recorded in it
+	 * @param incrementalSource - if set, nodes that were not changed according to the journal are taken from the previous
+	 * index instead of querying the file system
+	 */
+	OSFileSystemNodeIndex(const Path& path, SourceScanCache* scanCache = nullptr, const IncrementalScanSource* incrementalSource = nullptr);
+
+	//Properties
+	/**
+	 * Number of metadata queries (stat, readdir, readlink) that were issued while reading the directory tree.
+	 */
+	inline uint64 NumberOfFileSystemQueries() const
+	{
+		return this->nFileSystemQueries;
+	}
+
+	/**
+	 * Time in microseconds that reading the directory tree took.
+	 */
+	inline uint64 ScanDuration() const
+	{
+		return this->scanDuration;
+	}
+
+	/**
+	 * Number of nodes that were taken from the previous index because they did not change.
+	 */
+	inline uint64 NumberOfReusedNodes() const
+	{
+		return this->nReusedNodes;
+	}
 
 	//Methods
-	String ComputeNodeHash(uint32 nodeIndex) const;
+	NodeFingerprint ComputeNodeFingerprint(uint32 nodeIndex) const;
+	Digest ComputeNodeHash(uint32 nodeIndex) const;
 	UniquePointer<InputStream> OpenLinkTargetAsStream(const Path& nodePath) const;
-	UniquePointer<InputStream> OpenFile(const Path& filePath) const;
+	/**
+	 * The stream is seekable, so that the file can be probed before it is read sequentially.
+	 */
+	UniquePointer<SeekableInputStream> OpenFile(const Path& filePath) const;
 
 private:
+	/**
+	 * A node that was found while reading the directory tree but is not yet part of the index.
+	 */
+	struct ScannedNode
+	{
+		Path path;
+		UniquePointer<FileSystemNodeAttributes> attributes;
+		Optional<DateTime> changeTime; //only known where the platform provides it
+		uint32 previousNodeIndex = Unsigned<uint32>::Max();
+		BinaryTreeMap<String, UniquePointer<ScannedNode>> children;
+	};
+
 	//Members
 	Path basePath;
 	DynamicArray<UniquePointer<FileFilter>> fileFilters;
+	SourceScanCache* scanCache;
+	const IncrementalScanSource* incrementalSource;
+	uint64 scanDuration;
+	Atomic<bool> linkPointsOutOfIndexDir;
+	Atomic<uint64> nFileSystemQueries;
+	Atomic<uint64> nReusedNodes;
+	Mutex scanFailuresLock;
+	DynamicArray<DirectoryScanFailedException::Failure> scanFailures;
 
 	//Methods
+	void AddScannedNodes(ScannedNode& node);
+	void EnqueueDirectoryScan(ScannedNode& directory, ProcessStatus& findStatus);
 	void GenerateIndex();
-	void IndexDirectoryChildren(const Path& path, ProcessStatus& findStatus);
-	void IndexFile(const Path& nodePath, ProcessStatus& findStatus);
+	void ScanDirectory(ScannedNode& directory, ProcessStatus& findStatus);
+	/**
+	 * @param entryType - the type of the node as reported by the directory listing
+	 */
+	bool ScanNode(ScannedNode& node, FileType entryType, ProcessStatus& findStatus);
 	bool ShouldFileBeIndexed(const Path& filePath) const;
 	void VerifyThatLinkPointsInsideBackupPath(const Path& filePath, const File& file);
 
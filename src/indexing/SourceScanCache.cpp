@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "SourceScanCache.hpp"
+//Local
+#include "../Util.hpp"
+
+//Constants
+static const uint8 c_scanCacheMagic[4] = { 'A', 'C', 'S', 'C' };
+static const uint16 c_scanCacheVersion = 2;
+
+//Local functions
+static String ReadString(DataReader& dataReader)
+{
+	uint32 length = dataReader.ReadUInt32();
+	FixedArray<uint8> bytes(length);
+	dataReader.ReadBytes(bytes.Data(), length);
+	return String::CopyUtf8Bytes(bytes.Data(), length);
+}
+
+static void WriteString(DataWriter& dataWriter, const String& string)
+{
+	String utf8 = string.ToUTF8();
+	dataWriter.WriteUInt32(utf8.GetSize());
+	dataWriter.WriteBytes(utf8.GetRawData(), utf8.GetSize());
+}
+
+//Constructor
+SourceScanCache::SourceScanCache(const Path& dirPath) : dirPath(dirPath), scanStartTime(DateTimeToMilliseconds(DateTime::Now()))
+{
+	File file(dirPath / this->c_cacheFileName);
+	if(!file.Exists())
+		return; //no scan was done yet
+
+	try
+	{
+		FileInputStream fileInputStream(file.Path());
+		BufferedInputStream bufferedInputStream(fileInputStream);
+		this->Read(bufferedInputStream);
+	}
+	catch(const Exception&)
+	{
+		//the cache is only an optimization, scan everything if it can't be read
+		this->lastListings.Release();
+	}
+}
+
+//Public methods
+const DynamicArray<CachedDirectoryEntry>* SourceScanCache::FindListing(const Path& directoryPath, const Optional<DateTime>& lastModifiedTime, const Optional<DateTime>& changeTime) const
+{
+	if(!lastModifiedTime.HasValue() or !this->lastListings.Contains(directoryPath))
+		return nullptr;
+
+	const Listing& listing = this->lastListings[directoryPath];
+	if(listing.lastModifiedTime != DateTimeToMilliseconds(*lastModifiedTime))
+		return nullptr;
+	if(listing.changeTime.HasValue() != changeTime.HasValue())
+		return nullptr;
+	if(changeTime.HasValue() and (*listing.changeTime != DateTimeToMilliseconds(*changeTime)))
+		return nullptr;
+	return &listing.entries;
+}
+
+void SourceScanCache::RecordListing(const Path& directoryPath, const Optional<DateTime>& lastModifiedTime, const Optional<DateTime>& changeTime, const DynamicArray<CachedDirectoryEntry>& entries)
+{
+	if(!lastModifiedTime.HasValue())
+		return;
+
+	Listing listing;
+	listing.lastModifiedTime = DateTimeToMilliseconds(*lastModifiedTime);
+	if(changeTime.HasValue())
+		listing.changeTime = DateTimeToMilliseconds(*changeTime);
+
+	//a directory that is modified while it is scanned could change again within the same timestamp
+	if( (listing.lastModifiedTime >= this->scanStartTime) or (listing.changeTime.HasValue() and (*listing.changeTime >= this->scanStartTime)) )
+		return;
+
+	listing.entries = entries;
+
+	AutoLock lock(this->currentListingsLock);
+	this->currentListings.Insert(directoryPath, Move(listing));
+}
+
+void SourceScanCache::Write() const
+{
+	FileOutputStream fileOutputStream(this->dirPath / this->c_cacheFileName, true);
+	BufferedOutputStream bufferedOutputStream(fileOutputStream);
+	DataWriter dataWriter(false, bufferedOutputStream);
+
+	dataWriter.WriteBytes(c_scanCacheMagic, sizeof(c_scanCacheMagic));
+	dataWriter.WriteUInt16(c_scanCacheVersion);
+	dataWriter.WriteUInt32(this->currentListings.GetNumberOfElements());
+	for(const auto& kv : this->currentListings)
+	{
+		WriteString(dataWriter, kv.key.String());
+		dataWriter.WriteUInt64(kv.value.lastModifiedTime);
+		dataWriter.WriteByte(kv.value.changeTime.HasValue());
+		dataWriter.WriteUInt64(kv.value.changeTime.HasValue() ? *kv.value.changeTime : 0);
+		dataWriter.WriteUInt32(kv.value.entries.GetNumberOfElements());
+		for(const CachedDirectoryEntry& entry : kv.value.entries)
+		{
+			dataWriter.WriteByte(static_cast<uint8>(entry.type));
+			WriteString(dataWriter, entry.name);
+		}
+	}
+
+	bufferedOutputStream.Flush();
+}
+
+//Private methods
+void SourceScanCache::Read(InputStream& inputStream)
+{
+	DataReader dataReader(false, inputStream);
+
+	uint8 magic[sizeof(c_scanCacheMagic)];
+	dataReader.ReadBytes(magic, sizeof(magic));
+	if( (MemCmp(magic, c_scanCacheMagic, sizeof(magic)) != 0) or (dataReader.ReadUInt16() != c_scanCacheVersion) )
+		return;
+
+	uint32 nListings = dataReader.ReadUInt32();
+	for(uint32 i = 0; i < nListings; i++)
+	{
+		Path directoryPath = ReadString(dataReader);
+
+		Listing listing;
+		listing.lastModifiedTime = dataReader.ReadUInt64();
+		bool hasChangeTime = dataReader.ReadByte() != 0;
+		int64 changeTime = dataReader.ReadUInt64();
+		if(hasChangeTime)
+			listing.changeTime = changeTime;
+
+		uint32 nEntries = dataReader.ReadUInt32();
+		listing.entries.EnsureCapacity(nEntries);
+		for(uint32 j = 0; j < nEntries; j++)
+		{
+			FileType type = static_cast<FileType>(dataReader.ReadByte());
+			listing.entries.Push({ .name = ReadString(dataReader), .type = type });
+		}
+
+		this->lastListings.Insert(directoryPath, Move(listing));
+	}
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+using namespace StdXX::FileSystem;
+
+struct CachedDirectoryEntry
+{
+	String name;
+	FileType type;
+};
+
+/**
+ * Persists the directory listings of the last scan of the source directory.
+ * A directory whose last modified time and inode change time did not change since then still has the same children, so
+ * it does not need to be read again. Only the metadata of its children needs to be queried.
+ * The change time is compared as well because the last modified time can be set back by tools that restore it.
+ */
+class SourceScanCache
+{
+	struct Listing
+	{
+		int64 lastModifiedTime; //see DateTimeToMilliseconds
+		Optional<int64> changeTime;
+		DynamicArray<CachedDirectoryEntry> entries;
+	};
+public:
+	//Constructor
+	explicit SourceScanCache(const Path& dirPath);
+
+	//Methods
+	/**
+	 * @return the listing of the last scan or nullptr if the directory was modified since then or is unknown
+	 */
+	const DynamicArray<CachedDirectoryEntry>* FindListing(const Path& directoryPath, const Optional<DateTime>& lastModifiedTime, const Optional<DateTime>& changeTime) const;
+	void RecordListing(const Path& directoryPath, const Optional<DateTime>& lastModifiedTime, const Optional<DateTime>& changeTime, const DynamicArray<CachedDirectoryEntry>& entries);
+	void Write() const;
+
+private:
+	//Constants
+	const String c_cacheFileName = u8"source_scan_cache.bin";
+
+	//Members
+	Path dirPath;
+	int64 scanStartTime;
+	BinaryTreeMap<Path, Listing> lastListings;
+	BinaryTreeMap<Path, Listing> currentListings;
+	Mutex currentListingsLock;
+
+	//Methods
+	void Read(InputStream& inputStream);
+};
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "SourceWatcher.hpp"
+//Global
+#ifdef XPC_OS_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+//Constants
+static const char* c_watcherLockFileName = u8"watch.lock";
+static const char* c_watcherSynchronizationFileName = u8"watch.sync";
+static const uint64 c_synchronizationTimeout = uint64(5) * 1000 * 1000 * 1000; //in nanoseconds
+static const uint64 c_synchronizationPollInterval = 10 * 1000 * 1000; //in nanoseconds
+
+#ifdef XPC_OS_LINUX
+static const uint32 c_watchMask = IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_DONTFOLLOW | IN_ONLYDIR;
+#endif
+
+//Constructor
+SourceWatcher::SourceWatcher(const Path& sourcePath, const Path& backupPath) : sourcePath(sourcePath), backupPath(backupPath), journal(backupPath)
+{
+	this->notifyFd = -1;
+	this->lockFd = -1;
+	this->backupDirWatch = -1;
+	this->rootWatch = -1;
+}
+
+//Destructor
+SourceWatcher::~SourceWatcher()
+{
+#ifdef XPC_OS_LINUX
+	if(this->notifyFd != -1)
+		close(this->notifyFd);
+	if(this->lockFd != -1)
+		close(this->lockFd);
+#endif
+}
+
+//Public methods
+void SourceWatcher::Run()
+{
+#ifdef XPC_OS_LINUX
+	alignas(struct inotify_event) uint8 buffer[64 * 1024];
+	while(this->rootWatch != -1)
+	{
+		ssize_t nBytesRead = read(this->notifyFd, buffer, sizeof(buffer));
+		if(nBytesRead <= 0)
+		{
+			if( (nBytesRead == -1) and (errno == EINTR) )
+				continue;
+			this->journal.AppendOverflow(); //changes from now on are not recorded
+			break;
+		}
+
+		bool synchronizationRequested = false;
+		for(ssize_t offset = 0; offset < nBytesRead;)
+		{
+			const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+			offset += sizeof(struct inotify_event) + event->len;
+
+			if(event->mask & IN_Q_OVERFLOW)
+			{
+				this->journal.AppendOverflow();
+				continue;
+			}
+
+			String name;
+			if(event->len > 0)
+				name = String::CopyUtf8Bytes(reinterpret_cast<const uint8*>(event->name), strlen(event->name));
+			this->HandleEvent(event->wd, event->mask, name, synchronizationRequested);
+		}
+
+		this->FlushDirtyPaths();
+		if(synchronizationRequested)
+		{
+			String syncPath = (this->backupPath / String(c_watcherSynchronizationFileName)).String().ToUTF8();
+			unlink(reinterpret_cast<const char*>(syncPath.GetRawZeroTerminatedData()));
+		}
+	}
+#endif
+}
+
+bool SourceWatcher::Start()
+{
+#ifdef XPC_OS_LINUX
+	String lockPath = (this->backupPath / String(c_watcherLockFileName)).String().ToUTF8();
+	this->lockFd = open(reinterpret_cast<const char*>(lockPath.GetRawZeroTerminatedData()), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if(this->lockFd == -1)
+		return false;
+	if(flock(this->lockFd, LOCK_EX | LOCK_NB) != 0)
+		return false; //another watcher was started in the meantime
+
+	this->notifyFd = inotify_init1(IN_CLOEXEC);
+	if(this->notifyFd == -1)
+		return false;
+
+	String backupPathUtf8 = this->backupPath.String().ToUTF8();
+	this->backupDirWatch = inotify_add_watch(this->notifyFd, reinterpret_cast<const char*>(backupPathUtf8.GetRawZeroTerminatedData()), IN_CLOSE_WRITE);
+	if(this->backupDirWatch == -1)
+		return false;
+
+	//changes that happen before all watches are set up are unknown
+	this->journal.AppendStart();
+	if(!this->WatchDirectory(String(u8"/")))
+	{
+		this->journal.AppendOverflow();
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+//Private methods
+void SourceWatcher::FlushDirtyPaths()
+{
+	if(this->dirtyNodes.IsEmpty() and this->dirtySubtrees.IsEmpty())
+		return;
+
+	this->journal.AppendDirtyPaths(this->dirtyNodes, this->dirtySubtrees);
+	this->dirtyNodes.Release();
+	this->dirtySubtrees.Release();
+}
+
+void SourceWatcher::HandleEvent(int watch, uint32 mask, const String& name, bool& synchronizationRequested)
+{
+#ifdef XPC_OS_LINUX
+	if(watch == this->backupDirWatch)
+	{
+		if(name == String(c_watcherSynchronizationFileName))
+			synchronizationRequested = true;
+		return;
+	}
+
+	if(!this->watchedDirectories.Contains(watch))
+		return;
+	Path directoryPath = this->watchedDirectories[watch];
+
+	if( (watch == this->rootWatch) and (mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) )
+	{
+		//the source directory is gone, the paths of all nodes are unknown from now on
+		this->journal.AppendOverflow();
+		this->rootWatch = -1;
+		return;
+	}
+
+	if(mask & IN_IGNORED)
+	{
+		this->watchedDirectories.Remove(watch);
+		return;
+	}
+
+	if(mask & IN_MOVE_SELF)
+	{
+		//a move within the source directory already updated the path of the watch. Otherwise the directory left it
+		File directory(this->sourcePath.String() + directoryPath.String());
+		if(!directory.Exists())
+			inotify_rm_watch(this->notifyFd, watch);
+		return;
+	}
+
+	if(mask & IN_DELETE_SELF)
+		return; //the parent reports the deletion and the watch is ignored afterwards
+
+	if(name.IsEmpty())
+	{
+		//event for the watched directory itself
+		if(mask & IN_ATTRIB)
+			this->dirtyNodes.Insert(directoryPath);
+		return;
+	}
+
+	Path nodePath = directoryPath / name;
+	this->dirtyNodes.Insert(nodePath);
+	if(mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO))
+		this->dirtyNodes.Insert(directoryPath); //the listing changed
+
+	if( (mask & IN_ISDIR) and (mask & (IN_CREATE | IN_MOVED_TO)) )
+	{
+		//nodes might have been created in the new directory before it is watched
+		this->dirtySubtrees.Insert(nodePath);
+		this->WatchDirectory(nodePath);
+	}
+#endif
+}
+
+bool SourceWatcher::WatchDirectory(const Path& nodePath)
+{
+#ifdef XPC_OS_LINUX
+	Path fileSystemPath = this->sourcePath.String() + nodePath.String();
+	String fileSystemPathUtf8 = fileSystemPath.String().ToUTF8();
+
+	//a directory that is already watched (i.e. it was moved) keeps its watch descriptor, only its path is updated
+	int watch = inotify_add_watch(this->notifyFd, reinterpret_cast<const char*>(fileSystemPathUtf8.GetRawZeroTerminatedData()), c_watchMask);
+	if(watch == -1)
+	{
+		if(errno != ENOENT)
+			this->journal.AppendOverflow(); //e.g. the watch limit is reached, changes in this directory would be missed
+		return false;
+	}
+	this->watchedDirectories[watch] = nodePath;
+	if(nodePath.String() == u8"/")
+		this->rootWatch = watch;
+
+	try
+	{
+		File directory(fileSystemPath);
+		for(const DirectoryEntry& child : directory)
+		{
+			if(child.type == FileType::Directory)
+				this->WatchDirectory(nodePath / child.name);
+		}
+	}
+	catch(const Exception&)
+	{
+		//the directory was removed in the meantime, the event for that is already queued
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+//Class functions
+bool SourceWatcher::IsRunning(const Path& backupPath)
+{
+#ifdef XPC_OS_LINUX
+	String lockPath = (backupPath / String(c_watcherLockFileName)).String().ToUTF8();
+	int fd = open(reinterpret_cast<const char*>(lockPath.GetRawZeroTerminatedData()), O_RDONLY | O_CLOEXEC);
+	if(fd == -1)
+		return false;
+
+	bool isLocked = flock(fd, LOCK_SH | LOCK_NB) != 0;
+	close(fd);
+	return isLocked;
+#else
+	return false;
+#endif
+}
+
+bool SourceWatcher::Synchronize(const Path& backupPath)
+{
+	if(!IsRunning(backupPath))
+		return false;
+
+	//the watcher removes the file as soon as it handled the notification for it. As the kernel reports events in order,
+	//all changes before have been recorded by then
+	File syncFile(backupPath / String(c_watcherSynchronizationFileName));
+	{
+		FileOutputStream fileOutputStream(syncFile.Path(), true);
+	}
+
+	for(uint64 waited = 0; waited < c_synchronizationTimeout; waited += c_synchronizationPollInterval)
+	{
+		if(!syncFile.Exists())
+			return true;
+		Sleep(c_synchronizationPollInterval);
+	}
+
+#ifdef XPC_OS_LINUX
+	String syncPath = syncFile.Path().String().ToUTF8();
+	unlink(reinterpret_cast<const char*>(syncPath.GetRawZeroTerminatedData()));
+#endif
+	return false;
+}
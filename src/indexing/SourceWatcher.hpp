@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+using namespace StdXX::FileSystem;
+//Local
+#include "DirtyPathJournal.hpp"
+
+/**
+ * Subscribes to the change notifications of the kernel for the whole source directory and records the changed nodes
+ * in the dirty path journal.
+ */
+class SourceWatcher
+{
+public:
+	//Constructor
+	SourceWatcher(const Path& sourcePath, const Path& backupPath);
+
+	//Destructor
+	~SourceWatcher();
+
+	//Methods
+	/**
+	 * Blocks and records changes until the process is terminated or the source directory can't be watched anymore,
+	 * i.e. it was removed or moved away. In the latter case the journal is marked as incomplete.
+	 */
+	void Run();
+	/**
+	 * Takes the lock of the backup directory and sets up the watches.
+	 *
+	 * @return false if another watcher holds the lock or the source or backup directory can't be watched
+	 */
+	bool Start();
+
+	//Class functions
+	/**
+	 * @return true if a watcher for the backup directory is currently running
+	 */
+	static bool IsRunning(const Path& backupPath);
+	/**
+	 * Waits until the running watcher has recorded all changes that happened up to now.
+	 *
+	 * @return false if no watcher is running or it did not respond in time
+	 */
+	static bool Synchronize(const Path& backupPath);
+
+private:
+	//Members
+	Path sourcePath;
+	Path backupPath;
+	DirtyPathJournal journal;
+	int notifyFd;
+	int lockFd;
+	int backupDirWatch;
+	int rootWatch;
+	BinaryTreeMap<int, Path> watchedDirectories;
+	BinaryTreeSet<Path> dirtyNodes;
+	BinaryTreeSet<Path> dirtySubtrees;
+
+	//Methods
+	void FlushDirtyPaths();
+	void HandleEvent(int watch, uint32 mask, const String& name, bool& synchronizationRequested);
+	/**
+	 * @return false if the directory could not be watched
+	 */
+	bool WatchDirectory(const Path& nodePath);
+};
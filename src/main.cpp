@@ -19,6 +19,7 @@
 //Local
 #include "commands/Commands.hpp"
 #include "backup/SnapshotManager.hpp"
+#include "backup/ChunkStore.hpp"
 #include "config/CompressionStatistics.hpp"
 //Namespaces
 using namespace StdXX::CommandLine;
@@ -43,6 +44,16 @@ static bool TryInstantiateCompressorAndHashers()
         return false;
     }
 
+    if(config.fastCompressionThreshold or (config.strongCompressionRate < 1))
+    {
+        compressor = ConfigManager::CreateCompressor({ .setting = CompressionSetting::zlib, .level = 1 }, nullOutputStream);
+        if(compressor.IsNull())
+        {
+            stdErr << u8"Could not create compressor for the fast and medium codecs." << endl;
+            return false;
+        }
+    }
+
     UniquePointer<Crypto::HashFunction> hasher = Crypto::HashFunction::CreateInstance(config.hashAlgorithm);
     if(hasher.IsNull())
     {
@@ -71,6 +82,10 @@ int32 Main(const String& programName, const FixedArray<String>& args)
 	subCommandArgument.AddCommand(addSnapshot);
 
 
+	Group convertIndexFiles(u8"convert-index-files", u8"Converts the indexes of snapshots that were written by older versions into the binary index format.");
+	subCommandArgument.AddCommand(convertIndexFiles);
+
+
 	Group diff(u8"diff", u8"Finds the differences between the newest snapshot and the source directory.");
 
 	OptionWithArgument sourceSnapshotName(u8's', u8"source-snapshot-name", u8"Use another snapshot than the newest one as source");
@@ -128,6 +143,10 @@ int32 Main(const String& programName, const FixedArray<String>& args)
 	subCommandArgument.AddCommand(verifyAll);
 
 
+	Group watch(u8"watch", u8"Records the changes in the source directory until terminated. While the watcher runs, adding a snapshot only reads the changed parts of the source directory.");
+	subCommandArgument.AddCommand(watch);
+
+
 	commandLineParser.AddPositionalArgument(subCommandArgument);
 
 	if(!commandLineParser.Parse(args))
@@ -169,6 +188,14 @@ int32 Main(const String& programName, const FixedArray<String>& args)
 
 	ic.TaskQueue(nWorkers);
 
+	if(matchResult.IsActivated(convertIndexFiles))
+		return CommandConvertIndexFiles();
+	if(matchResult.IsActivated(watch))
+		return CommandWatch();
+
+	ChunkStore chunkStore(configManager.Config().chunkStorePath);
+	ic.ChunkStore(&chunkStore);
+
 	SnapshotManager snapshotManager;
 
 	if(matchResult.IsActivated(addSnapshot))
@@ -224,6 +251,7 @@ int32 Main(const String& programName, const FixedArray<String>& args)
 	}
 	else if(matchResult.IsActivated(restoreSnapshot))
 	{
+		LoadSnapshotIndexes(snapshotManager, *snapshot);
 		snapshot->Restore(restorePoint.Value(matchResult));
 		stdOut << u8"Backup restoration successful" << endl;
 
@@ -119,6 +119,7 @@ public:
 
 	inline void AddTotalSize(uint64 size)
 	{
+		AutoLock lock(this->mutex);
 		this->totalSize += size;
 	}
 
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+using namespace StdXX;
+
+/**
+ * Scans a generated source tree with 1, 2, 4, ... nMaxThreads workers to show how the parallel directory walk scales.
+ */
+void BenchmarkDirectoryScan(uint32 nMaxThreads);
+/**
+ * Looks up every node of a large index by path from 1, 2, 4, ... nMaxThreads threads, once while the index is not
+ * frozen (every lookup takes the index lock) and once after it was frozen (lookups are lock-free).
+ */
+void BenchmarkIndexLookups(uint32 nMaxThreads);
+/**
+ * Runs a cheap per-index workload once with one task per index (as the per-node loops did before) and once with
+ * ParallelFor.
+ */
+void BenchmarkParallelFor(uint32 nThreads);
\ No newline at end of file
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Local
+#include "Benchmarks.hpp"
+#include "../src/InjectionContainer.hpp"
+#include "../src/indexing/OSFileSystemNodeIndex.hpp"
+#include "../src/status/StatusTracker.hpp"
+
+//Constants
+static const uint32 c_nDirectories = 64;
+static const uint32 c_nSubdirectoriesPerDirectory = 16;
+static const uint32 c_nFilesPerSubdirectory = 32;
+
+//Local functions
+static void CreateSourceTree(const Path& rootPath)
+{
+	for(uint32 i = 0; i < c_nDirectories; i++)
+	{
+		Path dirPath = rootPath / (u8"dir" + String::Number(i));
+		File(dirPath).CreateDirectory();
+		for(uint32 j = 0; j < c_nSubdirectoriesPerDirectory; j++)
+		{
+			Path subdirPath = dirPath / (u8"subdir" + String::Number(j));
+			File(subdirPath).CreateDirectory();
+			for(uint32 k = 0; k < c_nFilesPerSubdirectory; k++)
+			{
+				FileOutputStream fileOutputStream(subdirPath / (u8"file" + String::Number(k)), true);
+				fileOutputStream.WriteBytes(&k, sizeof(k));
+			}
+		}
+	}
+}
+
+//Functions
+void BenchmarkDirectoryScan(uint32 nMaxThreads)
+{
+	TempDirectory tempDirectory;
+	CreateSourceTree(tempDirectory.Path());
+
+	InjectionContainer& ic = InjectionContainer::Instance();
+	ic.StatusTracker(new StatusTracker);
+
+	DynamicArray<uint32> threadCounts;
+	for(uint32 nThreads = 1; nThreads < nMaxThreads; nThreads *= 2)
+		threadCounts.Push(nThreads);
+	threadCounts.Push(nMaxThreads);
+
+	const uint32 nNodes = 1 + c_nDirectories * (1 + c_nSubdirectoriesPerDirectory * (1 + c_nFilesPerSubdirectory));
+	stdOut << u8"Directory scan (" << nNodes << u8" nodes, file system cache warmed up by a first scan)" << endl;
+
+	ic.TaskQueue(nMaxThreads);
+	OSFileSystemNodeIndex warmUp(tempDirectory.Path());
+	ASSERT(warmUp.GetNumberOfNodes() == nNodes, u8"Not all nodes were scanned");
+
+	for(uint32 nThreads : threadCounts)
+	{
+		ic.TaskQueue(nThreads);
+		OSFileSystemNodeIndex sourceIndex(tempDirectory.Path());
+		const uint64 elapsed = sourceIndex.ScanDuration();
+		stdOut << nThreads << u8" threads: " << elapsed << u8" us, " << (nNodes * 1000000ull / Math::Max(elapsed, (uint64)1)) << u8" nodes/s" << endl;
+	}
+
+	ic.UnregisterAll();
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Local
+#include "Benchmarks.hpp"
+#include "../src/backup/BackupNodeIndex.hpp"
+
+//Constants
+static const uint32 c_nDirectories = 1000;
+static const uint32 c_nFilesPerDirectory = 1000;
+static const uint32 c_nRounds = 4;
+
+//Local functions
+static uint64 MeasureLookups(const BackupNodeIndex& index, const DynamicArray<Path>& paths, uint32 nThreads)
+{
+	StaticThreadPool threadPool(nThreads);
+	Mutex sumLock;
+	uint64 sum = 0;
+
+	Clock clock;
+	clock.Start();
+	for(uint32 i = 0; i < nThreads; i++)
+	{
+		threadPool.EnqueueTask([&index, &paths, &sumLock, &sum, i, nThreads]()
+		{
+			uint64 localSum = 0;
+			for(uint32 round = 0; round < c_nRounds; round++)
+			{
+				for(uint32 j = i; j < paths.GetNumberOfElements(); j += nThreads)
+				{
+					uint32 nodeIndex = index.GetNodeIndex(paths[j]);
+					localSum += index.GetNodeAttributes(nodeIndex).Size();
+				}
+			}
+
+			AutoLock lock(sumLock);
+			sum += localSum;
+		});
+	}
+	threadPool.WaitForAllTasksToComplete();
+	uint64 elapsed = clock.GetElapsedMicroseconds();
+
+	ASSERT(sum == (uint64)c_nRounds * paths.GetNumberOfElements(), u8"Not all lookups were done");
+	return elapsed;
+}
+
+static void PrintLookupRate(const String& label, uint32 nThreads, uint64 nLookups, uint64 elapsed)
+{
+	stdOut << label << u8", " << nThreads << u8" threads: " << elapsed << u8" us, " << (nLookups * 1000000 / Math::Max(elapsed, (uint64)1)) << u8" lookups/s" << endl;
+}
+
+//Functions
+void BenchmarkIndexLookups(uint32 nMaxThreads)
+{
+	BackupNodeIndex index;
+	DynamicArray<Path> paths;
+	for(uint32 i = 0; i < c_nDirectories; i++)
+	{
+		for(uint32 j = 0; j < c_nFilesPerDirectory; j++)
+		{
+			Path path(u8"/dir" + String::Number(i) + u8"/file" + String::Number(j));
+			index.AddNode(path, new BackupNodeAttributes(FileType::File, 1, {}, new POSIXPermissions(0, 0, 0), {}, {}));
+			paths.Push(path);
+		}
+	}
+
+	const uint64 nLookups = (uint64)c_nRounds * paths.GetNumberOfElements();
+	stdOut << u8"Index lookups (" << paths.GetNumberOfElements() << u8" nodes, " << c_nRounds << u8" rounds)" << endl;
+
+	DynamicArray<uint32> threadCounts;
+	for(uint32 nThreads = 1; nThreads < nMaxThreads; nThreads *= 2)
+		threadCounts.Push(nThreads);
+	threadCounts.Push(nMaxThreads);
+
+	for(uint32 nThreads : threadCounts)
+		PrintLookupRate(u8"Locked", nThreads, nLookups, MeasureLookups(index, paths, nThreads));
+
+	index.Freeze();
+	for(uint32 nThreads : threadCounts)
+		PrintLookupRate(u8"Frozen", nThreads, nLookups, MeasureLookups(index, paths, nThreads));
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Local
+#include "Benchmarks.hpp"
+#include "../src/ParallelFor.hpp"
+
+//Constants
+static const uint32 c_nIndices = 1000000;
+
+//Local functions
+static void Work(FixedArray<uint64>& results, uint32 i)
+{
+	uint64 x = i + 1;
+	for(uint32 j = 0; j < 16; j++)
+		x = x * 6364136223846793005ull + 1442695040888963407ull;
+	results[i] = x;
+}
+
+static uint64 MeasureOneTaskPerIndex(StaticThreadPool& threadPool, FixedArray<uint64>& results)
+{
+	Clock clock;
+	clock.Start();
+	for(uint32 i = 0; i < c_nIndices; i++)
+	{
+		threadPool.EnqueueTask([&results, i]()
+		{
+			Work(results, i);
+		});
+	}
+	threadPool.WaitForAllTasksToComplete();
+	return clock.GetElapsedMicroseconds();
+}
+
+static uint64 MeasureParallelFor(StaticThreadPool& threadPool, uint32 nThreads, FixedArray<uint64>& results)
+{
+	Clock clock;
+	clock.Start();
+	ParallelFor(threadPool, nThreads, c_nIndices, [&results](uint32 i)
+	{
+		Work(results, i);
+	});
+	return clock.GetElapsedMicroseconds();
+}
+
+//Functions
+void BenchmarkParallelFor(uint32 nThreads)
+{
+	StaticThreadPool threadPool(nThreads);
+	FixedArray<uint64> results(c_nIndices);
+
+	stdOut << u8"Per-index loop (" << c_nIndices << u8" indices, " << nThreads << u8" threads)" << endl;
+	stdOut << u8"One task per index: " << MeasureOneTaskPerIndex(threadPool, results) << u8" us" << endl;
+	stdOut << u8"ParallelFor: " << MeasureParallelFor(threadPool, nThreads, results) << u8" us" << endl;
+}
\ No newline at end of file
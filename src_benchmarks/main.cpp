@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXX.hpp>
+using namespace StdXX;
+//Local
+#include "Benchmarks.hpp"
+
+int32 Main(const String& programName, const FixedArray<String>& args)
+{
+	const uint32 nMaxThreads = Math::Max(GetHardwareConcurrency(), 1u);
+
+	BenchmarkDirectoryScan(nMaxThreads);
+	BenchmarkIndexLookups(nMaxThreads);
+	BenchmarkParallelFor(nMaxThreads);
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXXTest.hpp>
+//Local
+#include "../../src/backup/SnapshotManager.hpp"
+#include "../../src/commands/Commands.hpp"
+#include "TestBackupCreator.hpp"
+//Namespaces
+using namespace StdXX;
+
+TEST_SUITE(FrameCompressionTests)
+{
+	TEST_CASE(FramedFileShouldBeReadBack)
+	{
+		TestBackupCreator testBackupCreator;
+		SnapshotManager snapshotManager;
+
+		const uint64 frameSize = InjectionContainer::Instance().Config().compressionFrameSize;
+		ASSERT_EQUALS(true, frameSize != 0); //frames should be enabled by default
+
+		//compressible text of a bit more than two frames, so that the last frame is a partial one
+		const uint32 size = (uint32)(2 * frameSize + frameSize / 3);
+		FixedArray<uint8> data(size);
+		for(uint32 i = 0; i < size; i++)
+			data[i] = (uint8)(u8'a' + (i / 7 + i / 1031) % 26);
+		testBackupCreator.AddSourceFile({u8"/framed"}, data.Data(), size);
+
+		int32 result = CommandAddSnapshot(snapshotManager);
+		ASSERT_EQUALS(EXIT_SUCCESS, result);
+
+		const Snapshot& snapshot = snapshotManager.NewestSnapshot();
+		const BackupNodeAttributes& attributes = snapshot.Index().GetNodeAttributes(snapshot.Index().GetNodeIndex(String(u8"/framed")));
+		ASSERT_EQUALS(true, attributes.Frames().HasValue()); //file should be compressed in frames
+		ASSERT_EQUALS(3, attributes.Frames()->compressedSizes.GetNumberOfElements());
+
+		testBackupCreator.VerifySnapshotDataMatchesTestState(snapshot);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXXTest.hpp>
+//Local
+#include "../../src/backup/SnapshotManager.hpp"
+#include "../../src/backup/IndexFile.hpp"
+#include "../../src/commands/Commands.hpp"
+#include "../../src/Util.hpp"
+#include "TestBackupCreator.hpp"
+//Namespaces
+using namespace StdXX;
+
+TEST_SUITE(IndexFileTests)
+{
+	TEST_CASE(IndexFileShouldBeReadBackUnchanged)
+	{
+		TestBackupCreator testBackupCreator;
+		SnapshotManager snapshotManager;
+
+		testBackupCreator.AddSourceDir({u8"/testdir"});
+		testBackupCreator.AddSourceFile({u8"/testdir/nested"}, u8"test");
+		testBackupCreator.AddSourceFile({u8"/test"}, u8"test2");
+		testBackupCreator.AddSourceLink({u8"/testlink"}, u8"test");
+
+		int32 result = CommandAddSnapshot(snapshotManager);
+		ASSERT_EQUALS(EXIT_SUCCESS, result);
+
+		//the snapshot was read in from its index file after it was written
+		const BackupNodeIndex& index = snapshotManager.NewestSnapshot().Index();
+		testBackupCreator.VerifySnapshotMatchesTestState(snapshotManager.NewestSnapshot());
+
+		TempDirectory tempDirectory;
+		const Path indexFilePath = tempDirectory.Path() / (String(u8"index.") + c_indexFileExtension);
+		const Path indexHashFilePath = indexFilePath.String() + String(c_hashFileSuffix);
+		WriteIndexFile(index, indexFilePath, indexHashFilePath);
+		UniquePointer<BackupNodeIndex> readIndex = ReadIndexFile(indexFilePath, indexHashFilePath);
+
+		ASSERT_EQUALS(index.GetNumberOfNodes(), readIndex->GetNumberOfNodes());
+		for(uint32 i = 0; i < index.GetNumberOfNodes(); i++)
+		{
+			ASSERT_EQUALS(index.GetNodePath(i).String(), readIndex->GetNodePath(i).String());
+
+			const BackupNodeAttributes& attributes = index.GetNodeAttributes(i);
+			const BackupNodeAttributes& readAttributes = readIndex->GetNodeAttributes(i);
+			ASSERT_EQUALS(attributes.Type(), readAttributes.Type());
+			ASSERT_EQUALS(attributes.Size(), readAttributes.Size());
+			ASSERT_EQUALS(attributes.OwnsBlocks(), readAttributes.OwnsBlocks());
+			ASSERT_EQUALS(attributes.LastModifiedTime().HasValue(), readAttributes.LastModifiedTime().HasValue());
+			if(attributes.LastModifiedTime().HasValue())
+				ASSERT_EQUALS(DateTimeToMilliseconds(*attributes.LastModifiedTime()), DateTimeToMilliseconds(*readAttributes.LastModifiedTime()));
+			ASSERT_EQUALS(attributes.HashValues().GetNumberOfElements(), readAttributes.HashValues().GetNumberOfElements());
+			if(attributes.Type() != FileType::Directory)
+			{
+				const Crypto::HashAlgorithm hashAlgorithm = InjectionContainer::Instance().Config().hashAlgorithm;
+				ASSERT_EQUALS(attributes.Hash(hashAlgorithm).ToHexString(), readAttributes.Hash(hashAlgorithm).ToHexString());
+			}
+
+			ASSERT_EQUALS(attributes.Blocks().GetNumberOfElements(), readAttributes.Blocks().GetNumberOfElements());
+			for(uint32 j = 0; j < attributes.Blocks().GetNumberOfElements(); j++)
+			{
+				ASSERT_EQUALS(attributes.Blocks()[j].volumeNumber, readAttributes.Blocks()[j].volumeNumber);
+				ASSERT_EQUALS(attributes.Blocks()[j].offset, readAttributes.Blocks()[j].offset);
+				ASSERT_EQUALS(attributes.Blocks()[j].size, readAttributes.Blocks()[j].size);
+			}
+
+			ASSERT_EQUALS(attributes.SolidGroup().HasValue(), readAttributes.SolidGroup().HasValue());
+			if(attributes.SolidGroup().HasValue())
+			{
+				ASSERT_EQUALS(attributes.SolidGroup()->leaderNodeIndex, readAttributes.SolidGroup()->leaderNodeIndex);
+				ASSERT_EQUALS(attributes.SolidGroup()->offset, readAttributes.SolidGroup()->offset);
+			}
+		}
+	}
+};
\ No newline at end of file
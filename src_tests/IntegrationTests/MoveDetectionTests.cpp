@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXXTest.hpp>
+//Local
+#include "../../src/backup/SnapshotManager.hpp"
+#include "../../src/commands/Commands.hpp"
+#include "TestBackupCreator.hpp"
+//Namespaces
+using namespace StdXX;
+
+TEST_SUITE(MoveDetectionTests)
+{
+	TEST_CASE(RenamedFileShouldBeDetectedByIdentity)
+	{
+		TestBackupCreator testBackupCreator;
+		SnapshotManager snapshotManager;
+
+		//same data, so that only the identity tells which of the two was renamed
+		testBackupCreator.AddSourceFile({u8"/a"}, u8"test");
+		testBackupCreator.AddSourceFile({u8"/b"}, u8"test");
+
+		int32 result = CommandAddSnapshot(snapshotManager);
+		ASSERT_EQUALS(EXIT_SUCCESS, result);
+
+		Sleep(1 * 1000 * 1000 * 1000); //snapshot names are based on the current time and have second precision
+		testBackupCreator.MoveFile({u8"/b"}, {u8"/c"});
+
+		result = CommandAddSnapshot(snapshotManager);
+		ASSERT_EQUALS(EXIT_SUCCESS, result);
+
+		const Snapshot& snapshot = snapshotManager.NewestSnapshot();
+		testBackupCreator.VerifySnapshotMatchesTestState(snapshot);
+		for(uint32 i = 0; i < snapshot.Index().GetNumberOfNodes(); i++)
+			ASSERT_EQUALS(false, snapshot.Index().GetNodeAttributes(i).OwnsBlocks()); //no data should be stored again
+
+		const BackupNodeAttributes& attributes = snapshot.Index().GetNodeAttributes(snapshot.Index().GetNodeIndex(String(u8"/c")));
+		ASSERT_EQUALS(true, attributes.BackReferenceTarget().HasValue()); //renamed file should refer to its old path
+		ASSERT_EQUALS(String(u8"/b"), attributes.BackReferenceTarget()->String());
+
+		testBackupCreator.VerifySnapshotDataMatchesTestState(snapshot);
+	}
+};
\ No newline at end of file
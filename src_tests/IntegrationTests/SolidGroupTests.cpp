@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXXTest.hpp>
+//Local
+#include "../../src/backup/SnapshotManager.hpp"
+#include "../../src/commands/Commands.hpp"
+#include "TestBackupCreator.hpp"
+//Namespaces
+using namespace StdXX;
+
+TEST_SUITE(SolidGroupTests)
+{
+	TEST_CASE(SolidGroupMembersShouldBeReadBack)
+	{
+		TestBackupCreator testBackupCreator;
+		SnapshotManager snapshotManager;
+
+		testBackupCreator.AddSourceDir({u8"/testdir"});
+		testBackupCreator.AddSourceFile({u8"/testdir/a.txt"}, u8"first small text file");
+		testBackupCreator.AddSourceFile({u8"/testdir/b.txt"}, u8"second small text file");
+		testBackupCreator.AddSourceFile({u8"/testdir/c.txt"}, u8"third small text file");
+
+		int32 result = CommandAddSnapshot(snapshotManager);
+		ASSERT_EQUALS(EXIT_SUCCESS, result);
+
+		const Snapshot& snapshot = snapshotManager.NewestSnapshot();
+		const BackupNodeIndex& index = snapshot.Index();
+		const BackupNodeAttributes& first = index.GetNodeAttributes(index.GetNodeIndex(String(u8"/testdir/a.txt")));
+		const BackupNodeAttributes& last = index.GetNodeAttributes(index.GetNodeIndex(String(u8"/testdir/c.txt")));
+		ASSERT_EQUALS(true, first.SolidGroup().HasValue() and last.SolidGroup().HasValue()); //small files should be grouped
+		ASSERT_EQUALS(first.SolidGroup()->leaderNodeIndex, last.SolidGroup()->leaderNodeIndex);
+
+		testBackupCreator.VerifySnapshotDataMatchesTestState(snapshot);
+	}
+};
\ No newline at end of file
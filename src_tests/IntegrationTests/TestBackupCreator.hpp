@@ -16,8 +16,10 @@
  * You should have received a copy of the GNU General Public License
  * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <cstdio>
 //Local
 #include "../../src/commands/Commands.hpp"
+#include "../../src/backup/ChunkStore.hpp"
 
 class TestBackupCreator
 {
@@ -41,10 +43,12 @@ public:
 
 		this->configManager = new ConfigManager(backupDir.Path());
 		this->comprStats = new CompressionStatistics(backupDir.Path());
+		this->chunkStore = new ChunkStore(this->configManager->Config().chunkStorePath);
 
 		InjectionContainer &ic = InjectionContainer::Instance();
 		ic.ConfigManager(this->configManager.operator->());
 		ic.CompressionStats(this->comprStats.operator->());
+		ic.ChunkStore(this->chunkStore.operator->());
 		ic.StatusTracker(new StatusTracker);
 		ic.TaskQueue(GetHardwareConcurrency());
 	}
@@ -89,6 +93,22 @@ public:
 		this->testPaths.Insert(virtualRootPath.Normalized(), testFileData);
 	}
 
+	inline void AddSourceFile(const Path& virtualRootPath, const uint8* data, uint32 size)
+	{
+		InjectionContainer &ic = InjectionContainer::Instance();
+		FileOutputStream fileOutputStream(this->SourcePath() + virtualRootPath, true);
+		Crypto::HashingOutputStream hashingOutputStream(fileOutputStream, ic.Config().hashAlgorithm);
+		hashingOutputStream.WriteBytes(data, size);
+		hashingOutputStream.Flush();
+
+		auto hasher = hashingOutputStream.Reset();
+		hasher->Finish();
+		TestFileData testFileData;
+		testFileData.fileType = FileType::File;
+		testFileData.contentHash = hasher->GetDigestString().ToLowercase();
+		this->testPaths.Insert(virtualRootPath.Normalized(), testFileData);
+	}
+
 	inline void AddSourceLink(const Path& virtualRootPath, const String& linkTarget)
 	{
 		File link(this->SourcePath() + virtualRootPath);
@@ -109,6 +129,21 @@ public:
 		this->testPaths.Insert(virtualRootPath.Normalized(), testFileData);
 	}
 
+	/**
+	 * Renames the file, so that it keeps its identity in the file system.
+	 */
+	inline void MoveFile(const Path& virtualRootPath, const Path& newVirtualRootPath)
+	{
+		Path from = this->SourcePath() + virtualRootPath;
+		Path to = this->SourcePath() + newVirtualRootPath;
+		int result = rename(reinterpret_cast<const char*>(from.String().ToUTF8().GetRawZeroTerminatedData()), reinterpret_cast<const char*>(to.String().ToUTF8().GetRawZeroTerminatedData()));
+		ASSERT_EQUALS(0, result);
+
+		TestFileData testFileData = this->testPaths[virtualRootPath.Normalized()];
+		this->testPaths.Remove(virtualRootPath.Normalized());
+		this->testPaths.Insert(newVirtualRootPath.Normalized(), testFileData);
+	}
+
 	inline void RemoveFile(const Path& virtualRootPath)
 	{
 		File file(this->SourcePath() + virtualRootPath);
@@ -116,6 +151,36 @@ public:
 		this->testPaths.Remove(virtualRootPath.Normalized());
 	}
 
+	/**
+	 * Reads the data of all files and links back from the backup.
+	 */
+	inline void VerifySnapshotDataMatchesTestState(const Snapshot& snapshot)
+	{
+		const Crypto::HashAlgorithm hashAlgorithm = this->configManager->Config().hashAlgorithm;
+		for(const auto& kv : this->testPaths)
+		{
+			if(kv.value.fileType == FileType::Directory)
+				continue;
+
+			uint32 dataNodeIndex;
+			const Snapshot* dataSnapshot = snapshot.FindDataSnapshot(snapshot.Index().GetNodeIndex(kv.key.String()), dataNodeIndex);
+
+			UniquePointer<InputStream> input;
+			if(kv.value.fileType == FileType::Link)
+				input = dataSnapshot->Filesystem().OpenLinkTargetAsStream(dataSnapshot->Index().GetNodePath(dataNodeIndex), true);
+			else
+				input = dataSnapshot->Filesystem().OpenFileForReading(dataNodeIndex, true);
+
+			auto hasher = Crypto::HashFunction::CreateInstance(hashAlgorithm);
+			Crypto::HashingInputStream hashingInputStream(*input, hasher.operator->());
+			NullOutputStream nullOutputStream;
+			hashingInputStream.FlushTo(nullOutputStream);
+			hasher->Finish();
+
+			ASSERT_EQUALS(kv.value.contentHash, hasher->GetDigestString().ToLowercase());
+		}
+	}
+
 	inline void VerifySnapshotMatchesTestState(const Snapshot& snapshot)
 	{
 		ASSERT_EQUALS(this->testPaths.GetNumberOfElements() + 1, snapshot.Index().GetNumberOfNodes()); //the backup stores the root path also as extra node, which we don't
@@ -127,7 +192,7 @@ public:
 
 			ASSERT_EQUALS(kv.value.fileType, attribs.Type());
 			if(kv.value.fileType != FileType::Directory)
-				ASSERT_EQUALS(kv.value.contentHash, attribs.HashValues().Get(this->configManager->Config().hashAlgorithm));
+				ASSERT_EQUALS(kv.value.contentHash, attribs.Hash(this->configManager->Config().hashAlgorithm).ToHexString());
 		}
 	}
 
@@ -136,6 +201,7 @@ private:
 	TempDirectory tempDirectory;
 	UniquePointer<ConfigManager> configManager;
 	UniquePointer<CompressionStatistics> comprStats;
+	UniquePointer<ChunkStore> chunkStore;
 	BinaryTreeMap<Path, TestFileData> testPaths;
 
 	//Properties
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXXTest.hpp>
+//Local
+#include "../../src/indexing/CompressibilityProbe.hpp"
+//Namespaces
+using namespace StdXX;
+
+//Constants
+static const uint32 c_dataSize = 256 * KiB;
+
+static Optional<float32> EstimateCompressionRate(const FixedArray<uint8>& data)
+{
+	BufferInputStream bufferInputStream(data.Data(), data.GetNumberOfElements());
+	Optional<float32> compressionRate = CompressibilityProbe::EstimateCompressionRate(bufferInputStream, data.GetNumberOfElements());
+	ASSERT_EQUALS(0, bufferInputStream.QueryCurrentOffset());
+	return compressionRate;
+}
+
+static void FillPseudoRandom(FixedArray<uint8>& data)
+{
+	uint32 state = 1;
+	for(uint32 i = 0; i < data.GetNumberOfElements(); i++)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		data[i] = (uint8)state;
+	}
+}
+
+static void FillText(FixedArray<uint8>& data)
+{
+	const String text = String(u8"The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor jugs.\n").ToUTF8();
+	const uint8* textData = text.GetRawData();
+	const uint32 textSize = text.GetSize();
+	for(uint32 i = 0; i < data.GetNumberOfElements(); i++)
+		data[i] = textData[i % textSize];
+}
+
+TEST_SUITE(CompressibilityProbeTests)
+{
+	TEST_CASE(HighEntropyDataShouldBeIncompressible)
+	{
+		FixedArray<uint8> data(c_dataSize);
+		FillPseudoRandom(data);
+
+		Optional<float32> compressionRate = EstimateCompressionRate(data);
+		ASSERT_EQUALS(true, compressionRate.HasValue());
+		ASSERT_EQUALS(1.0f, *compressionRate);
+	}
+
+	TEST_CASE(TextShouldBeCompressible)
+	{
+		FixedArray<uint8> data(c_dataSize);
+		FillText(data);
+
+		Optional<float32> compressionRate = EstimateCompressionRate(data);
+		ASSERT_EQUALS(true, compressionRate.HasValue());
+		ASSERT_EQUALS(true, *compressionRate < 0.75f);
+	}
+
+	TEST_CASE(CompressedFormatMagicShouldShortCircuit)
+	{
+		FixedArray<uint8> data(c_dataSize);
+
+		//text would be compressible, only the magic number tells otherwise
+		FillText(data);
+		data[0] = 0x1F;
+		data[1] = 0x8B;
+		ASSERT_EQUALS(1.0f, *EstimateCompressionRate(data)); //gzip
+
+		FillText(data);
+		MemCopy(&data[0], "\x89PNG", 4);
+		ASSERT_EQUALS(1.0f, *EstimateCompressionRate(data)); //png
+
+		FillText(data);
+		MemCopy(&data[8], "WEBP", 4);
+		ASSERT_EQUALS(1.0f, *EstimateCompressionRate(data)); //magic number that is not at the start
+	}
+
+	TEST_CASE(SmallDataShouldNotBeProbed)
+	{
+		FixedArray<uint8> data(16 * KiB);
+		FillPseudoRandom(data);
+
+		ASSERT_EQUALS(false, EstimateCompressionRate(data).HasValue());
+	}
+}
\ No newline at end of file
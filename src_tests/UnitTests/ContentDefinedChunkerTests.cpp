@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXXTest.hpp>
+//Local
+#include "../../src/backup/ContentDefinedChunker.hpp"
+//Namespaces
+using namespace StdXX;
+
+static DynamicArray<uint32> ChunkSizes(const uint8* data, uint32 size)
+{
+	BufferInputStream bufferInputStream(data, size);
+	ContentDefinedChunker chunker(bufferInputStream);
+
+	DynamicArray<uint32> chunkSizes;
+	const uint8* chunkData;
+	while(uint32 chunkSize = chunker.ReadNextChunk(chunkData))
+		chunkSizes.Push(chunkSize);
+
+	return chunkSizes;
+}
+
+/**
+ * Data that doesn't compress, so that the chunker sees no long runs of equal bytes.
+ */
+static void FillPseudoRandom(uint8* data, uint32 size, uint32 seed)
+{
+	uint32 state = seed;
+	for(uint32 i = 0; i < size; i++)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		data[i] = (uint8)state;
+	}
+}
+
+TEST_SUITE(ContentDefinedChunkerTests)
+{
+	TEST_CASE(ChunkBoundariesShouldBeStableUnderInsertions)
+	{
+		const uint32 size = 16 * MiB;
+		const uint32 insertionOffset = 6 * MiB;
+		const uint32 insertionSize = 100;
+
+		FixedArray<uint8> data(size);
+		FillPseudoRandom(data.Data(), size, 1);
+		FixedArray<uint8> modifiedData(size + insertionSize);
+		MemCopy(modifiedData.Data(), data.Data(), insertionOffset);
+		FillPseudoRandom(modifiedData.Data() + insertionOffset, insertionSize, 2);
+		MemCopy(modifiedData.Data() + insertionOffset + insertionSize, data.Data() + insertionOffset, size - insertionOffset);
+
+		DynamicArray<uint32> chunkSizes = ChunkSizes(data.Data(), size);
+		DynamicArray<uint32> modifiedChunkSizes = ChunkSizes(modifiedData.Data(), size + insertionSize);
+
+		uint32 nCommonPrefix = 0;
+		while( (nCommonPrefix < chunkSizes.GetNumberOfElements()) and (nCommonPrefix < modifiedChunkSizes.GetNumberOfElements())
+			and (chunkSizes[nCommonPrefix] == modifiedChunkSizes[nCommonPrefix]) )
+			nCommonPrefix++;
+
+		uint32 nCommonSuffix = 0;
+		while( (nCommonPrefix + nCommonSuffix < chunkSizes.GetNumberOfElements()) and (nCommonPrefix + nCommonSuffix < modifiedChunkSizes.GetNumberOfElements())
+			and (chunkSizes[chunkSizes.GetNumberOfElements() - 1 - nCommonSuffix] == modifiedChunkSizes[modifiedChunkSizes.GetNumberOfElements() - 1 - nCommonSuffix]) )
+			nCommonSuffix++;
+
+		//only the chunks around the insertion may change
+		ASSERT_EQUALS(true, chunkSizes.GetNumberOfElements() > 4); //data should be split into several chunks
+		ASSERT_EQUALS(true, modifiedChunkSizes.GetNumberOfElements() - nCommonPrefix - nCommonSuffix <= 2); //chunks away from the insertion should keep their boundaries
+	}
+};
\ No newline at end of file
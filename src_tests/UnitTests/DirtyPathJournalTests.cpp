@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXXTest.hpp>
+//Local
+#include "../../src/indexing/DirtyPathJournal.hpp"
+//Namespaces
+using namespace StdXX;
+
+static void AppendDirtyPaths(DirtyPathJournal& journal, const Path& nodePath, const Path& subtreePath)
+{
+	BinaryTreeSet<Path> nodePaths;
+	nodePaths.Insert(nodePath);
+	BinaryTreeSet<Path> subtreePaths;
+	subtreePaths.Insert(subtreePath);
+
+	journal.AppendDirtyPaths(nodePaths, subtreePaths);
+}
+
+TEST_SUITE(DirtyPathJournalTests)
+{
+	TEST_CASE(CompleteJournalShouldMarkChangedPathsOnly)
+	{
+		TempDirectory tempDirectory;
+		DirtyPathJournal journal(tempDirectory.Path());
+
+		journal.AppendBase(u8"snapshot");
+		AppendDirtyPaths(journal, String(u8"/dir/changed"), String(u8"/subtree"));
+
+		ASSERT_EQUALS(true, journal.Take(u8"snapshot"));
+		ASSERT_EQUALS(2, journal.NumberOfDirtyPaths());
+
+		ASSERT_EQUALS(true, journal.IsDirty(String(u8"/dir/changed")));
+		ASSERT_EQUALS(false, journal.IsDirty(String(u8"/dir/sibling"))); //a dirty node doesn't affect its siblings
+		ASSERT_EQUALS(false, journal.IsDirty(String(u8"/dir")));
+
+		ASSERT_EQUALS(true, journal.IsDirty(String(u8"/subtree")));
+		ASSERT_EQUALS(true, journal.IsDirty(String(u8"/subtree/nested/file"))); //descendants of a dirty subtree are dirty
+		ASSERT_EQUALS(false, journal.IsDirty(String(u8"/subtree2")));
+	}
+
+	TEST_CASE(StartShouldForceFullScan)
+	{
+		TempDirectory tempDirectory;
+		DirtyPathJournal journal(tempDirectory.Path());
+
+		journal.AppendBase(u8"snapshot");
+		journal.AppendStart(); //a new watcher doesn't know what happened before it started
+		AppendDirtyPaths(journal, String(u8"/changed"), String(u8"/subtree"));
+
+		ASSERT_EQUALS(false, journal.Take(u8"snapshot"));
+		ASSERT_EQUALS(0, journal.NumberOfDirtyPaths());
+	}
+
+	TEST_CASE(OverflowShouldForceFullScan)
+	{
+		TempDirectory tempDirectory;
+		DirtyPathJournal journal(tempDirectory.Path());
+
+		journal.AppendBase(u8"snapshot");
+		AppendDirtyPaths(journal, String(u8"/changed"), String(u8"/subtree"));
+		journal.AppendOverflow();
+
+		ASSERT_EQUALS(false, journal.Take(u8"snapshot"));
+		ASSERT_EQUALS(0, journal.NumberOfDirtyPaths());
+	}
+
+	TEST_CASE(OtherBaseShouldForceFullScan)
+	{
+		TempDirectory tempDirectory;
+		DirtyPathJournal journal(tempDirectory.Path());
+
+		journal.AppendBase(u8"older snapshot");
+		AppendDirtyPaths(journal, String(u8"/changed"), String(u8"/subtree"));
+
+		ASSERT_EQUALS(false, journal.Take(u8"snapshot"));
+		ASSERT_EQUALS(0, journal.NumberOfDirtyPaths());
+	}
+
+	TEST_CASE(MissingJournalShouldForceFullScan)
+	{
+		TempDirectory tempDirectory;
+		DirtyPathJournal journal(tempDirectory.Path());
+
+		ASSERT_EQUALS(false, journal.Take(u8"snapshot"));
+	}
+
+	TEST_CASE(TruncatedJournalShouldBeRejected)
+	{
+		TempDirectory tempDirectory;
+		DirtyPathJournal journal(tempDirectory.Path());
+
+		journal.AppendBase(u8"snapshot");
+		AppendDirtyPaths(journal, String(u8"/changed"), String(u8"/subtree"));
+
+		//cut off the end of the last record
+		const Path journalPath = tempDirectory.Path() / String(u8"dirty_paths.journal");
+		const uint32 size = (uint32)File(journalPath).Info().size;
+		FixedArray<uint8> data(size);
+		{
+			FileInputStream fileInputStream(journalPath);
+			ASSERT_EQUALS(size, fileInputStream.ReadBytes(data.Data(), size));
+		}
+		{
+			FileOutputStream fileOutputStream(journalPath, true);
+			fileOutputStream.WriteBytes(data.Data(), size - 3);
+		}
+
+		ASSERT_EQUALS(false, journal.Take(u8"snapshot"));
+		ASSERT_EQUALS(0, journal.NumberOfDirtyPaths());
+	}
+};
\ No newline at end of file
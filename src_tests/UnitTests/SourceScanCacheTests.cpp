@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXXTest.hpp>
+//Local
+#include "../../src/indexing/SourceScanCache.hpp"
+#include "../../src/Util.hpp"
+//Namespaces
+using namespace StdXX;
+
+//Constants
+static const int64 c_lastModifiedTime = 1600000000000;
+static const int64 c_changeTime = 1600000001000;
+
+static void OverwriteCacheFileByte(const Path& dirPath, uint32 offset, uint8 value)
+{
+	const Path cacheFilePath = dirPath / String(u8"source_scan_cache.bin");
+	const uint32 size = (uint32)File(cacheFilePath).Info().size;
+	FixedArray<uint8> data(size);
+	{
+		FileInputStream fileInputStream(cacheFilePath);
+		ASSERT_EQUALS(size, fileInputStream.ReadBytes(data.Data(), size));
+	}
+
+	data[offset] = value;
+	FileOutputStream fileOutputStream(cacheFilePath, true);
+	fileOutputStream.WriteBytes(data.Data(), size);
+}
+
+static void WriteCacheWithOneListing(const Path& dirPath)
+{
+	DynamicArray<CachedDirectoryEntry> entries;
+	entries.Push({ .name = u8"file", .type = FileType::File });
+	entries.Push({ .name = u8"subdir", .type = FileType::Directory });
+
+	SourceScanCache scanCache(dirPath);
+	scanCache.RecordListing(String(u8"/dir"), MillisecondsToDateTime(c_lastModifiedTime), MillisecondsToDateTime(c_changeTime), entries);
+	scanCache.Write();
+}
+
+TEST_SUITE(SourceScanCacheTests)
+{
+	TEST_CASE(UnmodifiedDirectoryShouldReuseListing)
+	{
+		TempDirectory tempDirectory;
+		WriteCacheWithOneListing(tempDirectory.Path());
+
+		SourceScanCache scanCache(tempDirectory.Path());
+		const DynamicArray<CachedDirectoryEntry>* listing = scanCache.FindListing(String(u8"/dir"), MillisecondsToDateTime(c_lastModifiedTime), MillisecondsToDateTime(c_changeTime));
+		ASSERT_EQUALS(true, listing != nullptr);
+		ASSERT_EQUALS(2, listing->GetNumberOfElements());
+		ASSERT_EQUALS(String(u8"file"), (*listing)[0].name);
+		ASSERT_EQUALS(FileType::File, (*listing)[0].type);
+		ASSERT_EQUALS(String(u8"subdir"), (*listing)[1].name);
+		ASSERT_EQUALS(FileType::Directory, (*listing)[1].type);
+	}
+
+	TEST_CASE(ModifiedDirectoryShouldBeReadAgain)
+	{
+		TempDirectory tempDirectory;
+		WriteCacheWithOneListing(tempDirectory.Path());
+
+		SourceScanCache scanCache(tempDirectory.Path());
+		ASSERT_EQUALS(true, scanCache.FindListing(String(u8"/dir"), MillisecondsToDateTime(c_lastModifiedTime + 1), MillisecondsToDateTime(c_changeTime)) == nullptr);
+		ASSERT_EQUALS(true, scanCache.FindListing(String(u8"/dir"), MillisecondsToDateTime(c_lastModifiedTime), MillisecondsToDateTime(c_changeTime + 1)) == nullptr); //last modified time was set back
+		ASSERT_EQUALS(true, scanCache.FindListing(String(u8"/dir"), MillisecondsToDateTime(c_lastModifiedTime), {}) == nullptr);
+		ASSERT_EQUALS(true, scanCache.FindListing(String(u8"/dir"), {}, MillisecondsToDateTime(c_changeTime)) == nullptr);
+		ASSERT_EQUALS(true, scanCache.FindListing(String(u8"/other"), MillisecondsToDateTime(c_lastModifiedTime), MillisecondsToDateTime(c_changeTime)) == nullptr);
+	}
+
+	TEST_CASE(DirectoryModifiedDuringScanShouldNotBeCached)
+	{
+		TempDirectory tempDirectory;
+		DynamicArray<CachedDirectoryEntry> entries;
+		entries.Push({ .name = u8"file", .type = FileType::File });
+
+		{
+			SourceScanCache scanCache(tempDirectory.Path());
+			DateTime now = DateTime::Now(); //after the scan started
+			scanCache.RecordListing(String(u8"/modified"), now, MillisecondsToDateTime(c_changeTime), entries);
+			scanCache.RecordListing(String(u8"/changed"), MillisecondsToDateTime(c_lastModifiedTime), now, entries);
+			scanCache.Write();
+		}
+
+		SourceScanCache scanCache(tempDirectory.Path());
+		ASSERT_EQUALS(true, scanCache.FindListing(String(u8"/modified"), DateTime::Now(), MillisecondsToDateTime(c_changeTime)) == nullptr);
+		ASSERT_EQUALS(true, scanCache.FindListing(String(u8"/changed"), MillisecondsToDateTime(c_lastModifiedTime), DateTime::Now()) == nullptr);
+	}
+
+	TEST_CASE(CacheWithBadMagicShouldBeIgnored)
+	{
+		TempDirectory tempDirectory;
+		WriteCacheWithOneListing(tempDirectory.Path());
+		OverwriteCacheFileByte(tempDirectory.Path(), 0, u8'X');
+
+		SourceScanCache scanCache(tempDirectory.Path());
+		ASSERT_EQUALS(true, scanCache.FindListing(String(u8"/dir"), MillisecondsToDateTime(c_lastModifiedTime), MillisecondsToDateTime(c_changeTime)) == nullptr);
+	}
+
+	TEST_CASE(CacheWithOtherVersionShouldBeIgnored)
+	{
+		TempDirectory tempDirectory;
+		WriteCacheWithOneListing(tempDirectory.Path());
+		OverwriteCacheFileByte(tempDirectory.Path(), 4, 0xFF); //low byte of the version
+
+		SourceScanCache scanCache(tempDirectory.Path());
+		ASSERT_EQUALS(true, scanCache.FindListing(String(u8"/dir"), MillisecondsToDateTime(c_lastModifiedTime), MillisecondsToDateTime(c_changeTime)) == nullptr);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of ACBackup.
+ *
+ * ACBackup is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * ACBackup is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ACBackup.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXXTest.hpp>
+//Local
+#include "../../src/backup/VerificationLedger.hpp"
+//Namespaces
+using namespace StdXX;
+
+TEST_SUITE(VerificationLedgerTests)
+{
+	TEST_CASE(LedgerShouldSelectUnverifiedFailedAndLeastRecentlyVerifiedData)
+	{
+		TempDirectory tempDirectory;
+
+		BinaryTreeSet<DataIdentifier> data;
+		for(uint32 i = 0; i < 10; i++)
+			data.Insert({ .snapshotName = u8"snapshot", .nodeIndex = i });
+
+		{
+			VerificationLedger ledger(tempDirectory.Path());
+			ASSERT_EQUALS(10, ledger.SelectData(data, 0).GetNumberOfElements()); //nothing was verified yet
+
+			for(const DataIdentifier& identifier : data)
+				ledger.RecordVerification(identifier, true);
+			ledger.Write();
+		}
+
+		Sleep(1 * 1000 * 1000 * 1000); //verification times have second precision
+
+		{
+			VerificationLedger ledger(tempDirectory.Path());
+			ASSERT_EQUALS(0, ledger.SelectData(data, 0).GetNumberOfElements());
+
+			for(uint32 i = 0; i < 5; i++)
+				ledger.RecordVerification({ .snapshotName = u8"snapshot", .nodeIndex = i }, true);
+			ledger.RecordVerification({ .snapshotName = u8"snapshot", .nodeIndex = 9 }, false);
+			ledger.Write();
+		}
+
+		VerificationLedger ledger(tempDirectory.Path());
+		BinaryTreeSet<DataIdentifier> selected = ledger.SelectData(data, 20);
+
+		//the failed one plus 20% of the 9 verified ones, which are taken from the ones that were verified first
+		ASSERT_EQUALS(3, selected.GetNumberOfElements());
+		const DataIdentifier failed = { .snapshotName = u8"snapshot", .nodeIndex = 9 };
+		ASSERT_EQUALS(true, selected.Contains(failed));
+		for(uint32 i = 0; i < 5; i++)
+		{
+			const DataIdentifier recentlyVerified = { .snapshotName = u8"snapshot", .nodeIndex = i };
+			ASSERT_EQUALS(false, selected.Contains(recentlyVerified));
+		}
+	}
+};
\ No newline at end of file
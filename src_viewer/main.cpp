@@ -18,6 +18,7 @@
  */
 //Local
 #include "Nodes.hpp"
+#include "../src/backup/ChunkStore.hpp"
 //Namespaces
 using namespace StdXX;
 using namespace StdXX::UI;
@@ -110,6 +111,9 @@ int32 Main(const String& programName, const FixedArray<String>& args)
 	ConfigManager configManager(args[0]);
 	ic.ConfigManager(&configManager);
 
+	ChunkStore chunkStore(configManager.Config().chunkStorePath);
+	ic.ChunkStore(&chunkStore);
+
 	RevisionsTree revisionsTree;
 
 	EventHandling::StandardEventQueue eventQueue;